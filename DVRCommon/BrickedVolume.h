@@ -0,0 +1,522 @@
+#pragma once
+
+#include <QByteArray>
+#include <QDataStream>
+#include <QFile>
+#include <QFileInfo>
+#include <QString>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <OpenMPSupport.h>
+
+#ifdef USE_ZSTD
+#include <zstd.h>
+#endif
+
+// =============================================================================
+// Bricked volume container (.dvrb)
+// =============================================================================
+//
+// All values are little endian, the file consists of:
+//   - header: magic "DVRB", version, size x/y/z, components per voxel, brick size, element size,
+//     element type name (latin1, zero padded) and the number of bricks
+//   - index table: per brick the file offset (uint64), stored size (uint32) and codec (uint32) of its payload
+//   - metadata (version 2): flags (uint32), followed by what the flags announce
+//       - quantized: per component the scale and offset (double) that map the stored values back, value = stored * scale + offset
+//       - statistics: per component the minimum, maximum and mean (double) of the source values and a histogram (uint32 bin count, uint64 bins)
+//   - brick payloads
+//
+// Bricks are cubes of brickSize voxels (clipped at the volume border) ordered x fastest, then y, then z. A decompressed payload holds
+// the voxels of its brick x fastest with the components of a voxel interleaved, exactly like the point data of a Volumes dataset.
+// The element type name is one of the point data element type names, such that the data is decoded without any conversion.
+
+namespace BrickedVolume {
+
+enum class Codec : std::uint32_t
+{
+    Raw = 0,        /** Stored uncompressed, used when compression does not pay off */
+    Zlib = 1,       /** Qt qCompress (zlib), always available */
+    Zstd = 2        /** Zstandard, only available when built with USE_ZSTD */
+};
+
+constexpr char          fileSuffix[]            = "dvrb";
+constexpr char          magic[4]                = { 'D', 'V', 'R', 'B' };
+constexpr std::uint32_t version                 = 2;    // Version 2 added the metadata, version 1 files are still read
+constexpr std::uint32_t quantizedFlag           = 1;
+constexpr std::uint32_t statisticsFlag          = 2;
+constexpr std::uint32_t defaultBrickSize        = 32;
+constexpr int           elementTypeNameSize     = 32;
+constexpr qint64        headerSize              = 4 + 7 * sizeof(std::uint32_t) + elementTypeNameSize + sizeof(std::uint64_t);
+constexpr qint64        brickEntrySize          = sizeof(std::uint64_t) + 2 * sizeof(std::uint32_t);
+
+/** Get the best codec this build supports */
+inline Codec getDefaultCodec()
+{
+#ifdef USE_ZSTD
+    return Codec::Zstd;
+#else
+    return Codec::Zlib;
+#endif
+}
+
+struct BrickEntry
+{
+    quint64         offset = 0;             /** Offset of the payload in the file */
+    std::uint32_t   size = 0;               /** Number of stored bytes of the payload */
+    Codec           codec = Codec::Raw;     /** Codec of the payload */
+};
+
+/** Region of the volume that is covered by a brick */
+struct BrickExtent
+{
+    std::uint32_t x, y, z;
+    std::uint32_t width, height, depth;
+};
+
+struct Header
+{
+    std::uint32_t           sizeX = 0;                          /** Number of voxels on the x-axis */
+    std::uint32_t           sizeY = 0;                          /** Number of voxels on the y-axis */
+    std::uint32_t           sizeZ = 0;                          /** Number of voxels on the z-axis */
+    std::uint32_t           numComponents = 1;                  /** Number of interleaved values per voxel */
+    std::uint32_t           brickSize = defaultBrickSize;       /** Edge length of a brick in voxels */
+    std::uint32_t           elementSize = sizeof(float);        /** Size of a single value in bytes */
+    QString                 elementTypeName;                    /** Point data element type name of the values */
+    std::vector<BrickEntry> bricks;                             /** Index table */
+
+    std::vector<double>                     quantizationScale;      /** Per component, empty when the stored values are the source values */
+    std::vector<double>                     quantizationOffset;     /** Per component, empty when the stored values are the source values */
+    std::vector<double>                     componentMinimum;       /** Per component minimum of the source values, empty when unknown */
+    std::vector<double>                     componentMaximum;       /** Per component maximum of the source values, empty when unknown */
+    std::vector<double>                     componentMean;          /** Per component mean of the source values, empty when unknown */
+    std::vector<std::vector<quint64>>       componentHistograms;    /** Per component histogram over [minimum, maximum], empty when unknown */
+
+    bool isQuantized() const {
+        return !quantizationScale.empty();
+    }
+
+    bool hasStatistics() const {
+        return !componentMinimum.empty();
+    }
+
+    std::uint32_t getNumberOfBricksX() const { return (sizeX + brickSize - 1) / brickSize; }
+    std::uint32_t getNumberOfBricksY() const { return (sizeY + brickSize - 1) / brickSize; }
+    std::uint32_t getNumberOfBricksZ() const { return (sizeZ + brickSize - 1) / brickSize; }
+
+    std::uint64_t getNumberOfBricks() const {
+        return static_cast<std::uint64_t>(getNumberOfBricksX()) * getNumberOfBricksY() * getNumberOfBricksZ();
+    }
+
+    std::uint64_t getNumberOfVoxels() const {
+        return static_cast<std::uint64_t>(sizeX) * sizeY * sizeZ;
+    }
+
+    std::uint64_t getVoxelBytes() const {
+        return static_cast<std::uint64_t>(numComponents) * elementSize;
+    }
+
+    /** Get the size of a decompressed full brick in bytes */
+    std::uint64_t getMaxBrickBytes() const {
+        return static_cast<std::uint64_t>(brickSize) * brickSize * brickSize * getVoxelBytes();
+    }
+
+    /** Get the size of the metadata that follows the index table */
+    qint64 getMetadataSize() const {
+        qint64 size = sizeof(std::uint32_t);
+
+        if (isQuantized())
+            size += static_cast<qint64>(numComponents) * 2 * sizeof(double);
+
+        if (hasStatistics())
+            for (const auto& histogram : componentHistograms)
+                size += 3 * sizeof(double) + sizeof(std::uint32_t) + static_cast<qint64>(histogram.size()) * sizeof(quint64);
+
+        return size;
+    }
+
+    /** Get the offset of the first brick payload */
+    qint64 getPayloadOffset() const {
+        return headerSize + static_cast<qint64>(getNumberOfBricks()) * brickEntrySize + getMetadataSize();
+    }
+
+    BrickExtent getBrickExtent(std::uint64_t brickIndex) const {
+        const auto bx = static_cast<std::uint32_t>(brickIndex % getNumberOfBricksX());
+        const auto by = static_cast<std::uint32_t>((brickIndex / getNumberOfBricksX()) % getNumberOfBricksY());
+        const auto bz = static_cast<std::uint32_t>(brickIndex / (static_cast<std::uint64_t>(getNumberOfBricksX()) * getNumberOfBricksY()));
+
+        BrickExtent extent;
+
+        extent.x        = bx * brickSize;
+        extent.y        = by * brickSize;
+        extent.z        = bz * brickSize;
+        extent.width    = std::min(brickSize, sizeX - extent.x);
+        extent.height   = std::min(brickSize, sizeY - extent.y);
+        extent.depth    = std::min(brickSize, sizeZ - extent.z);
+
+        return extent;
+    }
+
+    std::uint64_t getBrickBytes(const BrickExtent& extent) const {
+        return static_cast<std::uint64_t>(extent.width) * extent.height * extent.depth * getVoxelBytes();
+    }
+};
+
+inline bool isBrickedVolumeFile(const QString& fileName)
+{
+    return QFileInfo(fileName).suffix().toLower() == fileSuffix;
+}
+
+// Copies the voxels of a brick from the volume into the compact brick layout, row by row
+inline void gatherBrick(const Header& header, const BrickExtent& extent, const char* volume, char* brick)
+{
+    const auto voxelBytes   = header.getVoxelBytes();
+    const auto rowBytes     = extent.width * voxelBytes;
+
+    for (std::uint32_t z = 0; z < extent.depth; z++)
+        for (std::uint32_t y = 0; y < extent.height; y++)
+        {
+            const auto voxelIndex = ((static_cast<std::uint64_t>(extent.z + z) * header.sizeY + extent.y + y) * header.sizeX + extent.x);
+            std::memcpy(brick + (static_cast<std::uint64_t>(z) * extent.height + y) * rowBytes, volume + voxelIndex * voxelBytes, rowBytes);
+        }
+}
+
+// Copies the voxels of a brick from the compact brick layout into the volume, row by row
+inline void scatterBrick(const Header& header, const BrickExtent& extent, const char* brick, char* volume)
+{
+    const auto voxelBytes   = header.getVoxelBytes();
+    const auto rowBytes     = extent.width * voxelBytes;
+
+    for (std::uint32_t z = 0; z < extent.depth; z++)
+        for (std::uint32_t y = 0; y < extent.height; y++)
+        {
+            const auto voxelIndex = ((static_cast<std::uint64_t>(extent.z + z) * header.sizeY + extent.y + y) * header.sizeX + extent.x);
+            std::memcpy(volume + voxelIndex * voxelBytes, brick + (static_cast<std::uint64_t>(z) * extent.height + y) * rowBytes, rowBytes);
+        }
+}
+
+// Compresses a brick with the codec, falls back to storing it raw when that is not smaller
+inline QByteArray compressBrick(const char* brick, std::uint64_t numBytes, Codec& codec)
+{
+    QByteArray compressed;
+
+#ifdef USE_ZSTD
+    if (codec == Codec::Zstd)
+    {
+        compressed.resize(static_cast<qsizetype>(ZSTD_compressBound(numBytes)));
+
+        const auto compressedSize = ZSTD_compress(compressed.data(), compressed.size(), brick, numBytes, 3);
+
+        if (ZSTD_isError(compressedSize))
+            compressed.clear();
+        else
+            compressed.resize(static_cast<qsizetype>(compressedSize));
+    }
+#endif
+
+    if (codec == Codec::Zlib)
+        compressed = qCompress(reinterpret_cast<const uchar*>(brick), static_cast<qsizetype>(numBytes));
+
+    if (compressed.isEmpty() || static_cast<std::uint64_t>(compressed.size()) >= numBytes)
+    {
+        codec = Codec::Raw;
+        return QByteArray(brick, static_cast<qsizetype>(numBytes));
+    }
+
+    return compressed;
+}
+
+// Decompresses a stored brick payload into exactly numBytes bytes, returns false when the payload is corrupt
+inline bool decompressBrick(const char* stored, std::uint32_t storedBytes, Codec codec, char* brick, std::uint64_t numBytes)
+{
+    switch (codec)
+    {
+        case Codec::Raw:
+        {
+            if (storedBytes != numBytes)
+                return false;
+
+            std::memcpy(brick, stored, numBytes);
+            return true;
+        }
+
+        case Codec::Zlib:
+        {
+            const auto decompressed = qUncompress(reinterpret_cast<const uchar*>(stored), static_cast<qsizetype>(storedBytes));
+
+            if (static_cast<std::uint64_t>(decompressed.size()) != numBytes)
+                return false;
+
+            std::memcpy(brick, decompressed.constData(), numBytes);
+            return true;
+        }
+
+        case Codec::Zstd:
+        {
+#ifdef USE_ZSTD
+            return ZSTD_decompress(brick, numBytes, stored, storedBytes) == numBytes;
+#else
+            return false;
+#endif
+        }
+    }
+
+    return false;
+}
+
+/**
+ * Read the header and index table of a bricked volume
+ * @param file Opened bricked volume file
+ * @return Header including the index table
+ * @throws std::runtime_error when the file is not a valid bricked volume or uses a codec this build does not support
+ */
+inline Header readHeader(QFile& file)
+{
+    QDataStream stream(&file);
+    stream.setByteOrder(QDataStream::LittleEndian);
+
+    char fileMagic[4];
+    std::uint32_t fileVersion = 0;
+
+    if (stream.readRawData(fileMagic, 4) != 4 || std::memcmp(fileMagic, magic, 4) != 0)
+        throw std::runtime_error("File is not a bricked volume (missing DVRB magic).");
+
+    stream >> fileVersion;
+
+    if (fileVersion < 1 || fileVersion > version)
+        throw std::runtime_error("Bricked volume version " + std::to_string(fileVersion) + " is not supported.");
+
+    Header header;
+
+    char elementTypeName[elementTypeNameSize] = {};
+    quint64 numBricks = 0;
+
+    stream >> header.sizeX >> header.sizeY >> header.sizeZ >> header.numComponents >> header.brickSize >> header.elementSize;
+    stream.readRawData(elementTypeName, elementTypeNameSize);
+    stream >> numBricks;
+
+    header.elementTypeName = QString::fromLatin1(elementTypeName, qstrnlen(elementTypeName, elementTypeNameSize));
+
+    if (stream.status() != QDataStream::Ok || header.sizeX == 0 || header.sizeY == 0 || header.sizeZ == 0 || header.numComponents == 0 || header.brickSize == 0 || header.elementSize == 0)
+        throw std::runtime_error("Bricked volume header is invalid.");
+
+    if (numBricks != header.getNumberOfBricks())
+        throw std::runtime_error("Number of bricks in the index does not match the volume size.");
+
+    header.bricks.resize(numBricks);
+
+    for (std::uint64_t brickIndex = 0; brickIndex < numBricks; brickIndex++)
+    {
+        auto& entry = header.bricks[brickIndex];
+        std::uint32_t codec = 0;
+
+        stream >> entry.offset >> entry.size >> codec;
+
+        entry.codec = static_cast<Codec>(codec);
+
+        if (entry.offset + entry.size > static_cast<std::uint64_t>(file.size()))
+            throw std::runtime_error("Brick " + std::to_string(brickIndex) + " lies outside of the file, the file is truncated.");
+
+        if (entry.codec != Codec::Raw && entry.codec != Codec::Zlib && entry.codec != Codec::Zstd)
+            throw std::runtime_error("Brick " + std::to_string(brickIndex) + " uses an unknown codec.");
+
+#ifndef USE_ZSTD
+        if (entry.codec == Codec::Zstd)
+            throw std::runtime_error("Bricked volume is compressed with zstd, but this build does not support it (enable USE_ZSTD).");
+#endif
+    }
+
+    if (stream.status() != QDataStream::Ok)
+        throw std::runtime_error("Bricked volume index table is truncated.");
+
+    if (fileVersion >= 2)
+    {
+        std::uint32_t flags = 0;
+
+        stream >> flags;
+
+        if (flags & quantizedFlag)
+        {
+            header.quantizationScale.resize(header.numComponents);
+            header.quantizationOffset.resize(header.numComponents);
+
+            for (std::uint32_t c = 0; c < header.numComponents; c++)
+                stream >> header.quantizationScale[c] >> header.quantizationOffset[c];
+        }
+
+        if (flags & statisticsFlag)
+        {
+            header.componentMinimum.resize(header.numComponents);
+            header.componentMaximum.resize(header.numComponents);
+            header.componentMean.resize(header.numComponents);
+            header.componentHistograms.resize(header.numComponents);
+
+            for (std::uint32_t c = 0; c < header.numComponents && stream.status() == QDataStream::Ok; c++)
+            {
+                std::uint32_t numBins = 0;
+
+                stream >> header.componentMinimum[c] >> header.componentMaximum[c] >> header.componentMean[c] >> numBins;
+
+                // Histograms are small, a larger count means the metadata is corrupt
+                if (numBins > 65536)
+                    throw std::runtime_error("Bricked volume metadata is invalid.");
+
+                header.componentHistograms[c].resize(numBins);
+
+                for (auto& binCount : header.componentHistograms[c])
+                    stream >> binCount;
+            }
+        }
+
+        if (stream.status() != QDataStream::Ok)
+            throw std::runtime_error("Bricked volume metadata is truncated.");
+    }
+
+    return header;
+}
+
+/**
+ * Decode the bricks in the range [firstBrick, lastBrick) in parallel into the volume
+ * @param fileData Contents of the (memory-mapped) bricked volume file
+ * @param header Header of the bricked volume
+ * @param volume Destination with room for all voxels of the volume
+ * @throws std::runtime_error when a brick is corrupt
+ */
+inline void decodeBricks(const char* fileData, const Header& header, std::uint64_t firstBrick, std::uint64_t lastBrick, char* volume)
+{
+    std::atomic<std::int64_t> corruptBrick(-1);
+
+    #pragma omp parallel
+    {
+        std::vector<char> brick(header.getMaxBrickBytes());
+
+        // Bricks at the border are smaller and compression ratios differ, so the bricks are handed out dynamically
+        #pragma omp for schedule(dynamic)
+        for (std::int64_t brickIndex = static_cast<std::int64_t>(firstBrick); brickIndex < static_cast<std::int64_t>(lastBrick); brickIndex++)
+        {
+            const auto& entry   = header.bricks[brickIndex];
+            const auto extent   = header.getBrickExtent(brickIndex);
+            const auto numBytes = header.getBrickBytes(extent);
+
+            if (decompressBrick(fileData + entry.offset, entry.size, entry.codec, brick.data(), numBytes))
+                scatterBrick(header, extent, brick.data(), volume);
+            else
+                corruptBrick = brickIndex;
+        }
+    }
+
+    if (corruptBrick >= 0)
+        throw std::runtime_error("Brick " + std::to_string(corruptBrick.load()) + " could not be decompressed, the file is corrupt.");
+}
+
+/**
+ * Write a volume as a bricked volume, the bricks of each brick layer are gathered and compressed in parallel before they are written
+ * @param file File opened for writing
+ * @param header Header describing the volume, the index table is filled in
+ * @param volume Voxel data laid out like the point data of a Volumes dataset
+ * @param codec Codec to compress the bricks with
+ * @param progressCallback Called with the progress in the range [0, 1] after each brick layer (optional)
+ * @throws std::runtime_error when the file could not be written
+ */
+inline void writeVolume(QFile& file, Header& header, const char* volume, Codec codec, const std::function<void(float)>& progressCallback = nullptr)
+{
+    const auto numBricks        = header.getNumberOfBricks();
+    const auto bricksPerLayer   = static_cast<std::uint64_t>(header.getNumberOfBricksX()) * header.getNumberOfBricksY();
+
+    if (header.isQuantized() && (header.quantizationScale.size() != header.numComponents || header.quantizationOffset.size() != header.numComponents))
+        throw std::runtime_error("The quantization does not match the number of components.");
+
+    if (header.hasStatistics() && (header.componentMinimum.size() != header.numComponents || header.componentMaximum.size() != header.numComponents ||
+                                   header.componentMean.size() != header.numComponents || header.componentHistograms.size() != header.numComponents))
+        throw std::runtime_error("The statistics do not match the number of components.");
+
+    header.bricks.assign(numBricks, BrickEntry());
+
+    // Payloads are written after the header and index table, which are written last once all offsets are known
+    if (!file.seek(header.getPayloadOffset()))
+        throw std::runtime_error("Could not seek past the bricked volume index table.");
+
+    std::vector<QByteArray> payloads(bricksPerLayer);
+
+    for (std::uint64_t firstBrick = 0; firstBrick < numBricks; firstBrick += bricksPerLayer)
+    {
+        #pragma omp parallel
+        {
+            std::vector<char> brick(header.getMaxBrickBytes());
+
+            #pragma omp for schedule(dynamic)
+            for (std::int64_t layerIndex = 0; layerIndex < static_cast<std::int64_t>(bricksPerLayer); layerIndex++)
+            {
+                const auto brickIndex   = firstBrick + layerIndex;
+                const auto extent       = header.getBrickExtent(brickIndex);
+                const auto numBytes     = header.getBrickBytes(extent);
+
+                gatherBrick(header, extent, volume, brick.data());
+
+                auto brickCodec = codec;
+
+                payloads[layerIndex] = compressBrick(brick.data(), numBytes, brickCodec);
+                header.bricks[brickIndex].codec = brickCodec;
+            }
+        }
+
+        for (std::uint64_t layerIndex = 0; layerIndex < bricksPerLayer; layerIndex++)
+        {
+            auto& entry = header.bricks[firstBrick + layerIndex];
+
+            entry.offset    = static_cast<std::uint64_t>(file.pos());
+            entry.size      = static_cast<std::uint32_t>(payloads[layerIndex].size());
+
+            if (file.write(payloads[layerIndex]) != payloads[layerIndex].size())
+                throw std::runtime_error("Could not write brick " + std::to_string(firstBrick + layerIndex) + ".");
+        }
+
+        if (progressCallback)
+            progressCallback(static_cast<float>(firstBrick + bricksPerLayer) / numBricks);
+    }
+
+    if (!file.seek(0))
+        throw std::runtime_error("Could not seek to the bricked volume header.");
+
+    QDataStream stream(&file);
+    stream.setByteOrder(QDataStream::LittleEndian);
+
+    QByteArray elementTypeName = header.elementTypeName.toLatin1().leftJustified(elementTypeNameSize, '\0', true);
+
+    stream.writeRawData(magic, 4);
+    stream << version << header.sizeX << header.sizeY << header.sizeZ << header.numComponents << header.brickSize << header.elementSize;
+    stream.writeRawData(elementTypeName.constData(), elementTypeNameSize);
+    stream << static_cast<quint64>(numBricks);
+
+    for (const auto& entry : header.bricks)
+        stream << entry.offset << entry.size << static_cast<std::uint32_t>(entry.codec);
+
+    stream << ((header.isQuantized() ? quantizedFlag : 0u) | (header.hasStatistics() ? statisticsFlag : 0u));
+
+    if (header.isQuantized())
+        for (std::uint32_t c = 0; c < header.numComponents; c++)
+            stream << header.quantizationScale[c] << header.quantizationOffset[c];
+
+    if (header.hasStatistics())
+    {
+        for (std::uint32_t c = 0; c < header.numComponents; c++)
+        {
+            stream << header.componentMinimum[c] << header.componentMaximum[c] << header.componentMean[c] << static_cast<std::uint32_t>(header.componentHistograms[c].size());
+
+            for (const auto binCount : header.componentHistograms[c])
+                stream << binCount;
+        }
+    }
+
+    if (stream.status() != QDataStream::Ok)
+        throw std::runtime_error("Could not write the bricked volume header.");
+}
+
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+// =============================================================================
+// OpenMP support
+// =============================================================================
+//
+// The plugins are also built with MSVC, which only supports OpenMP 2.0. The parallel loops of the kernels therefore follow two rules:
+//   - Loop indices are signed, std::int64_t for loops over voxels, since OpenMP 2.0 has no unsigned loop indices.
+//   - There are no min/max reductions, so each thread keeps its own partial result (range, maximum, histogram) that is merged into
+//     the shared result in a critical section at the end of the parallel region.
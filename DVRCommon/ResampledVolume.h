@@ -0,0 +1,214 @@
+#pragma once
+
+#include "SparseVolume.h"
+#include "VolumeResampling.h"
+
+#include <CoreInterface.h>
+#include <Dataset.h>
+#include <PointData/PointData.h>
+#include <VolumeData/Volumes.h>
+
+#include <QByteArray>
+#include <QString>
+#include <QVariant>
+#include <QtDebug>
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <numeric>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+// =============================================================================
+// Resampled volume
+// =============================================================================
+
+namespace VolumeResampling {
+
+    /**
+     * Cropped and resampled elements of a Volumes dataset. They are computed by resampleValues on a worker thread and turned into
+     * datasets by createResampledVolume on the GUI thread, since datasets can only be created and announced there.
+     */
+    struct ResampledValues
+    {
+        mv::Dataset<Volumes>                        source;                         /** Volumes dataset that is resampled */
+        Region                                      region;                         /** Region of the source volume that is resampled */
+        std::int32_t                                targetSize[3] = { 0, 0, 0 };    /** Number of voxels per axis of the resampled volume */
+        int                                         numComponents = 0;              /** Number of interleaved values per voxel */
+        std::function<void(mv::Dataset<Points>&)>   setData;                        /** Moves the resampled elements into point data, empty when the resampling was cancelled or failed */
+        SparseVolume::BrickOccupancy                occupancy;                      /** Occupied bricks of the resampled grid, empty when the source has no occupancy */
+        QString                                     error;                          /** Why the resampling failed, empty when it succeeded or was cancelled */
+
+        bool isValid() const {
+            return static_cast<bool>(setData);
+        }
+    };
+
+    /**
+     * Crop and resample the elements of volume point data, only reads the dataset such that it can run on a worker thread.
+     * The elements keep the type of the source point data, subsets of the point data are gathered as floats first.
+     * @param sourcePoints Point data with the interleaved elements of the volume
+     * @param volumeSize Number of voxels per axis of the volume
+     * @param brickSize Size of the bricks of which the occupancy is recomputed for the resampled grid, 0 when the volume has no occupancy
+     * @param region Region of the source volume that is resampled
+     * @param targetSize Number of voxels per axis of the resampled volume
+     * @param filter Filter used to compute the resampled voxels
+     * @param progressCallback Called with the progress in the range [0, 1], returns false when the resampling should be cancelled (optional)
+     * @return Resampled elements without a source Volumes dataset, without data when the resampling was cancelled or failed
+     */
+    inline ResampledValues resampleValues(const mv::Dataset<Points>& sourcePoints, const Size3D& volumeSize, int brickSize, const Region& region, const std::int32_t targetSize[3], Filter filter, const std::function<bool(float)>& progressCallback = nullptr)
+    {
+        ResampledValues resampled;
+
+        resampled.region = region;
+
+        std::copy(targetSize, targetSize + 3, resampled.targetSize);
+
+        try {
+            if (!sourcePoints.isValid())
+                throw std::runtime_error("The volume has no point data to resample.");
+
+            const auto numComponents = static_cast<int>(sourcePoints->getNumDimensions());
+
+            if (!region.isValid(volumeSize.width(), volumeSize.height(), volumeSize.depth()))
+                throw std::runtime_error("The region to resample lies outside the volume.");
+
+            resampled.numComponents = numComponents;
+
+            // Voxelized volumes are mostly zero, so their occupancy is recomputed for the resampled grid
+            const bool hasOccupancy = brickSize > 0;
+
+            const auto resampleElements = [&](auto begin, auto elementType) -> void {
+                using T = decltype(elementType);
+
+                // std::function needs a copyable target, so the elements are shared until they are moved into the point data
+                auto values = std::make_shared<std::vector<T>>(resample<T>(begin, volumeSize.width(), volumeSize.height(), numComponents, region, targetSize, filter, progressCallback));
+
+                if (values->empty())
+                    return;
+
+                if (hasOccupancy) {
+                    resampled.occupancy = SparseVolume::computeOccupancy(targetSize[0], targetSize[1], targetSize[2], brickSize, [&values, numComponents](std::int64_t voxelIndex) -> bool {
+                        for (int c = 0; c < numComponents; c++)
+                            if (static_cast<float>((*values)[voxelIndex * numComponents + c]) != 0.0f)
+                                return true;
+
+                        return false;
+                    });
+                }
+
+                resampled.setData = [values, numComponents](mv::Dataset<Points>& points) -> void {
+                    points->setData(std::move(*values), numComponents);
+                };
+            };
+
+            // Full datasets are resampled in place with their own element type, subsets are gathered as floats first
+            if (sourcePoints->isFull()) {
+                sourcePoints->visitFromBeginToEnd([&resampleElements](auto begin, auto end) {
+                    resampleElements(begin, std::decay_t<decltype(*begin)>{});
+                });
+            }
+            else {
+                std::vector<float> values(static_cast<std::size_t>(sourcePoints->getNumPoints()) * numComponents);
+                std::vector<int> dimensionIndices(numComponents);
+
+                std::iota(dimensionIndices.begin(), dimensionIndices.end(), 0);
+                sourcePoints->populateDataForDimensions(values, dimensionIndices);
+
+                resampleElements(values.cbegin(), float{});
+            }
+        }
+        catch (const std::exception& e) {
+            resampled.setData   = nullptr;
+            resampled.error     = e.what();
+        }
+
+        return resampled;
+    }
+
+    /**
+     * Crop and resample the elements of a Volumes dataset, only reads the dataset such that it can run on a worker thread
+     * @param source Volumes dataset that is resampled
+     * @param region Region of the source volume that is resampled
+     * @param targetSize Number of voxels per axis of the resampled volume
+     * @param filter Filter used to compute the resampled voxels
+     * @param progressCallback Called with the progress in the range [0, 1], returns false when the resampling should be cancelled (optional)
+     * @return Resampled elements, without data when the resampling was cancelled or failed
+     */
+    inline ResampledValues resampleValues(const mv::Dataset<Volumes>& source, const Region& region, const std::int32_t targetSize[3], Filter filter, const std::function<bool(float)>& progressCallback = nullptr)
+    {
+        const bool hasOccupancy = source->hasProperty("BrickSize") && source->hasProperty("BrickOccupancy");
+
+        auto resampled = resampleValues(mv::Dataset<Points>(source->getParent()), source->getVolumeSize(), hasOccupancy ? source->getProperty("BrickSize").toInt() : 0, region, targetSize, filter, progressCallback);
+
+        resampled.source = source;
+
+        return resampled;
+    }
+
+    /**
+     * Create a Volumes dataset from resampled elements, on the GUI thread. The new dataset is a child of the source, its point data
+     * keeps the element type, dimension names and quantization of the source point data.
+     * The value ranges of the source are kept, such that transfer functions map the resampled values exactly like the source values, and
+     * the brick occupancy is the one recomputed for the resampled grid.
+     * @param resampled Elements computed by resampleValues with the source Volumes dataset set, they are moved into the new dataset
+     * @return Resampled Volumes dataset
+     */
+    inline mv::Dataset<Volumes> createResampledVolume(ResampledValues& resampled)
+    {
+        if (!resampled.isValid())
+            throw std::runtime_error(resampled.error.isEmpty() ? "The volume was not resampled." : resampled.error.toStdString());
+
+        const auto& source          = resampled.source;
+        const auto* targetSize      = resampled.targetSize;
+        const auto numComponents    = resampled.numComponents;
+
+        mv::Dataset<Points> sourcePoints(source->getParent());
+
+        if (!sourcePoints.isValid())
+            throw std::runtime_error("The volume has no point data to resample.");
+
+        const auto name = QString("%1 (%2x%3x%4)").arg(source->getGuiName()).arg(targetSize[0]).arg(targetSize[1]).arg(targetSize[2]);
+
+        auto points = mv::data().createDataset<Points>("Points", name, source);
+
+        resampled.setData(points);
+        resampled.setData = nullptr;
+
+        points->setDimensionNames(sourcePoints->getDimensionNames());
+
+        for (const auto& propertyName : { "QuantizationScale", "QuantizationOffset" })
+            if (sourcePoints->hasProperty(propertyName))
+                points->setProperty(propertyName, sourcePoints->getProperty(propertyName));
+
+        mv::events().notifyDatasetDataChanged(points);
+
+        auto volumes = mv::data().createDataset<Volumes>("Volumes", name, points);
+
+        volumes->setVolumeSize(Size3D(targetSize[0], targetSize[1], targetSize[2]));
+        volumes->setComponentsPerVoxel(numComponents);
+
+        for (const auto& propertyName : { "ComponentMinimum", "ComponentMaximum" })
+            if (source->hasProperty(propertyName))
+                volumes->setProperty(propertyName, source->getProperty(propertyName));
+
+        const auto& occupancy = resampled.occupancy;
+
+        if (occupancy.isValid() && occupancy.getNumberOfOccupiedBricks() < occupancy.getNumberOfBricks()) {
+            volumes->setProperty("BrickSize", occupancy.brickSize);
+            volumes->setProperty("BrickOccupancy", QByteArray(reinterpret_cast<const char*>(occupancy.occupied.data()), static_cast<qsizetype>(occupancy.occupied.size())));
+        }
+
+        mv::events().notifyDatasetDataChanged(volumes);
+
+        const auto& region = resampled.region;
+
+        qDebug() << "VolumeResampling: Resampled" << source->getGuiName() << "from" << region.getSize(0) << "x" << region.getSize(1) << "x" << region.getSize(2)
+                 << "to" << targetSize[0] << "x" << targetSize[1] << "x" << targetSize[2];
+
+        return volumes;
+    }
+}
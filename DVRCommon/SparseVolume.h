@@ -0,0 +1,137 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include <OpenMPSupport.h>
+
+// =============================================================================
+// Sparse volume
+// =============================================================================
+//
+// Volumes that are voxelized from points are mostly empty. Point data is dense, so the voxels themselves stay a regular grid, but the
+// loader records which bricks of brickSize^3 voxels hold any data. The viewer only uses this occupancy to leave the render cubes without
+// occupied bricks out, such that the rays start and end at the occupied part of the volume. The voxels are still stored and uploaded
+// for the whole grid: storing only the occupied bricks would need a brick pool in the volumes dataset and an indirection in the shaders.
+//
+// The occupancy is attached to a Volumes dataset as the properties "BrickSize" (int) and "BrickOccupancy" (one byte per brick, ordered
+// x fastest, then y, then z, exactly like the bricks of a bricked volume).
+
+namespace SparseVolume {
+
+    constexpr std::int32_t defaultBrickSize = 8;
+
+    /** Occupancy of the bricks of a volume, bricks at the upper borders are clipped to the volume */
+    struct BrickOccupancy
+    {
+        std::int32_t                sizeX = 0;                      /** Number of voxels on the x-axis */
+        std::int32_t                sizeY = 0;                      /** Number of voxels on the y-axis */
+        std::int32_t                sizeZ = 0;                      /** Number of voxels on the z-axis */
+        std::int32_t                brickSize = defaultBrickSize;   /** Number of voxels along every axis of a brick */
+        std::vector<std::uint8_t>   occupied;                       /** Non-zero for bricks with at least one occupied voxel */
+
+        std::int32_t getNumberOfBricksX() const { return (sizeX + brickSize - 1) / brickSize; }
+        std::int32_t getNumberOfBricksY() const { return (sizeY + brickSize - 1) / brickSize; }
+        std::int32_t getNumberOfBricksZ() const { return (sizeZ + brickSize - 1) / brickSize; }
+
+        std::int64_t getNumberOfBricks() const {
+            return static_cast<std::int64_t>(getNumberOfBricksX()) * getNumberOfBricksY() * getNumberOfBricksZ();
+        }
+
+        /** Get whether the occupancy is set and matches the volume size */
+        bool isValid() const {
+            return brickSize > 0 && sizeX > 0 && sizeY > 0 && sizeZ > 0 && static_cast<std::int64_t>(occupied.size()) == getNumberOfBricks();
+        }
+
+        std::int64_t getNumberOfOccupiedBricks() const {
+            return std::count_if(occupied.begin(), occupied.end(), [](std::uint8_t value) { return value != 0; });
+        }
+
+        /** Get the fraction of the bricks that is occupied, a volume without occupancy counts as fully occupied */
+        float getOccupiedFraction() const {
+            return isValid() ? static_cast<float>(getNumberOfOccupiedBricks()) / static_cast<float>(getNumberOfBricks()) : 1.0f;
+        }
+
+        /**
+         * Get whether any brick that overlaps a voxel region is occupied
+         * @param begin First voxel of the region per axis
+         * @param end One past the last voxel of the region per axis
+         * @return Whether the region overlaps an occupied brick, regions are occupied when the occupancy is not valid
+         */
+        bool isRegionOccupied(const std::int32_t begin[3], const std::int32_t end[3]) const
+        {
+            if (!isValid())
+                return true;
+
+            const std::int32_t numBricks[3] = { getNumberOfBricksX(), getNumberOfBricksY(), getNumberOfBricksZ() };
+
+            std::int32_t firstBrick[3], lastBrick[3];
+
+            for (int axis = 0; axis < 3; axis++)
+            {
+                if (end[axis] <= begin[axis])
+                    return false;
+
+                firstBrick[axis]    = std::clamp(begin[axis] / brickSize, 0, numBricks[axis] - 1);
+                lastBrick[axis]     = std::clamp((end[axis] - 1) / brickSize, 0, numBricks[axis] - 1);
+            }
+
+            for (std::int32_t bz = firstBrick[2]; bz <= lastBrick[2]; bz++)
+                for (std::int32_t by = firstBrick[1]; by <= lastBrick[1]; by++)
+                    for (std::int32_t bx = firstBrick[0]; bx <= lastBrick[0]; bx++)
+                        if (occupied[bx + static_cast<std::int64_t>(numBricks[0]) * (by + static_cast<std::int64_t>(numBricks[1]) * bz)])
+                            return true;
+
+            return false;
+        }
+    };
+
+    /**
+     * Compute the brick occupancy of a volume, the bricks are scanned in parallel and every brick stops at its first occupied voxel
+     * @param sizeX Number of voxels on the x-axis
+     * @param sizeY Number of voxels on the y-axis
+     * @param sizeZ Number of voxels on the z-axis
+     * @param brickSize Number of voxels along every axis of a brick
+     * @param isVoxelOccupied Predicate that gets the linear index (x fastest) of a voxel and returns whether it holds data
+     * @return Brick occupancy
+     */
+    template <typename VoxelPredicate>
+    BrickOccupancy computeOccupancy(std::int32_t sizeX, std::int32_t sizeY, std::int32_t sizeZ, std::int32_t brickSize, VoxelPredicate isVoxelOccupied)
+    {
+        BrickOccupancy occupancy;
+
+        occupancy.sizeX     = sizeX;
+        occupancy.sizeY     = sizeY;
+        occupancy.sizeZ     = sizeZ;
+        occupancy.brickSize = std::max(brickSize, 1);
+        occupancy.occupied.assign(occupancy.getNumberOfBricks(), 0);
+
+        const auto numBricksX   = occupancy.getNumberOfBricksX();
+        const auto numBricksY   = occupancy.getNumberOfBricksY();
+        const auto numBricks    = occupancy.getNumberOfBricks();
+
+        #pragma omp parallel for schedule(dynamic, 16)
+        for (std::int64_t brickIndex = 0; brickIndex < numBricks; brickIndex++)
+        {
+            const auto bx = static_cast<std::int32_t>(brickIndex % numBricksX);
+            const auto by = static_cast<std::int32_t>((brickIndex / numBricksX) % numBricksY);
+            const auto bz = static_cast<std::int32_t>(brickIndex / (static_cast<std::int64_t>(numBricksX) * numBricksY));
+
+            const auto beginX = bx * occupancy.brickSize, endX = std::min(beginX + occupancy.brickSize, sizeX);
+            const auto beginY = by * occupancy.brickSize, endY = std::min(beginY + occupancy.brickSize, sizeY);
+            const auto beginZ = bz * occupancy.brickSize, endZ = std::min(beginZ + occupancy.brickSize, sizeZ);
+
+            bool isOccupied = false;
+
+            for (std::int32_t z = beginZ; z < endZ && !isOccupied; z++)
+                for (std::int32_t y = beginY; y < endY && !isOccupied; y++)
+                    for (std::int32_t x = beginX; x < endX && !isOccupied; x++)
+                        isOccupied = isVoxelOccupied(x + static_cast<std::int64_t>(sizeX) * (y + static_cast<std::int64_t>(sizeY) * z));
+
+            occupancy.occupied[brickIndex] = isOccupied ? 1 : 0;
+        }
+
+        return occupancy;
+    }
+}
@@ -0,0 +1,309 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+#include <OpenMPSupport.h>
+
+// =============================================================================
+// Volume resampling
+// =============================================================================
+//
+// Crops a region of interest out of an interleaved volume and resamples it to an arbitrary target size, such that a volume that does
+// not fit in the GPU memory or exceeds the maximum 3D texture size can still be shown at the best resolution the GPU holds.
+// Voxels are ordered x fastest, then y, then z, with the components of a voxel interleaved, exactly like the point data of a Volumes
+// dataset. The elements keep their type, such that a resampled volume takes no more memory per voxel than its source.
+
+namespace VolumeResampling {
+
+    /** Filter that computes a target voxel from the source voxels it covers, per component */
+    enum class Filter
+    {
+        Box,        /** Mean of the covered voxels, for continuous data */
+        Trilinear,  /** Interpolated at the center of the target voxel, for smooth upsampling and mild downsampling */
+        Max         /** Maximum of the covered voxels, keeps thin bright structures visible in maximum intensity projections */
+    };
+
+    /** Box of voxels [begin, end) per axis that is cropped from a volume */
+    struct Region
+    {
+        std::int32_t begin[3] = { 0, 0, 0 };
+        std::int32_t end[3] = { 0, 0, 0 };
+
+        std::int32_t getSize(int axis) const {
+            return end[axis] - begin[axis];
+        }
+
+        std::int64_t getNumberOfVoxels() const {
+            return static_cast<std::int64_t>(getSize(0)) * getSize(1) * getSize(2);
+        }
+
+        /** Get whether the region is non-empty and lies within a volume of the given size */
+        bool isValid(std::int32_t sizeX, std::int32_t sizeY, std::int32_t sizeZ) const {
+            const std::int32_t size[3] = { sizeX, sizeY, sizeZ };
+
+            for (int axis = 0; axis < 3; axis++)
+                if (begin[axis] < 0 || end[axis] > size[axis] || end[axis] <= begin[axis])
+                    return false;
+
+            return true;
+        }
+    };
+
+    /** Get the region that covers a whole volume */
+    inline Region getFullRegion(std::int32_t sizeX, std::int32_t sizeY, std::int32_t sizeZ)
+    {
+        Region region;
+
+        region.end[0] = sizeX;
+        region.end[1] = sizeY;
+        region.end[2] = sizeZ;
+
+        return region;
+    }
+
+    /**
+     * Get the largest size with the aspect ratio of a region that fits in the texture size and memory limits of a GPU
+     * @param region Cropped region of the volume
+     * @param bytesPerVoxel Number of bytes a voxel takes on the GPU
+     * @param maxTextureSize Maximum number of voxels along an axis of a 3D texture
+     * @param memoryBudget Number of bytes available for the volume
+     * @param targetSize Receives the number of voxels per axis, equal to the region size when it fits already
+     */
+    inline void computeFittingSize(const Region& region, std::int64_t bytesPerVoxel, std::int32_t maxTextureSize, std::int64_t memoryBudget, std::int32_t targetSize[3])
+    {
+        double scale = 1.0;
+
+        for (int axis = 0; axis < 3; axis++)
+            scale = std::min(scale, static_cast<double>(maxTextureSize) / static_cast<double>(region.getSize(axis)));
+
+        const double regionBytes = static_cast<double>(region.getNumberOfVoxels()) * static_cast<double>(bytesPerVoxel);
+
+        if (regionBytes > static_cast<double>(memoryBudget))
+            scale = std::min(scale, std::cbrt(static_cast<double>(memoryBudget) / regionBytes));
+
+        // Rounding down every axis can only shrink the volume, the loop catches the rare case where the cube root rounds up
+        for (;;)
+        {
+            for (int axis = 0; axis < 3; axis++)
+                targetSize[axis] = std::clamp(static_cast<std::int32_t>(std::floor(region.getSize(axis) * scale)), 1, region.getSize(axis));
+
+            const auto targetBytes = static_cast<std::int64_t>(targetSize[0]) * targetSize[1] * targetSize[2] * bytesPerVoxel;
+
+            if (targetBytes <= memoryBudget || (targetSize[0] == 1 && targetSize[1] == 1 && targetSize[2] == 1))
+                break;
+
+            scale *= 0.99;
+        }
+    }
+
+    /**
+     * Get the size with the aspect ratio of a region that has a given number of voxels along its longest axis
+     * @param region Cropped region of the volume
+     * @param longestAxisSize Number of voxels along the longest axis of the target volume
+     * @param targetSize Receives the number of voxels per axis, at least one
+     */
+    inline void computeScaledSize(const Region& region, std::int32_t longestAxisSize, std::int32_t targetSize[3])
+    {
+        const auto longestRegionAxisSize = std::max({ region.getSize(0), region.getSize(1), region.getSize(2) });
+        const double scale = static_cast<double>(longestAxisSize) / static_cast<double>(longestRegionAxisSize);
+
+        for (int axis = 0; axis < 3; axis++)
+            targetSize[axis] = std::max(1, static_cast<std::int32_t>(std::lround(region.getSize(axis) * scale)));
+    }
+
+    /** Source voxels that contribute to the target voxels along one axis */
+    struct AxisSamples
+    {
+        std::vector<std::int32_t>   begin;      /** First covered source voxel, for the box and max filters */
+        std::vector<std::int32_t>   end;        /** One past the last covered source voxel, for the box and max filters */
+        std::vector<std::int32_t>   lower;      /** Source voxel below the target voxel center, for the trilinear filter */
+        std::vector<std::int32_t>   upper;      /** Source voxel above the target voxel center, for the trilinear filter */
+        std::vector<float>          weight;     /** Weight of the upper voxel, for the trilinear filter */
+    };
+
+    /**
+     * Compute which source voxels contribute to every target voxel along an axis.
+     * A target voxel covers the source voxels whose centers lie in its footprint, such that every source voxel is used exactly once when
+     * downsampling. When upsampling a footprint may not hold any center, the target voxel then takes the source voxel under its own center.
+     */
+    inline AxisSamples computeAxisSamples(std::int32_t regionBegin, std::int32_t regionSize, std::int32_t targetSize)
+    {
+        AxisSamples samples;
+
+        samples.begin.resize(targetSize);
+        samples.end.resize(targetSize);
+        samples.lower.resize(targetSize);
+        samples.upper.resize(targetSize);
+        samples.weight.resize(targetSize);
+
+        const double scale = static_cast<double>(regionSize) / static_cast<double>(targetSize);
+
+        for (std::int32_t t = 0; t < targetSize; t++)
+        {
+            auto begin  = static_cast<std::int32_t>(std::ceil(t * scale - 0.5));
+            auto end    = static_cast<std::int32_t>(std::ceil((t + 1) * scale - 0.5));
+
+            begin   = std::clamp(begin, 0, regionSize - 1);
+            end     = std::clamp(end, begin, regionSize);
+
+            if (end == begin) {
+                begin   = std::clamp(static_cast<std::int32_t>((t + 0.5) * scale), 0, regionSize - 1);
+                end     = begin + 1;
+            }
+
+            samples.begin[t]    = regionBegin + begin;
+            samples.end[t]      = regionBegin + end;
+
+            const double center = std::clamp((t + 0.5) * scale - 0.5, 0.0, static_cast<double>(regionSize - 1));
+            const auto lower    = static_cast<std::int32_t>(center);
+
+            samples.lower[t]    = regionBegin + lower;
+            samples.upper[t]    = regionBegin + std::min(lower + 1, regionSize - 1);
+            samples.weight[t]   = static_cast<float>(center - lower);
+        }
+
+        return samples;
+    }
+
+    /** Convert a filtered value back to the element type, integers are rounded and saturated */
+    template <typename T>
+    T toElement(double value)
+    {
+        if constexpr (std::is_integral_v<T>)
+            return static_cast<T>(std::clamp(std::floor(value + 0.5), static_cast<double>(std::numeric_limits<T>::lowest()), static_cast<double>(std::numeric_limits<T>::max())));
+        else
+            return static_cast<T>(static_cast<float>(value));
+    }
+
+    /**
+     * Crop and resample a volume, the rows of the target volume are computed in parallel
+     * @param source Random access iterator to the interleaved elements of the source volume
+     * @param sizeX Number of voxels on the x-axis of the source volume
+     * @param sizeY Number of voxels on the y-axis of the source volume
+     * @param numComponents Number of interleaved values per voxel
+     * @param region Region of the source volume that is resampled, it must be valid for the source volume
+     * @param targetSize Number of voxels per axis of the target volume
+     * @param filter Filter used to compute the target voxels
+     * @param progressCallback Called with the progress in the range [0, 1] after each chunk of rows, returns false when the resampling should be cancelled (optional)
+     * @return Interleaved elements of the target volume, empty when the resampling was cancelled
+     */
+    template <typename T, typename Iterator>
+    std::vector<T> resample(Iterator source, std::int32_t sizeX, std::int32_t sizeY, int numComponents, const Region& region, const std::int32_t targetSize[3], Filter filter, const std::function<bool(float)>& progressCallback = nullptr)
+    {
+        const auto samplesX = computeAxisSamples(region.begin[0], region.getSize(0), targetSize[0]);
+        const auto samplesY = computeAxisSamples(region.begin[1], region.getSize(1), targetSize[1]);
+        const auto samplesZ = computeAxisSamples(region.begin[2], region.getSize(2), targetSize[2]);
+
+        std::vector<T> target(static_cast<std::size_t>(targetSize[0]) * targetSize[1] * targetSize[2] * numComponents);
+
+        const std::int64_t numRows = static_cast<std::int64_t>(targetSize[1]) * targetSize[2];
+
+        // Gets the index of the first element of a source voxel
+        const auto getIndex = [sizeX, sizeY, numComponents](std::int32_t x, std::int32_t y, std::int32_t z) -> std::int64_t {
+            return ((static_cast<std::int64_t>(z) * sizeY + y) * sizeX + x) * numComponents;
+        };
+
+        // The rows are resampled in chunks of about 4M target voxels, such that the progress is reported and the resampling can be cancelled
+        const std::int64_t rowsPerChunk = std::max<std::int64_t>(1, (std::int64_t(1) << 22) / targetSize[0]);
+
+        for (std::int64_t chunkBegin = 0; chunkBegin < numRows; chunkBegin += rowsPerChunk)
+        {
+            const std::int64_t chunkEnd = std::min(chunkBegin + rowsPerChunk, numRows);
+
+            #pragma omp parallel
+            {
+                std::vector<double> values(numComponents);
+
+                #pragma omp for schedule(dynamic, 4)
+                for (std::int64_t row = chunkBegin; row < chunkEnd; row++)
+                {
+                    const auto y = static_cast<std::int32_t>(row % targetSize[1]);
+                    const auto z = static_cast<std::int32_t>(row / targetSize[1]);
+
+                    T* destination = target.data() + row * targetSize[0] * numComponents;
+
+                    for (std::int32_t x = 0; x < targetSize[0]; x++, destination += numComponents)
+                    {
+                        if (filter == Filter::Trilinear)
+                        {
+                            const std::int32_t  xs[2] = { samplesX.lower[x], samplesX.upper[x] };
+                            const std::int32_t  ys[2] = { samplesY.lower[y], samplesY.upper[y] };
+                            const std::int32_t  zs[2] = { samplesZ.lower[z], samplesZ.upper[z] };
+                            const double        wx[2] = { 1.0 - samplesX.weight[x], samplesX.weight[x] };
+                            const double        wy[2] = { 1.0 - samplesY.weight[y], samplesY.weight[y] };
+                            const double        wz[2] = { 1.0 - samplesZ.weight[z], samplesZ.weight[z] };
+
+                            std::fill(values.begin(), values.end(), 0.0);
+
+                            for (int k = 0; k < 8; k++)
+                            {
+                                const double weight = wx[k & 1] * wy[(k >> 1) & 1] * wz[k >> 2];
+
+                                if (weight == 0.0)
+                                    continue;
+
+                                const auto index = getIndex(xs[k & 1], ys[(k >> 1) & 1], zs[k >> 2]);
+
+                                for (int c = 0; c < numComponents; c++)
+                                    values[c] += weight * static_cast<double>(source[index + c]);
+                            }
+                        }
+                        else
+                        {
+                            const bool isMax = filter == Filter::Max;
+
+                            // The maximum starts at the first covered voxel, which avoids relying on the lowest value of the element type
+                            const auto firstIndex = getIndex(samplesX.begin[x], samplesY.begin[y], samplesZ.begin[z]);
+
+                            for (int c = 0; c < numComponents; c++)
+                                values[c] = isMax ? static_cast<double>(source[firstIndex + c]) : 0.0;
+
+                            for (std::int32_t sz = samplesZ.begin[z]; sz < samplesZ.end[z]; sz++)
+                            {
+                                for (std::int32_t sy = samplesY.begin[y]; sy < samplesY.end[y]; sy++)
+                                {
+                                    auto index = getIndex(samplesX.begin[x], sy, sz);
+
+                                    for (std::int32_t sx = samplesX.begin[x]; sx < samplesX.end[x]; sx++, index += numComponents)
+                                    {
+                                        for (int c = 0; c < numComponents; c++)
+                                        {
+                                            const auto value = static_cast<double>(source[index + c]);
+
+                                            if (isMax)
+                                                values[c] = std::max(values[c], value);
+                                            else
+                                                values[c] += value;
+                                        }
+                                    }
+                                }
+                            }
+
+                            if (!isMax)
+                            {
+                                const double count = static_cast<double>(samplesX.end[x] - samplesX.begin[x]) * (samplesY.end[y] - samplesY.begin[y]) * (samplesZ.end[z] - samplesZ.begin[z]);
+
+                                for (int c = 0; c < numComponents; c++)
+                                    values[c] /= count;
+                            }
+                        }
+
+                        for (int c = 0; c < numComponents; c++)
+                            destination[c] = toElement<T>(values[c]);
+                    }
+                }
+            }
+
+            if (progressCallback && !progressCallback(static_cast<float>(chunkEnd) / numRows))
+                return {};
+        }
+
+        return target;
+    }
+}
@@ -7,6 +7,8 @@ in vec3 worldPos;
 uniform sampler2D frontFaces;
 uniform sampler2D backFaces;
 uniform sampler3D volumeData;
+uniform vec4 dequantizeScale;  // Maps the (normalized) texels back to the volume values: value = texel * dequantizeScale + dequantizeOffset
+uniform vec4 dequantizeOffset;
 
 uniform float stepSize;
 
@@ -44,7 +46,7 @@ void main()
     {
         samplePos -= increment;
         vec3 volPos = samplePos * invDimensions;
-        float sampleValue = texture(volumeData, volPos).r;
+        float sampleValue = texture(volumeData, volPos).r * dequantizeScale.r + dequantizeOffset.r;
         maxVal = max(maxVal, sampleValue);
     }
 
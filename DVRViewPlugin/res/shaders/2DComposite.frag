@@ -3,7 +3,9 @@ out vec4 FragColor;
 
 uniform sampler2D frontFaces;
 uniform sampler2D backFaces;
-uniform sampler3D volumeData;
+uniform sampler3D volumeData;  // contains the 2D positions of the DR as RG16 (or RG8) normalized texels
+uniform vec4 dequantizeScale;  // Maps the (normalized) texels back to the volume values: value = texel * dequantizeScale + dequantizeOffset
+uniform vec4 dequantizeOffset;
 
 uniform sampler2D tfTexture;
 
@@ -40,7 +42,7 @@ void main()
     for (float t = 0.0; t <= lengthRay; t += stepSize)
     {
         vec3 volPos = samplePos * invDimensions; // Convert 3D world position to normalized volume coordinates
-        vec2 sample2DPos = texture(volumeData, volPos).rg * invTfTexSize; // Convert 3D volume position to 2D texture coordinates
+        vec2 sample2DPos = (texture(volumeData, volPos).rg * dequantizeScale.rg + dequantizeOffset.rg) * invTfTexSize; // Convert 3D volume position to 2D texture coordinates
 
         vec4 sampleColor = texture(tfTexture, sample2DPos);
         sampleColor.a *= stepSize; // Compensate for the step size
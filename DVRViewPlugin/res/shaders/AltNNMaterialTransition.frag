@@ -7,7 +7,7 @@ in vec3 worldPos;
 uniform sampler2D frontFaces;
 uniform sampler2D backFaces;
 uniform sampler2D materialTexture; // the material table, index 0 is no material present (air)
-uniform sampler3D volumeData; // contains the Material IDs of the DR
+uniform usampler3D volumeData; // contains the integer Material IDs of the DR
 
 uniform vec3 dimensions; 
 uniform vec3 invDimensions; // Pre-divided dimensions (1.0 / dimensions)
@@ -40,7 +40,7 @@ const float EPSILON = 0.00001f;            // A small value to avoid numerical i
 
 float sampleVolume(vec3 samplePos) {
     vec3 volPos = samplePos * invDimensions;
-    return texture(volumeData, volPos).r;
+    return float(texture(volumeData, volPos).r);
 }
 
 vec3 calculateIntersection(vec3 p1, vec3 p2, vec3 p3, vec3 rayStart, vec3 rayEnd) {  
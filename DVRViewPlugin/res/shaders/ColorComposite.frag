@@ -7,6 +7,8 @@ in vec3 worldPos;
 uniform sampler2D frontFaces;
 uniform sampler2D backFaces;
 uniform sampler3D volumeData;
+uniform vec4 dequantizeScale;  // Maps the (normalized) texels back to the volume values: value = texel * dequantizeScale + dequantizeOffset
+uniform vec4 dequantizeOffset;
 
 uniform vec3 dimensions; // Pre-divided dimensions (1.0 / dimensions)
 uniform vec3 invDimensions; // Pre-divided dimensions (1.0 / dimensions)
@@ -40,7 +42,7 @@ void main()
     for (float t = 0.0; t <= lengthRay; t += stepSize)
     {
         vec3 volPos = samplePos * invDimensions;
-        vec4 sampleColor = texture(volumeData, volPos);
+        vec4 sampleColor = texture(volumeData, volPos) * dequantizeScale + dequantizeOffset;
         sampleColor.a *= stepSize; // Compensate for the step size
 
         // Perform alpha compositing (front to back)
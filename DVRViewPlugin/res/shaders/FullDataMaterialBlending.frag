@@ -11,7 +11,7 @@ uniform vec3 dataDimensions;   // The volume dataset dimensions
 uniform isampler2D rayIDTexture;    // for each pixel, a value that is either a valid ray sample ID or -1 if not used it is a 16-bit int texture
 uniform sampler2D materialTexture; // the material table, index 0 is no material present (air), the tfTexture should have the same
 uniform sampler2D tfTexture;
-uniform sampler3D materialVolumeData; // the volume data texture, used to sample the nearest voxel center for the materialID
+uniform usampler3D materialVolumeData; // the integer material id volume, used to sample the nearest voxel center for the materialID
 
 // Uniforms to convert screen coordinates into normalized texture coordinates.
 uniform vec2 invFaceTexSize;    // 1.0 / (face texture width, face texture height)
@@ -44,7 +44,7 @@ float getMaterialID(inout float[5] materials, vec3 samplePos) {
     float lastMaterial = materials[4];
 
     if(useClutterRemover && firstMaterial == previousMaterial && nextMaterial == lastMaterial && currentMaterial != previousMaterial && currentMaterial != nextMaterial){
-        currentMaterial = texture(materialVolumeData, samplePos).r + 0.5f;
+        currentMaterial = float(texture(materialVolumeData, samplePos).r) + 0.5f;
 
         // Update the materials array with the new material
         materials[2] = currentMaterial;
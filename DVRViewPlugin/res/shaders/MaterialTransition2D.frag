@@ -5,7 +5,9 @@ uniform sampler2D frontFaces;
 uniform sampler2D backFaces;
 uniform sampler2D materialTexture; // the material table, index 0 is no material present (air), the tfTexture should have the same
 uniform sampler2D tfTexture;
-uniform sampler3D volumeData; // contains the 2D positions of the DR
+uniform sampler3D volumeData; // contains the 2D positions of the DR as RG16 (or RG8) normalized texels
+uniform vec4 dequantizeScale;  // Maps the (normalized) texels back to the volume values: value = texel * dequantizeScale + dequantizeOffset
+uniform vec4 dequantizeOffset;
 
 uniform vec3 dimensions; 
 uniform vec3 invDimensions; // Pre-divided dimensions (1.0 / dimensions)
@@ -23,6 +25,11 @@ uniform vec3 u_maxClippingPlane;
 uniform bool useShading;
 uniform bool useClutterRemover;
 
+// Get the normalized 2D position in the transfer function at a position in the volume
+vec2 sample2DPosition(vec3 volPos) {
+    return (texture(volumeData, volPos).rg * dequantizeScale.rg + dequantizeOffset.rg) * invTfTexSize;
+}
+
 float getMaterialID(inout float[5] materials, vec3[5] samplePositions) {
     float firstMaterial = materials[0];
     float previousMaterial = materials[1];
@@ -34,7 +41,7 @@ float getMaterialID(inout float[5] materials, vec3[5] samplePositions) {
 
     if(useClutterRemover && firstMaterial == previousMaterial && nextMaterial == lastMaterial && currentMaterial != previousMaterial && currentMaterial != nextMaterial){
         vec3 samplePos = round(samplePositions[2] + vec3(0.5f)) - vec3(0.5f); // Sample the nearest voxel center instead
-        vec2 sample2DPos = texture(volumeData, samplePos * invDimensions).rg * invTfTexSize;
+        vec2 sample2DPos = sample2DPosition(samplePos * invDimensions);
         currentMaterial = texture(tfTexture, sample2DPos).r + 0.5f;
 
         // Update the materials array with the new material
@@ -50,9 +57,9 @@ vec3 findSurfacePos(vec3 startPos, vec3 direction, int iterations, float[5] mate
     float epsilon = 0.01;
 
     // Sample materials at both ends
-    vec2 lowSample2D = texture(volumeData, lowPos * invDimensions).rg * invTfTexSize;
+    vec2 lowSample2D = sample2DPosition(lowPos * invDimensions);
     float lowMat = texture(tfTexture, lowSample2D).r + 0.5f;
-    vec2 highSample2D = texture(volumeData, highPos * invDimensions).rg * invTfTexSize;
+    vec2 highSample2D = sample2DPosition(highPos * invDimensions);
     float highMat = texture(tfTexture, highSample2D).r + 0.5f;
 
     // If both ends are the same, try to step further
@@ -60,7 +67,7 @@ vec3 findSurfacePos(vec3 startPos, vec3 direction, int iterations, float[5] mate
     int stepCount = 0;
     while (abs(highMat - lowMat) < 0.01 && stepCount < maxStep) {
         highPos += direction;
-        highSample2D = texture(volumeData, highPos * invDimensions).rg * invTfTexSize;
+        highSample2D = sample2DPosition(highPos * invDimensions);
         highMat = texture(tfTexture, highSample2D).r + 0.5f;
         stepCount++;
     }
@@ -74,7 +81,7 @@ vec3 findSurfacePos(vec3 startPos, vec3 direction, int iterations, float[5] mate
         } else {
             midPos = mix(lowPos, highPos, 0.5f); // No bias
         }
-        vec2 midSample2D = texture(volumeData, midPos * invDimensions).rg * invTfTexSize;
+        vec2 midSample2D = sample2DPosition(midPos * invDimensions);
         float midMat = texture(tfTexture, midSample2D).r + 0.5f;
 
         if (abs(midMat - lowMat) > epsilon) {
@@ -95,7 +102,7 @@ vec3 getSurfaceOffsetPos(vec3 offsetPos, vec3 increment, int iterations, float[5
     vec3 temppos = samplePositions[2]; // Store the current position in a temporary variable
     float tempmat = materials[2]; // Store the current material in a temporary variable
 
-    vec2 sample2DPos = texture(volumeData, offsetPos * invDimensions).rg * invTfTexSize; 
+    vec2 sample2DPos = sample2DPosition(offsetPos * invDimensions); 
     samplePositions[2] = offsetPos; 
     materials[2] = texture(tfTexture, sample2DPos).r + 0.5f; // Update the material ID for the current iteration
 
@@ -227,7 +234,7 @@ void main()
     // Walk from front to back
     while (t <= lengthRay + 2 * stepSize)
     {
-        vec2 sample2DPos = texture(volumeData, samplePos * invDimensions).rg * invTfTexSize; 
+        vec2 sample2DPos = sample2DPosition(samplePos * invDimensions); 
         float newMaterial = texture(tfTexture, sample2DPos).r + 0.5f;
 
         // Update the arrays
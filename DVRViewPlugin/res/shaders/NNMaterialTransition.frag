@@ -5,7 +5,7 @@ out vec4 FragColor;
 uniform sampler2D frontFaces;
 uniform sampler2D backFaces;
 uniform sampler2D materialTexture; // the material table, index 0 is no material present (air)
-uniform sampler3D volumeData;      // contains the Material IDs of the DR
+uniform usampler3D volumeData;     // contains the integer Material IDs of the DR
 
 // Volume and texture dimensions
 uniform vec3 dimensions;
@@ -31,7 +31,7 @@ const float EPSILON = 0.00001f;
 float sampleVolume(vec3 samplePos){
     vec3 voxelPos = floor(samplePos) + 0.5f;
     vec3 volPos = samplePos * invDimensions;
-    return texture(volumeData, volPos).r;
+    return float(texture(volumeData, volPos).r);
 }
 
 // Sliding window: update arrays (shift left, insert new at end)
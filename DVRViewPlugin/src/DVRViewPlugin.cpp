@@ -3,13 +3,21 @@
 
 #include "GlobalSettingsAction.h"
 
+#include <ResampledVolume.h>
+
 #include <graphics/Vector2f.h>
 
 #include <DatasetsMimeData.h>
 
 #include <QLabel>
 #include <QDebug>
+#include <QFutureWatcher>
+#include <QtConcurrent>
 
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <functional>
 #include <random>
 #include <numeric>
 #include <hnswlib.h>
@@ -28,7 +36,8 @@ DVRViewPlugin::DVRViewPlugin(const PluginFactory* factory) :
     _currentDimensions({0, 1}),
     _dropWidget(nullptr),
     _DVRWidget(new DVRWidget()),
-    _settingsAction(this, "Settings Action")
+    _settingsAction(this, "Settings Action"),
+    _isResampling(false)
 {
     setObjectName("DVR OpenGL view");
 
@@ -240,6 +249,11 @@ void DVRViewPlugin::updateRenderSettings()
     _DVRWidget->setUseClutterRemover(_settingsAction.getUseClutterRemoverAction().isChecked());
     _DVRWidget->setUseShading(_settingsAction.getUseShaderAction().isChecked());
     _DVRWidget->setRenderCubeSize(_settingsAction.getRenderCubeSizeAction().getValue());
+    _DVRWidget->setResolutionLevel(_settingsAction.getResolutionLevelAction().getCurrentIndex() - 1); // "Auto" is passed as -1
+    _DVRWidget->setInteractionResolutionLevels(_settingsAction.getInteractionResolutionLevelsAction().getValue());
+    _DVRWidget->setTexturePrecision(_settingsAction.getTexturePrecisionAction().getCurrentText());
+    _DVRWidget->setColorPrecision(_settingsAction.getColorPrecisionAction().getCurrentText());
+    _DVRWidget->setTextureCacheBudget(_settingsAction.getTextureCacheBudgetAction().getValue());
 
     _DVRWidget->update();
 }
@@ -248,7 +262,23 @@ void DVRViewPlugin::updateVolumeData()
 {
     if (_volumeDataset.isValid()) {
         std::vector<std::uint32_t> dimensionIndices = generateSequence(_volumeDataset->getComponentsPerVoxel()); // TODO remove the max 8 componest part later just there for now to avoid memory crashes
-        _DVRWidget->setData(_volumeDataset, dimensionIndices);
+
+        if (_DVRWidget->setData(_volumeDataset, dimensionIndices))
+            return;
+
+        if (!_settingsAction.getFitToGPUAction().isChecked()) {
+            qWarning() << "DVRViewPlugin::updateVolumeData: The volume does not fit on the GPU in this render mode, resample it or enable fitting it to the GPU";
+            return;
+        }
+
+        // Show the volume at the best resolution the GPU holds instead
+        const auto volumeSize = _volumeDataset->getVolumeSize();
+        const auto region = VolumeResampling::getFullRegion(volumeSize.width(), volumeSize.height(), volumeSize.depth());
+
+        std::int32_t targetSize[3];
+        _DVRWidget->computeFittingVolumeSize(region, _volumeDataset->getComponentsPerVoxel(), targetSize);
+
+        showResampledVolume(region, targetSize);
     }
     else {
         qDebug() << "DVRViewPlugin::updateVolumeData: No data to update";
@@ -296,6 +326,136 @@ void DVRViewPlugin::updateMaterialPositionsData()
 }
 
 
+void DVRViewPlugin::compareColorPrecision()
+{
+    if (!_volumeDataset.isValid()) {
+        qDebug() << "DVRViewPlugin::compareColorPrecision: No data to compare";
+        return;
+    }
+
+    _DVRWidget->compareColorPrecision();
+}
+
+void DVRViewPlugin::resampleVolume()
+{
+    if (!_volumeDataset.isValid()) {
+        qDebug() << "DVRViewPlugin::resampleVolume: No data to resample";
+        return;
+    }
+
+    const auto region = getResampleRegion();
+    const auto scale = _settingsAction.getResampleScaleAction().getValue();
+
+    // The requested resolution is reduced further when it does not fit on the GPU
+    std::int32_t fittingSize[3], targetSize[3];
+    _DVRWidget->computeFittingVolumeSize(region, _volumeDataset->getComponentsPerVoxel(), fittingSize);
+
+    for (int axis = 0; axis < 3; axis++)
+        targetSize[axis] = std::clamp(static_cast<std::int32_t>(std::lround(region.getSize(axis) * scale)), 1, fittingSize[axis]);
+
+    showResampledVolume(region, targetSize);
+}
+
+VolumeResampling::Region DVRViewPlugin::getResampleRegion()
+{
+    const auto volumeSize = _volumeDataset->getVolumeSize();
+    auto region = VolumeResampling::getFullRegion(volumeSize.width(), volumeSize.height(), volumeSize.depth());
+
+    if (!_settingsAction.getCropToClippingPlanesAction().isChecked())
+        return region;
+
+    // The clipping planes are set as a fraction of the volume size per axis
+    DecimalRangeAction* clippingPlaneActions[3] = { &_settingsAction.getXDimClippingPlaneAction(), &_settingsAction.getYDimClippingPlaneAction(), &_settingsAction.getZDimClippingPlaneAction() };
+
+    for (int axis = 0; axis < 3; axis++)
+    {
+        const auto size     = region.end[axis];
+        const auto range    = clippingPlaneActions[axis]->getRange();
+
+        region.begin[axis]  = std::clamp(static_cast<std::int32_t>(std::floor(range.getMinimum() * size)), 0, size - 1);
+        region.end[axis]    = std::clamp(static_cast<std::int32_t>(std::ceil(range.getMaximum() * size)), region.begin[axis] + 1, size);
+    }
+
+    return region;
+}
+
+void DVRViewPlugin::showResampledVolume(const VolumeResampling::Region& region, const std::int32_t targetSize[3])
+{
+    // The settings of a second resample would be mixed up with the copy that is still being computed
+    if (_isResampling) {
+        qWarning() << "DVRViewPlugin::showResampledVolume: The volume is already being resampled";
+        return;
+    }
+
+    const auto filter = static_cast<VolumeResampling::Filter>(_settingsAction.getResampleFilterAction().getCurrentIndex());
+    const auto source = _volumeDataset;
+    const std::array<std::int32_t, 3> size = { targetSize[0], targetSize[1], targetSize[2] };
+
+    auto& task = source->getTask();
+
+    task.setName("Resampling " + source->getGuiName());
+    task.setMayKill(true);
+    task.setRunning();
+
+    // Update the dataset task from the worker thread, the task forwards the progress to the GUI and the abort request of the user back
+    const std::function<bool(float)> progressCallback = [&task](float progress) -> bool {
+        task.setProgress(progress);
+        task.setProgressDescription(QString("Resampling (%1%)").arg(static_cast<int>(progress * 100.0f)));
+        return !task.isAborting();
+    };
+
+    _isResampling = true;
+
+    // The resampling runs on a worker thread such that the GUI stays responsive, the datasets are created on the GUI thread
+    auto* resampleWatcher = new QFutureWatcher<VolumeResampling::ResampledValues>(this);
+
+    connect(resampleWatcher, &QFutureWatcher<VolumeResampling::ResampledValues>::finished, this, [this, resampleWatcher, source]() mutable -> void {
+        auto resampled = resampleWatcher->result();
+
+        resampleWatcher->deleteLater();
+
+        _isResampling = false;
+
+        auto& task = source->getTask();
+
+        if (!resampled.isValid()) {
+            task.setAborted();
+
+            if (resampled.error.isEmpty())
+                qDebug() << "DVRViewPlugin::showResampledVolume: Resampling was cancelled";
+            else
+                qCritical() << "DVRViewPlugin::showResampledVolume: Unable to resample the volume:" << resampled.error;
+
+            return;
+        }
+
+        task.setFinished();
+
+        mv::Dataset<Volumes> resampledVolume;
+
+        try {
+            resampledVolume = VolumeResampling::createResampledVolume(resampled);
+        }
+        catch (const std::exception& e) {
+            qCritical() << "DVRViewPlugin::showResampledVolume: Unable to resample the volume:" << e.what();
+            return;
+        }
+
+        // The clipping planes of a cropped volume would otherwise crop it a second time
+        if (_settingsAction.getCropToClippingPlanesAction().isChecked()) {
+            _settingsAction.getXDimClippingPlaneAction().setRange(NumericalRange(0.0f, 1.0f));
+            _settingsAction.getYDimClippingPlaneAction().setRange(NumericalRange(0.0f, 1.0f));
+            _settingsAction.getZDimClippingPlaneAction().setRange(NumericalRange(0.0f, 1.0f));
+        }
+
+        loadData({ resampledVolume });
+    });
+
+    resampleWatcher->setFuture(QtConcurrent::run([source, region, size, filter, progressCallback]() -> VolumeResampling::ResampledValues {
+        return VolumeResampling::resampleValues(source, region, size.data(), filter, progressCallback);
+    }));
+}
+
 void DVRViewPlugin::loadData(const mv::Dataset<Points>& dataset)
 {
     _volumeDataset = dataset;
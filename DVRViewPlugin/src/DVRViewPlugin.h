@@ -11,6 +11,8 @@
 
 #include "SettingsAction.h"
 
+#include <VolumeResampling.h>
+
 #include <QWidget>
 #include <VolumeData/Volumes.h>
 #include <ImageData/Images.h>
@@ -66,6 +68,12 @@ public:
     void updateMaterialTransitionData();
     void updateMaterialPositionsData();
 
+    /** Creates a resampled copy of the volume with the resample settings and shows it */
+    void resampleVolume();
+
+    /** Logs the error of storing the baked transfer function colors in the lower precisions */
+    void compareColorPrecision();
+
 private:
     /** We create and publish some data in order to provide an self-contained DVR project */
     std::vector<std::uint32_t> generateSequence(int n);
@@ -76,6 +84,12 @@ private:
     QString getMaterialTransitionDataSetID() const;
     QString getMaterialPositionsDataSetID() const;
 
+    /** Get the region of the volume that is resampled, the whole volume or the part between the clipping planes */
+    VolumeResampling::Region getResampleRegion();
+
+    /** Creates a resampled copy of a region of the volume on a worker thread and shows it instead of the volume once it is done */
+    void showResampledVolume(const VolumeResampling::Region& region, const std::int32_t targetSize[3]);
+
 protected:
     DropWidget*                 _dropWidget;                /** Widget for drag and drop behavior */
     DVRWidget*                  _DVRWidget;                 /** The OpenGL widget */
@@ -88,6 +102,7 @@ protected:
     std::vector<unsigned int>   _currentDimensions;         /** Stores which dimensions of the current data are shown */
     std::vector<float>          _spatialData;               /** Spatial data */
     std::vector<float>          _valueData;                 /** Value data */
+    bool                        _isResampling;              /** Whether a resampled copy of the volume is being computed */
 };
 
 /**
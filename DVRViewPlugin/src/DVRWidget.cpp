@@ -74,8 +74,12 @@ DVRWidget::~DVRWidget()
     cleanup();
 }
 
-void DVRWidget::setData(const Dataset<Volumes>& dataset, std::vector<std::uint32_t>& dimensionIndices)
+bool DVRWidget::setData(const Dataset<Volumes>& dataset, std::vector<std::uint32_t>& dimensionIndices)
 {
+    // The current volume is kept when the new one does not fit on the GPU
+    if (!_volumeRenderer.fitsOnGPU(dataset, static_cast<int>(dimensionIndices.size())))
+        return false;
+
     _volumeDataset = dataset;
 
     //reset camera to fit new dataset
@@ -88,6 +92,13 @@ void DVRWidget::setData(const Dataset<Volumes>& dataset, std::vector<std::uint32
 
     // Calls paintGL()
     update();
+
+    return true;
+}
+
+void DVRWidget::computeFittingVolumeSize(const VolumeResampling::Region& region, int numComponents, std::int32_t targetSize[3]) const
+{
+    _volumeRenderer.computeFittingVolumeSize(region, numComponents, targetSize);
 }
 
 void DVRWidget::setTfTexture(const Dataset<Images>& tfTexture)
@@ -162,6 +173,36 @@ void DVRWidget::setRenderCubeSize(float renderCubeSize)
     _volumeRenderer.setRenderCubeSize(renderCubeSize);
 }
 
+void DVRWidget::setResolutionLevel(int resolutionLevel)
+{
+    _volumeRenderer.setResolutionLevel(resolutionLevel);
+}
+
+void DVRWidget::setInteractionResolutionLevels(int interactionResolutionLevels)
+{
+    _volumeRenderer.setInteractionResolutionLevels(interactionResolutionLevels);
+}
+
+void DVRWidget::setTexturePrecision(const QString& texturePrecision)
+{
+    _volumeRenderer.setTexturePrecision(texturePrecision);
+}
+
+void DVRWidget::setColorPrecision(const QString& colorPrecision)
+{
+    _volumeRenderer.setColorPrecision(colorPrecision);
+}
+
+void DVRWidget::setTextureCacheBudget(int textureCacheBudget)
+{
+    _volumeRenderer.setTextureCacheBudget(textureCacheBudget);
+}
+
+void DVRWidget::compareColorPrecision()
+{
+    _volumeRenderer.compareColorPrecision();
+}
+
 void DVRWidget::initializeGL()
 {
     qDebug() << "Initializing DVRWidget";
@@ -249,6 +290,7 @@ bool DVRWidget::event(QEvent* event)
                 _mousePressed = true;
                 _camera.mousePress(mouseEvent->position());
                 _isNavigating = true;
+                _volumeRenderer.setInteracting(true); // Render at a coarser resolution while navigating
             }
 
             break;
@@ -260,6 +302,7 @@ bool DVRWidget::event(QEvent* event)
             {
                 _isNavigating = false;
                 _mousePressed = false;
+                _volumeRenderer.setInteracting(false);
                 update();
             }
 
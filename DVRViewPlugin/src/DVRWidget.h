@@ -33,8 +33,8 @@ public:
     /** Returns true when the widget was initialized and is ready to be used. */
     bool isInitialized() const { return _isInitialized;};
 
-    /** methods that pass the data to the renderer */
-    void setData(const Dataset<Volumes>& dataset, std::vector<std::uint32_t>& dimensionIndices);
+    /** methods that pass the data to the renderer, setData returns false when the volume does not fit on the GPU */
+    bool setData(const Dataset<Volumes>& dataset, std::vector<std::uint32_t>& dimensionIndices);
     void setTfTexture(const Dataset<Images>& tfTexture);
     void setReducedPosData(const Dataset<Points>& reducedPosData); 
     void setMaterialTransitionTexture(const Dataset<Images>& materialTransitionTexture);
@@ -49,6 +49,17 @@ public:
     void setUseClutterRemover(bool useClutterRemover);
     void setUseShading(bool useShading);
     void setRenderCubeSize(float renderCubeSize);
+    void setResolutionLevel(int resolutionLevel);
+    void setInteractionResolutionLevels(int interactionResolutionLevels);
+    void setTexturePrecision(const QString& texturePrecision);
+    void setColorPrecision(const QString& colorPrecision);
+    void setTextureCacheBudget(int textureCacheBudget);
+
+    /** Get the largest size of a volume region that fits on the GPU */
+    void computeFittingVolumeSize(const VolumeResampling::Region& region, int numComponents, std::int32_t targetSize[3]) const;
+
+    /** Log the error of the lower color precisions compared to Float32 */
+    void compareColorPrecision();
 
 
 protected:
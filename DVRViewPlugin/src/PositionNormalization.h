@@ -0,0 +1,100 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <limits>
+
+#include <OpenMPSupport.h>
+
+// =============================================================================
+// Position normalization
+// =============================================================================
+
+/**
+ * Normalizes interleaved 2D dimensionality reduction positions onto [0, 1] on both axes, such that the render modes can scale them to the size of their lookup texture.
+ * The loops run over whole positions instead of single values, so they need no branch per axis and can be vectorized.
+ */
+namespace PositionNormalization
+{
+    /** Range of the positions on both axes */
+    struct Bounds
+    {
+        std::array<float, 2> minimum = { std::numeric_limits<float>::max(), std::numeric_limits<float>::max() };
+        std::array<float, 2> maximum = { std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest() };
+    };
+
+    /**
+     * Compute the range of the positions in parallel.
+     * Each thread keeps its own range that is merged at the end.
+     * @param positions Interleaved x and y values
+     * @param numPositions Number of positions (half the number of values)
+     * @return Range of the positions
+     */
+    inline Bounds computeBounds(const float* positions, std::int64_t numPositions)
+    {
+        Bounds bounds;
+
+        #pragma omp parallel
+        {
+            float minX = bounds.minimum[0], minY = bounds.minimum[1];
+            float maxX = bounds.maximum[0], maxY = bounds.maximum[1];
+
+            #pragma omp for schedule(static)
+            for (std::int64_t i = 0; i < numPositions; i++)
+            {
+                const float x = positions[2 * i];
+                const float y = positions[2 * i + 1];
+
+                minX = std::min(minX, x);
+                maxX = std::max(maxX, x);
+                minY = std::min(minY, y);
+                maxY = std::max(maxY, y);
+            }
+
+            #pragma omp critical
+            {
+                bounds.minimum[0] = std::min(bounds.minimum[0], minX);
+                bounds.minimum[1] = std::min(bounds.minimum[1], minY);
+                bounds.maximum[0] = std::max(bounds.maximum[0], maxX);
+                bounds.maximum[1] = std::max(bounds.maximum[1], maxY);
+            }
+        }
+
+        return bounds;
+    }
+
+    /**
+     * Map the positions onto [0, 1] in parallel, normalized may be the same array as positions
+     * @param positions Interleaved x and y values
+     * @param numPositions Number of positions (half the number of values)
+     * @param bounds Range of the positions
+     * @param normalized Output positions
+     */
+    inline void normalize(const float* positions, std::int64_t numPositions, const Bounds& bounds, float* normalized)
+    {
+        const float minX = bounds.minimum[0], rangeX = bounds.maximum[0] - bounds.minimum[0];
+        const float minY = bounds.minimum[1], rangeY = bounds.maximum[1] - bounds.minimum[1];
+
+        #pragma omp parallel for schedule(static)
+        for (std::int64_t i = 0; i < numPositions; i++)
+        {
+            normalized[2 * i] = (positions[2 * i] - minX) / rangeX;
+            normalized[2 * i + 1] = (positions[2 * i + 1] - minY) / rangeY;
+        }
+    }
+
+    /**
+     * Scale normalized positions onto [0, scale] in parallel, for a lookup texture of size n the scale is n - 1
+     * @param normalized Interleaved normalized x and y values
+     * @param numValues Number of values (twice the number of positions)
+     * @param scale Scale of both axes
+     * @param scaled Output positions
+     */
+    inline void scale(const float* normalized, std::int64_t numValues, float scale, float* scaled)
+    {
+        #pragma omp parallel for schedule(static)
+        for (std::int64_t i = 0; i < numValues; i++)
+            scaled[i] = normalized[i] * scale;
+    }
+}
@@ -23,6 +23,17 @@ SettingsAction::SettingsAction(QObject* parent, const QString& title) :
     _yRenderSizeAction(this, "Y Render Size", 0, 500, 50),
     _zRenderSizeAction(this, "Z Render Size", 0, 500, 50),
     _mipDimensionPickerAction(this, "MIP Dimension"),
+    _resolutionLevelAction(this, "Resolution", QStringList{ "Auto", "Full", "Half", "Quarter", "Eighth" }, "Auto"),
+    _interactionResolutionLevelsAction(this, "Interaction Coarsening", 0, 3, 1),
+    _texturePrecisionAction(this, "Texture Precision", QStringList{ "Float32", "Float16", "UNorm16", "UNorm8" }, "Float32"),
+    _colorPrecisionAction(this, "Color Precision", QStringList{ "Float32", "Float16", "UNorm16", "UNorm8" }, "Float32"),
+    _compareColorPrecisionAction(this, "Compare Color Precision"),
+    _textureCacheBudgetAction(this, "Texture Cache Budget", 0, 16384, 2048),
+    _fitToGPUAction(this, "Fit Volume To GPU", false),
+    _resampleFilterAction(this, "Resample Filter", QStringList{ "Box", "Trilinear", "Max" }, "Box"),
+    _resampleScaleAction(this, "Resample Scale", 0.05f, 1.0f, 1.0f),
+    _cropToClippingPlanesAction(this, "Crop To Clipping Planes"),
+    _resampleAction(this, "Resample Volume"),
     _renderModeAction(this, "Render Mode", QStringList{ "MaterialTransition Full", "MaterialTransition 2D", "NN MaterialTransition", "Alt NN MaterialTransition", "Smooth NN MaterialTransition", "MultiDimensional Composite Full", "MultiDimensional Composite 2D Pos", "MultiDimensional Composite Color", "NN MultiDimensional Composite", "1D MIP" }, "MultiDimensional Composite Color")
 {
     setText("Settings");
@@ -38,6 +49,19 @@ SettingsAction::SettingsAction(QObject* parent, const QString& title) :
 
     addAction(&_stepSizeAction);
 
+    addAction(&_resolutionLevelAction);
+    addAction(&_interactionResolutionLevelsAction);
+    addAction(&_texturePrecisionAction);
+    addAction(&_colorPrecisionAction);
+    addAction(&_compareColorPrecisionAction);
+    addAction(&_textureCacheBudgetAction);
+
+    addAction(&_fitToGPUAction);
+    addAction(&_resampleFilterAction);
+    addAction(&_resampleScaleAction);
+    addAction(&_cropToClippingPlanesAction);
+    addAction(&_resampleAction);
+
     addAction(&_xDimClippingPlaneAction);
     addAction(&_yDimClippingPlaneAction);
     addAction(&_zDimClippingPlaneAction);
@@ -55,6 +79,19 @@ SettingsAction::SettingsAction(QObject* parent, const QString& title) :
 
     _stepSizeAction.setToolTip("Step size");
 
+    _resolutionLevelAction.setToolTip("Resolution of the volume that is rendered, auto selects the level at which a voxel covers about one pixel");
+    _interactionResolutionLevelsAction.setToolTip("Number of coarser resolution levels used while navigating");
+    _texturePrecisionAction.setToolTip("Precision of the volume texture, the normalized formats are quantized to the value range of each channel");
+    _colorPrecisionAction.setToolTip("Precision of the transfer function colors the Color and NN composite modes store per voxel, UNorm8 takes a quarter of the memory of Float32");
+    _compareColorPrecisionAction.setToolTip("Log the maximum and mean error of each color precision compared to Float32");
+    _textureCacheBudgetAction.setToolTip("GPU memory in MB the volume textures of recently used render modes may take, switching back to such a mode does not upload the volume again");
+
+    _fitToGPUAction.setToolTip("Show a resampled copy of volumes whose texture for the current render mode exceeds the GPU memory or the maximum texture size, at the best resolution that fits. The copy is computed in the background");
+    _resampleFilterAction.setToolTip("Filter used to resample the volume, max keeps thin bright structures visible");
+    _resampleScaleAction.setToolTip("Resolution of the resampled volume relative to the (cropped) volume, it is reduced further when it does not fit on the GPU");
+    _cropToClippingPlanesAction.setToolTip("Only resample the part of the volume between the clipping planes");
+    _resampleAction.setToolTip("Create a resampled copy of the volume as a new dataset and show it");
+
     _renderCubeSizeAction.setToolTip("Render cube size");
     _useShadingAction.setToolTip("Toggle shading");
     _useClutterRemover.setToolTip("Toggle clutter remover");
@@ -87,6 +124,12 @@ SettingsAction::SettingsAction(QObject* parent, const QString& title) :
 
     connect(&_stepSizeAction, &DecimalAction::valueChanged, _DVRViewPlugin, &DVRViewPlugin::updateRenderSettings);
 
+    connect(&_resolutionLevelAction, &OptionAction::currentIndexChanged, _DVRViewPlugin, &DVRViewPlugin::updateRenderSettings);
+    connect(&_interactionResolutionLevelsAction, &IntegralAction::valueChanged, _DVRViewPlugin, &DVRViewPlugin::updateRenderSettings);
+    connect(&_texturePrecisionAction, &OptionAction::currentIndexChanged, _DVRViewPlugin, &DVRViewPlugin::updateRenderSettings);
+    connect(&_colorPrecisionAction, &OptionAction::currentIndexChanged, _DVRViewPlugin, &DVRViewPlugin::updateRenderSettings);
+    connect(&_textureCacheBudgetAction, &IntegralAction::valueChanged, _DVRViewPlugin, &DVRViewPlugin::updateRenderSettings);
+
     connect(&_useShadingAction, &ToggleAction::toggled, _DVRViewPlugin, &DVRViewPlugin::updateRenderSettings);
     connect(&_useClutterRemover, &ToggleAction::toggled, _DVRViewPlugin, &DVRViewPlugin::updateRenderSettings);
     connect(&_useCustomRenderSpaceAction, &ToggleAction::toggled, _DVRViewPlugin, &DVRViewPlugin::updateRenderSettings);
@@ -96,6 +139,9 @@ SettingsAction::SettingsAction(QObject* parent, const QString& title) :
     connect(&_zRenderSizeAction, &IntegralAction::valueChanged, _DVRViewPlugin, &DVRViewPlugin::updateRenderSettings);
     connect(&_renderCubeSizeAction, &IntegralAction::valueChanged, _DVRViewPlugin, &DVRViewPlugin::updateRenderSettings);
 
+    connect(&_resampleAction, &TriggerAction::triggered, _DVRViewPlugin, &DVRViewPlugin::resampleVolume);
+    connect(&_compareColorPrecisionAction, &TriggerAction::triggered, _DVRViewPlugin, &DVRViewPlugin::compareColorPrecision);
+
     connect(&_mipDimensionPickerAction, &DimensionPickerAction::currentDimensionIndexChanged, _DVRViewPlugin, &DVRViewPlugin::updateRenderSettings);
     connect(&_renderModeAction, &OptionAction::currentIndexChanged, _DVRViewPlugin, &DVRViewPlugin::updateRenderSettings);
 }
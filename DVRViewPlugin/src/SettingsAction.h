@@ -5,6 +5,7 @@
 #include <actions/DecimalRangeAction.h>
 #include <actions/IntegralAction.h>
 #include <actions/ToggleAction.h>
+#include <actions/TriggerAction.h>
 #include <PointData/DimensionPickerAction.h>
 
 using namespace mv::gui;
@@ -49,6 +50,19 @@ public: // Action getters
     DimensionPickerAction& getMIPDimensionPickerAction() { return _mipDimensionPickerAction; }
     OptionAction& getRenderModeAction() { return _renderModeAction; }
 
+    OptionAction& getResolutionLevelAction() { return _resolutionLevelAction; }
+    IntegralAction& getInteractionResolutionLevelsAction() { return _interactionResolutionLevelsAction; }
+    OptionAction& getTexturePrecisionAction() { return _texturePrecisionAction; }
+    OptionAction& getColorPrecisionAction() { return _colorPrecisionAction; }
+    TriggerAction& getCompareColorPrecisionAction() { return _compareColorPrecisionAction; }
+    IntegralAction& getTextureCacheBudgetAction() { return _textureCacheBudgetAction; }
+
+    ToggleAction& getFitToGPUAction() { return _fitToGPUAction; }
+    OptionAction& getResampleFilterAction() { return _resampleFilterAction; }
+    DecimalAction& getResampleScaleAction() { return _resampleScaleAction; }
+    ToggleAction& getCropToClippingPlanesAction() { return _cropToClippingPlanesAction; }
+    TriggerAction& getResampleAction() { return _resampleAction; }
+
 
 private:
     DVRViewPlugin*          _DVRViewPlugin;                     /** Pointer to Example OpenGL Viewer Plugin */
@@ -70,5 +84,16 @@ private:
     ToggleAction            _useCustomRenderSpaceAction;        /** Toggle action for custom render space */
 
     DimensionPickerAction   _mipDimensionPickerAction;          /** Dimension picker action */
+    OptionAction            _resolutionLevelAction;             /** Resolution level action, contains: "Auto", "Full", "Half", "Quarter", "Eighth", where "Auto" selects the level from the screen-space voxel footprint */
+    IntegralAction          _interactionResolutionLevelsAction; /** Number of coarser resolution levels used while navigating action */
+    OptionAction            _texturePrecisionAction;            /** Texture precision action, contains: "Float32", "Float16", "UNorm16", "UNorm8" */
+    OptionAction            _colorPrecisionAction;              /** Precision of the baked transfer function colors action, contains: "Float32", "Float16", "UNorm16", "UNorm8" */
+    TriggerAction           _compareColorPrecisionAction;       /** Logs the error of the color precisions compared to Float32 action */
+    IntegralAction          _textureCacheBudgetAction;          /** VRAM in megabytes the volume textures of recently used render modes may take action */
+    ToggleAction            _fitToGPUAction;                    /** Toggle action for showing a resampled copy of volumes that do not fit on the GPU */
+    OptionAction            _resampleFilterAction;              /** Resample filter action, contains: "Box", "Trilinear", "Max" */
+    DecimalAction           _resampleScaleAction;               /** Resolution of the resampled volume relative to the (cropped) volume action */
+    ToggleAction            _cropToClippingPlanesAction;        /** Toggle action for cropping the resampled volume to the clipping planes */
+    TriggerAction           _resampleAction;                    /** Creates and shows a resampled copy of the volume action */
     OptionAction            _renderModeAction;                  /** Render mode action, contains: "MaterialTransition Full", "MaterialTransition 2D", "NN MaterialTransition", "Alt NN MaterialTransition", "Smooth NN MaterialTransition", "MultiDimensional Composite Full", "MultiDimensional Composite 2D Pos", "MultiDimensional Composite Color", "NN MultiDimensional Composite", "1D MIP" */
 };
@@ -0,0 +1,172 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include <OpenMPSupport.h>
+
+// =============================================================================
+// Volume pyramid
+// =============================================================================
+
+/**
+ * Builds the coarser resolution levels of an interleaved float volume, such that they can be uploaded as mip levels of a 3D texture.
+ * Every level halves each axis (following the OpenGL mip level sizes), an odd last voxel is folded into the last cell of the coarser level.
+ */
+namespace VolumePyramid
+{
+    /** Filter that combines the (up to) 2x2x2 voxels of a finer level into one voxel of the coarser level, per component */
+    enum class Filter
+    {
+        Box,        /** Mean of the voxels, for continuous data */
+        Max,        /** Maximum of the voxels, keeps thin bright structures visible in maximum intensity projections */
+        Nearest     /** First voxel of the cell, for data that may not be interpolated such as material ids and embedding positions */
+    };
+
+    /** A single resolution level */
+    struct Level
+    {
+        int                 width = 1;
+        int                 height = 1;
+        int                 depth = 1;
+        std::vector<float>  data;       /** Interleaved voxel values */
+    };
+
+    /** Get the size of an axis of \p size voxels at \p level, equal to the OpenGL mip level size */
+    inline int getLevelSize(int size, int level)
+    {
+        return std::max(1, size >> level);
+    }
+
+    /** Get the number of levels (including the full resolution level) that can be built for a volume, limited to \p maxLevels */
+    inline int getNumberOfLevels(int width, int height, int depth, int maxLevels)
+    {
+        int numLevels = 1;
+
+        while (numLevels < maxLevels && (getLevelSize(width, numLevels - 1) > 1 || getLevelSize(height, numLevels - 1) > 1 || getLevelSize(depth, numLevels - 1) > 1))
+            numLevels++;
+
+        return numLevels;
+    }
+
+    /** Get the range [begin, end) of the finer axis covered by voxel \p index of the coarser axis */
+    inline void getSourceRange(int index, int coarseSize, int fineSize, int& begin, int& end)
+    {
+        if (coarseSize == fineSize) {
+            begin   = index;
+            end     = index + 1;
+            return;
+        }
+
+        begin   = 2 * index;
+        end     = (index == coarseSize - 1) ? fineSize : 2 * index + 2;
+    }
+
+    /**
+     * Downsample a volume by a factor of two on every axis, the slices of the coarser level are computed in parallel
+     * @param fine Interleaved voxel values of the finer level
+     * @param width Number of voxels on the x-axis of the finer level
+     * @param height Number of voxels on the y-axis of the finer level
+     * @param depth Number of voxels on the z-axis of the finer level
+     * @param numComponents Number of interleaved values per voxel
+     * @param filter Filter used to combine the voxels
+     * @return Coarser level
+     */
+    inline Level downsample(const float* fine, int width, int height, int depth, int numComponents, Filter filter)
+    {
+        Level coarse;
+
+        coarse.width    = getLevelSize(width, 1);
+        coarse.height   = getLevelSize(height, 1);
+        coarse.depth    = getLevelSize(depth, 1);
+        coarse.data.resize(static_cast<std::size_t>(coarse.width) * coarse.height * coarse.depth * numComponents);
+
+        const std::int64_t numRows = static_cast<std::int64_t>(coarse.height) * coarse.depth;
+
+        #pragma omp parallel for schedule(static)
+        for (std::int64_t row = 0; row < numRows; row++)
+        {
+            const int y = static_cast<int>(row % coarse.height);
+            const int z = static_cast<int>(row / coarse.height);
+
+            int yBegin, yEnd, zBegin, zEnd;
+            getSourceRange(y, coarse.height, height, yBegin, yEnd);
+            getSourceRange(z, coarse.depth, depth, zBegin, zEnd);
+
+            for (int x = 0; x < coarse.width; x++)
+            {
+                int xBegin, xEnd;
+                getSourceRange(x, coarse.width, width, xBegin, xEnd);
+
+                float* target = coarse.data.data() + ((row * coarse.width) + x) * numComponents;
+
+                if (filter == Filter::Nearest) {
+                    const float* source = fine + ((static_cast<std::int64_t>(zBegin) * height + yBegin) * width + xBegin) * numComponents;
+                    std::copy(source, source + numComponents, target);
+                    continue;
+                }
+
+                std::fill(target, target + numComponents, filter == Filter::Max ? std::numeric_limits<float>::lowest() : 0.0f);
+
+                for (int fz = zBegin; fz < zEnd; fz++)
+                {
+                    for (int fy = yBegin; fy < yEnd; fy++)
+                    {
+                        const float* source = fine + ((static_cast<std::int64_t>(fz) * height + fy) * width + xBegin) * numComponents;
+
+                        for (int fx = xBegin; fx < xEnd; fx++, source += numComponents)
+                        {
+                            for (int c = 0; c < numComponents; c++)
+                            {
+                                if (filter == Filter::Max)
+                                    target[c] = std::max(target[c], source[c]);
+                                else
+                                    target[c] += source[c];
+                            }
+                        }
+                    }
+                }
+
+                if (filter == Filter::Box) {
+                    const float invCount = 1.0f / static_cast<float>((xEnd - xBegin) * (yEnd - yBegin) * (zEnd - zBegin));
+
+                    for (int c = 0; c < numComponents; c++)
+                        target[c] *= invCount;
+                }
+            }
+        }
+
+        return coarse;
+    }
+
+    /**
+     * Build the coarser levels of a volume
+     * @param data Interleaved voxel values of the full resolution volume
+     * @param width Number of voxels on the x-axis
+     * @param height Number of voxels on the y-axis
+     * @param depth Number of voxels on the z-axis
+     * @param numComponents Number of interleaved values per voxel
+     * @param filter Filter used to combine the voxels
+     * @param maxLevels Maximum number of levels, including the full resolution level
+     * @return Levels 1 to n, the full resolution level itself is not copied
+     */
+    inline std::vector<Level> build(const std::vector<float>& data, int width, int height, int depth, int numComponents, Filter filter, int maxLevels)
+    {
+        std::vector<Level> levels;
+
+        const int numLevels = getNumberOfLevels(width, height, depth, maxLevels);
+
+        if (numLevels < 2 || data.size() < static_cast<std::size_t>(width) * height * depth * numComponents)
+            return levels;
+
+        levels.reserve(numLevels - 1);
+        levels.push_back(downsample(data.data(), width, height, depth, numComponents, filter));
+
+        for (int level = 2; level < numLevels; level++)
+            levels.push_back(downsample(levels.back().data.data(), levels.back().width, levels.back().height, levels.back().depth, numComponents, filter));
+
+        return levels;
+    }
+}
@@ -0,0 +1,239 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+#include <OpenMPSupport.h>
+
+// =============================================================================
+// Volume quantization
+// =============================================================================
+
+/**
+ * Quantizes interleaved float texture data into normalized unsigned integer texels, such that volumes take two to four times less VRAM.
+ * The shaders recover the values with a per-channel scale and offset: value = texel * scale + offset, where texel is the normalized [0, 1] value.
+ */
+namespace VolumeQuantization
+{
+    /** Per-channel dequantization of up to four interleaved channels, the default maps texels onto themselves */
+    struct Dequantization
+    {
+        std::array<float, 4> scale  = { 1.0f, 1.0f, 1.0f, 1.0f };
+        std::array<float, 4> offset = { 0.0f, 0.0f, 0.0f, 0.0f };
+    };
+
+    /**
+     * Per-component mapping of the stored values of quantized point data back onto the source values: value = stored * scale + offset.
+     * The loader writes it as the QuantizationScale and QuantizationOffset properties, it is empty for point data that holds the source values.
+     */
+    struct ComponentQuantization
+    {
+        std::vector<float> scale;
+        std::vector<float> offset;
+
+        bool isEmpty() const { return scale.empty(); }
+    };
+
+    /**
+     * Fold the quantization of a component into the dequantization of the channel that holds it, such that the shaders recover the source values
+     * @param dequantization Dequantization of the texels
+     * @param channel Channel that holds the component
+     * @param scale Quantization scale of the component
+     * @param offset Quantization offset of the component
+     */
+    inline void foldComponentQuantization(Dequantization& dequantization, int channel, float scale, float offset)
+    {
+        dequantization.offset[channel]  = dequantization.offset[channel] * scale + offset;
+        dequantization.scale[channel]   = dequantization.scale[channel] * scale;
+    }
+
+    /**
+     * Map the stored values of interleaved components back onto the source values in place
+     * @param data Interleaved values
+     * @param numValues Number of values in data
+     * @param scale Quantization scale of every interleaved component
+     * @param offset Quantization offset of every interleaved component
+     */
+    inline void dequantizeComponents(float* data, std::int64_t numValues, const std::vector<float>& scale, const std::vector<float>& offset)
+    {
+        const auto numComponents = static_cast<std::int64_t>(scale.size());
+        const std::int64_t numVoxels = numValues / numComponents;
+
+        #pragma omp parallel for schedule(static)
+        for (std::int64_t voxel = 0; voxel < numVoxels; voxel++)
+        {
+            for (std::int64_t c = 0; c < numComponents; c++)
+                data[voxel * numComponents + c] = data[voxel * numComponents + c] * scale[c] + offset[c];
+        }
+    }
+
+    /**
+     * Compute the dequantization that maps the normalized texel range onto the value range of every channel.
+     * The per-thread ranges are merged at the end of the parallel region.
+     * @param data Interleaved values
+     * @param numValues Number of values in data
+     * @param numChannels Number of interleaved channels (1 to 4)
+     * @return Dequantization of the channels
+     */
+    inline Dequantization computeDequantization(const float* data, std::int64_t numValues, int numChannels)
+    {
+        std::array<float, 4> minimum, maximum;
+        minimum.fill(std::numeric_limits<float>::max());
+        maximum.fill(std::numeric_limits<float>::lowest());
+
+        const std::int64_t numTexels = numValues / numChannels;
+
+        #pragma omp parallel
+        {
+            std::array<float, 4> threadMinimum = minimum;
+            std::array<float, 4> threadMaximum = maximum;
+
+            #pragma omp for schedule(static)
+            for (std::int64_t texel = 0; texel < numTexels; texel++)
+            {
+                for (int c = 0; c < numChannels; c++)
+                {
+                    const float value = data[texel * numChannels + c];
+                    threadMinimum[c] = std::min(threadMinimum[c], value);
+                    threadMaximum[c] = std::max(threadMaximum[c], value);
+                }
+            }
+
+            #pragma omp critical
+            for (int c = 0; c < numChannels; c++)
+            {
+                minimum[c] = std::min(minimum[c], threadMinimum[c]);
+                maximum[c] = std::max(maximum[c], threadMaximum[c]);
+            }
+        }
+
+        Dequantization dequantization;
+
+        for (int c = 0; c < numChannels; c++)
+        {
+            if (minimum[c] > maximum[c]) // No values
+                continue;
+
+            dequantization.scale[c]     = maximum[c] > minimum[c] ? maximum[c] - minimum[c] : 1.0f;
+            dequantization.offset[c]    = minimum[c];
+        }
+
+        return dequantization;
+    }
+
+    /**
+     * Quantize interleaved values into normalized unsigned integer texels in parallel, values are rounded to the nearest texel
+     * @param data Interleaved values
+     * @param numValues Number of values in data (and texels in quantized)
+     * @param numChannels Number of interleaved channels (1 to 4)
+     * @param dequantization Dequantization computed for the values
+     * @param quantized Output texels
+     */
+    template <typename T>
+    void quantize(const float* data, std::int64_t numValues, int numChannels, const Dequantization& dequantization, T* quantized)
+    {
+        static_assert(std::is_unsigned_v<T>, "Normalized texels are unsigned integers");
+
+        const float highest = static_cast<float>(std::numeric_limits<T>::max());
+
+        std::array<float, 4> factor;
+        for (int c = 0; c < 4; c++)
+            factor[c] = highest / dequantization.scale[c];
+
+        const std::int64_t numTexels = numValues / numChannels;
+
+        #pragma omp parallel for schedule(static)
+        for (std::int64_t texel = 0; texel < numTexels; texel++)
+        {
+            for (int c = 0; c < numChannels; c++)
+            {
+                const std::int64_t index = texel * numChannels + c;
+                const float value = std::clamp((data[index] - dequantization.offset[c]) * factor[c] + 0.5f, 0.0f, highest);
+                quantized[index] = static_cast<T>(value);
+            }
+        }
+    }
+
+    /**
+     * Recover the values of normalized unsigned integer texels in parallel, the inverse of quantize up to rounding
+     * @param quantized Interleaved texels
+     * @param numValues Number of texels in quantized (and values in data)
+     * @param numChannels Number of interleaved channels (1 to 4)
+     * @param dequantization Dequantization the texels were quantized with
+     * @param data Output values
+     */
+    template <typename T>
+    void dequantize(const T* quantized, std::int64_t numValues, int numChannels, const Dequantization& dequantization, float* data)
+    {
+        static_assert(std::is_unsigned_v<T>, "Normalized texels are unsigned integers");
+
+        const float highest = static_cast<float>(std::numeric_limits<T>::max());
+        const std::int64_t numTexels = numValues / numChannels;
+
+        #pragma omp parallel for schedule(static)
+        for (std::int64_t texel = 0; texel < numTexels; texel++)
+        {
+            for (int c = 0; c < numChannels; c++)
+            {
+                const std::int64_t index = texel * numChannels + c;
+                data[index] = (static_cast<float>(quantized[index]) / highest) * dequantization.scale[c] + dequantization.offset[c];
+            }
+        }
+    }
+
+    /** Per-channel absolute error of approximated values, accumulated over one or more blocks of values */
+    struct ErrorStatistics
+    {
+        std::array<float, 4> maximum    = { 0.0f, 0.0f, 0.0f, 0.0f };   /** Largest absolute error */
+        std::array<double, 4> sum       = { 0.0, 0.0, 0.0, 0.0 };       /** Sum of the absolute errors */
+        std::int64_t numTexels          = 0;                            /** Number of texels the errors were accumulated over */
+
+        double getMean(int channel) const { return numTexels > 0 ? sum[channel] / static_cast<double>(numTexels) : 0.0; }
+    };
+
+    /**
+     * Accumulate the absolute errors of approximated values in parallel.
+     * Each thread accumulates its own maximum and sum, which are added to the statistics at the end.
+     * @param reference Interleaved exact values
+     * @param approximation Interleaved approximated values
+     * @param numValues Number of values in reference and approximation
+     * @param numChannels Number of interleaved channels (1 to 4)
+     * @param statistics Statistics the errors are added to
+     */
+    inline void accumulateError(const float* reference, const float* approximation, std::int64_t numValues, int numChannels, ErrorStatistics& statistics)
+    {
+        const std::int64_t numTexels = numValues / numChannels;
+
+        #pragma omp parallel
+        {
+            std::array<float, 4> threadMaximum = { 0.0f, 0.0f, 0.0f, 0.0f };
+            std::array<double, 4> threadSum = { 0.0, 0.0, 0.0, 0.0 };
+
+            #pragma omp for schedule(static)
+            for (std::int64_t texel = 0; texel < numTexels; texel++)
+            {
+                for (int c = 0; c < numChannels; c++)
+                {
+                    const std::int64_t index = texel * numChannels + c;
+                    const float error = std::abs(approximation[index] - reference[index]);
+                    threadMaximum[c] = std::max(threadMaximum[c], error);
+                    threadSum[c] += error;
+                }
+            }
+
+            #pragma omp critical
+            for (int c = 0; c < numChannels; c++)
+            {
+                statistics.maximum[c] = std::max(statistics.maximum[c], threadMaximum[c]);
+                statistics.sum[c] += threadSum[c];
+            }
+        }
+
+        statistics.numTexels += numTexels;
+    }
+}
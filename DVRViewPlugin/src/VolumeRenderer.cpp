@@ -2,14 +2,54 @@
 #include <QImage>
 #include <random>
 #include <QOpenGLWidget>
+#include <QOpenGLContext>
 #include <queue>
 #include <algorithm>
 #include <numeric>
+#include <limits>
 #include <sstream> 
+#include <cstring>
 
-#ifdef _OPENMP
-#include <omp.h>
-#endif
+#include <OpenMPSupport.h>
+
+namespace {
+
+// Number of bytes per channel of a texel in the given precision
+size_t getTexelChannelSize(TexturePrecision precision)
+{
+    switch (precision)
+    {
+    case TexturePrecision::FLOAT16:
+    case TexturePrecision::UNORM16:
+        return 2;
+    case TexturePrecision::UNORM8:
+        return 1;
+    default:
+        return sizeof(float);
+    }
+}
+
+// Vendor queries of the video memory in KB, OpenGL itself has none (GL_NVX_gpu_memory_info and GL_ATI_meminfo)
+constexpr GLenum GPU_MEMORY_INFO_DEDICATED_VIDMEM_NVX = 0x9047;
+constexpr GLenum TEXTURE_FREE_MEMORY_ATI = 0x87FC;
+
+// Video memory that is kept free for the framebuffers, transfer function and lookup textures and the render cube buffers
+constexpr size_t reservedGPUMemorySize = static_cast<size_t>(256) * 1024 * 1024;
+
+// Names of the texture precisions as shown in the settings, in the order of TexturePrecision
+const char* const texturePrecisionNames[4] = { "Float32", "Float16", "UNorm16", "UNorm8" };
+
+TexturePrecision parseTexturePrecision(const QString& name)
+{
+    for (int precision = 0; precision < 4; precision++)
+        if (name == texturePrecisionNames[precision])
+            return static_cast<TexturePrecision>(precision);
+
+    qCritical() << "Unknown texture precision" << name;
+    return TexturePrecision::FLOAT32;
+}
+
+}
 
 void VolumeRenderer::init()
 {
@@ -19,8 +59,21 @@ void VolumeRenderer::init()
 
     glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
 
-    _volumeTexture.create();
-    _volumeTexture.initialize();
+    glGetIntegerv(GL_MAX_3D_TEXTURE_SIZE, &_maxTextureSize);
+
+    // Without either extension the default video memory size is kept
+    GLint memoryInfo[4] = { 0, 0, 0, 0 };
+    if (QOpenGLContext::currentContext()->hasExtension("GL_NVX_gpu_memory_info"))
+        glGetIntegerv(GPU_MEMORY_INFO_DEDICATED_VIDMEM_NVX, memoryInfo);
+    else if (QOpenGLContext::currentContext()->hasExtension("GL_ATI_meminfo"))
+        glGetIntegerv(TEXTURE_FREE_MEMORY_ATI, memoryInfo);
+
+    if (memoryInfo[0] > 0)
+        _gpuMemorySize = static_cast<size_t>(memoryInfo[0]) * 1024;
+
+    qDebug() << "VolumeRenderer: Using" << _gpuMemorySize / (1024 * 1024) << "MB of video memory";
+
+    activateVolumeTexture(getRenderModeGroup(_renderMode));
 
     // Initialize the transfer function textures
     _tfTexture.create();
@@ -45,7 +98,7 @@ void VolumeRenderer::init()
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
 
-    // Initialize buffers needed for the empty space skipping rendercubes (WIP no empty space skipping was implemented but this was left in as a way to have a camera work inside the volume)
+    // Initialize buffers needed for the empty space skipping rendercubes, they also let the camera work inside the volume
     glGenBuffers(1, &_renderCubePositionsBufferID);
     glBindBuffer(GL_TEXTURE_BUFFER, _renderCubePositionsBufferID);
     glBufferData(GL_TEXTURE_BUFFER, 1, NULL, GL_DYNAMIC_DRAW); // Size will be set later
@@ -119,6 +172,29 @@ void VolumeRenderer::init()
         qDebug() << "Volume Renderer shaders loaded";
     }
 
+    // The transfer function volume is built on the CPU when the compute shader is not available
+    _tfVolumeComputeShader = new QOpenGLShaderProgram();
+    if (!_tfVolumeComputeShader->addShaderFromSourceFile(QOpenGLShader::Compute, ":shaders/TransferFunctionVolume.comp") || !_tfVolumeComputeShader->link())
+    {
+        qWarning() << "Failed to load the transfer function volume compute shader, the transfer function is applied on the CPU:" << _tfVolumeComputeShader->log();
+        delete _tfVolumeComputeShader;
+        _tfVolumeComputeShader = nullptr;
+    }
+
+    _materialIdVolumeComputeShader = new QOpenGLShaderProgram();
+    if (!_materialIdVolumeComputeShader->addShaderFromSourceFile(QOpenGLShader::Compute, ":shaders/MaterialIdVolume.comp") || !_materialIdVolumeComputeShader->link())
+    {
+        qWarning() << "Failed to load the material id volume compute shader, the material ids are looked up on the CPU:" << _materialIdVolumeComputeShader->log();
+        delete _materialIdVolumeComputeShader;
+        _materialIdVolumeComputeShader = nullptr;
+    }
+
+    _positionVolumeTexture.create();
+    _positionVolumeTexture.bind();
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    _positionVolumeTexture.release();
+
     // Create the shader program instance.
     _fullDataSamplerComputeShader = new QOpenGLShaderProgram();
     if (!_fullDataSamplerComputeShader->addShaderFromSourceFile(QOpenGLShader::Compute, ":shaders/FullDataSampling.comp"))
@@ -249,21 +325,81 @@ void VolumeRenderer::setData(const mv::Dataset<Volumes>& dataset)
     _volumeDataset = dataset;
     _volumeSize = dataset->getVolumeSize().toVector3f();
     _ANNAlgorithmTrained = false; // We need to retrain the ANN algorithm as the data has changed
-    _fullDataMemorySize = _volumeSize.x * _volumeSize.y * _volumeSize.z * _volumeDataset->getComponentsPerVoxel() * sizeof(float); // in bytes
-    if (_fullGPUMemorySize - _fullDataMemorySize < 0)
+    _fullDataMemorySize = static_cast<size_t>(dataset->getNumberOfVoxels()) * dataset->getComponentsPerVoxel() * getTexelChannelSize(_texturePrecision); // in bytes
+
+    // The cached textures of the other render modes hold the previous volume
+    invalidateVolumeTextures();
+    _positionVolumeChanged = true;
+
+    // The occupancy of a point-derived volume leaves the empty render cubes out
+    updateComponentQuantization();
+    updateBrickOccupancy();
+    updateRenderCubes();
+    updataDataTexture();
+}
+
+bool VolumeRenderer::fitsOnGPU(const mv::Dataset<Volumes>& dataset, int numComponents) const
+{
+    const auto volumeSize = dataset->getVolumeSize();
+
+    if (static_cast<size_t>(dataset->getNumberOfVoxels()) * getBytesPerVoxel(numComponents) > getVolumeMemoryBudget())
     {
-        qCritical() << "VolumeRenderer::setData: Not enough GPU memory available for the volume data with set VRAM do not use full data renderModes or change VRAM parameter if you have more available";
-        return;
+        qWarning() << "VolumeRenderer::fitsOnGPU: The volume texture of the current render mode takes more than the" << getVolumeMemoryBudget() / (1024 * 1024) << "MB of video memory available for it";
+        return false;
     }
 
-    updataDataTexture();
-    updateRenderCubes();
+    if (std::max({ volumeSize.width(), volumeSize.height(), volumeSize.depth() }) > _maxTextureSize)
+    {
+        qWarning() << "VolumeRenderer::fitsOnGPU: The volume exceeds the maximum 3D texture size of" << _maxTextureSize << "voxels per axis";
+        return false;
+    }
+
+    return true;
+}
+
+// Mirrors the uploads of updataDataTexture: the full data modes pack the components into an atlas of RGBA texels, the other modes upload a fixed number of channels
+size_t VolumeRenderer::getBytesPerVoxel(int numComponents) const
+{
+    // The compute passes of the id and color modes also keep the normalized RG32F positions of the voxels on the GPU
+    const size_t positionVolumeSize = 2 * sizeof(float);
+
+    switch (getRenderModeGroup(_renderMode))
+    {
+    case 1:
+        return static_cast<size_t>((numComponents + 3) / 4) * 4 * getTexelChannelSize(_texturePrecision);
+    case 2:
+    case 3:
+        return 2 * getTexelChannelSize(getPositionPrecision());
+    case 4:
+        return mv::Texture3D::getChannelSize(_materialIdPixelType) + (_materialIdVolumeComputeShader ? positionVolumeSize : 0);
+    case 5:
+        return 4 * getTexelChannelSize(_colorPrecision) + (_tfVolumeComputeShader ? positionVolumeSize : 0);
+    case 6:
+        return getTexelChannelSize(_texturePrecision);
+    default:
+        return static_cast<size_t>(numComponents) * getTexelChannelSize(_texturePrecision);
+    }
+}
+
+size_t VolumeRenderer::getVolumeMemoryBudget() const
+{
+    const size_t budget = _gpuMemorySize > reservedGPUMemorySize ? _gpuMemorySize - reservedGPUMemorySize : 0;
+
+    // The coarser levels add up to less than an eighth of the full resolution level, the atlas of the full data modes has none
+    return getRenderModeGroup(_renderMode) == 1 ? budget : budget / 8 * 7;
+}
+
+void VolumeRenderer::computeFittingVolumeSize(const VolumeResampling::Region& region, int numComponents, std::int32_t targetSize[3]) const
+{
+    VolumeResampling::computeFittingSize(region, static_cast<std::int64_t>(getBytesPerVoxel(numComponents)), _maxTextureSize, static_cast<std::int64_t>(getVolumeMemoryBudget()), targetSize);
 }
 
 void VolumeRenderer::setTfTexture(const mv::Dataset<Images>& tfTexture)
 {
     _tfDataset = tfTexture;
     QSize textureDims = _tfDataset->getImageSize();
+    const bool sizeChanged = textureDims != _tfImageSize;
+    _tfImageSize = textureDims;
     int dataSize = textureDims.width() * textureDims.height() * 4;
     _tfImage = QVector<float>(dataSize);
     QPair<float, float> scalarDataRange;
@@ -275,14 +411,26 @@ void VolumeRenderer::setTfTexture(const mv::Dataset<Images>& tfTexture)
     glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, textureDims.width(), textureDims.height() - 1, 0, GL_RGBA, GL_FLOAT, _tfImage.data());
     _tfTexture.release();
 
+    // The colors of the composite modes are looked up in the transfer function, the 2D positions only depend on its size
+    invalidateVolumeTextures({ 5 });
+
+    if (sizeChanged) {
+        invalidateVolumeTextures({ 3 });
+        if (getRenderModeGroup(_renderMode) == 3)
+            _dataSettingsChanged = true;
+    }
+
     // In these rendermodes the new dataset will impact the visualization and thus needs to be updated now 
-    if (_renderMode == RenderMode::MULTIDIMENSIONAL_COMPOSITE_COLOR || _renderMode == RenderMode::NN_MULTIDIMENSIONAL_COMPOSITE || _renderMode == RenderMode::NN_MaterialTransition || _renderMode == RenderMode::Alt_NN_MaterialTransition || _renderMode == RenderMode::Smooth_NN_MaterialTransition)
+    if (getRenderModeGroup(_renderMode) == 5)
         updataDataTexture();
 }
 
 void VolumeRenderer::setReducedPosData(const mv::Dataset<Points>& reducedPosData)
 {
     _reducedPosDataset = reducedPosData;
+    _reducedPosDataVersion++; // Called on dataChanged of the dataset, so the cached normalized positions are stale
+    invalidateVolumeTextures({ 2, 3, 4, 5 });
+    _positionVolumeChanged = true;
     if (!_renderMode == RenderMode::MULTIDIMENSIONAL_COMPOSITE_FULL && !_renderMode == RenderMode::MaterialTransition_FULL && _renderMode != RenderMode::MIP) {
         updataDataTexture(); // The position data is used in the rendering process, so we need to update the data texture (apart from the MIP and full data render modes that either don't need it or define it elsewhere)
     }
@@ -312,42 +460,113 @@ void VolumeRenderer::setMaterialPositionTexture(const mv::Dataset<Images>& mater
     _materialPositionTexture.bind();
     glTexImage2D(GL_TEXTURE_2D, 0, GL_R32F, textureDims.width(), textureDims.height(), 0, GL_RED, GL_FLOAT, _materialPositionImage.data());
     _materialPositionTexture.release();
+
+    // Material ids are stored as 8 bit integers unless the texture holds larger ids
+    const float maxMaterialId = _materialPositionImage.isEmpty() ? 0.0f : *std::max_element(_materialPositionImage.begin(), _materialPositionImage.end());
+    _materialIdPixelType = maxMaterialId < 255.5f ? GL_UNSIGNED_BYTE : GL_UNSIGNED_SHORT;
+
+    // The positions are normalized to the size of the material position texture and the material ids are looked up in it
+    invalidateVolumeTextures({ 2, 4 });
 }
 
-void VolumeRenderer::normalizePositionData(std::vector<float>& positionData)
+// The positions are scaled to the size of the lookup texture of the current render mode
+float VolumeRenderer::getPositionScale() const
 {
-    float minX = std::numeric_limits<float>::max();
-    float maxX = std::numeric_limits<float>::min();
-    float minY = std::numeric_limits<float>::max();
-    float maxY = std::numeric_limits<float>::min();
+    int size = _tfDataset->getImageSize().width(); // We use a square texture so width is also height
+    if (_renderMode == RenderMode::MaterialTransition_2D || _renderMode == RenderMode::NN_MaterialTransition || _renderMode == RenderMode::Alt_NN_MaterialTransition || _renderMode == RenderMode::MaterialTransition_FULL)
+        size = _materialPositionDataset->getImageSize().width();
 
-    for (int i = 0; i < positionData.size(); i++) {
-        if (i % 2 == 0) {
-            if (positionData[i] < minX)
-                minX = positionData[i];
-            if (positionData[i] > maxX)
-                maxX = positionData[i];
-        }
-        else {
-            if (positionData[i] < minY)
-                minY = positionData[i];
-            if (positionData[i] > maxY)
-                maxY = positionData[i];
-        }
+    return static_cast<float>(size - 1);
+}
+
+// The positions span at most the size of a lookup texture (up to about a thousand texels), so 16 bit normalized texels resolve them far below a texel.
+// They are always stored as RG16, whatever the texture precision: 8 bits would snap them to steps of several texels, and RG16 is also more exact
+// than Float16 at the far end of the range.
+TexturePrecision VolumeRenderer::getPositionPrecision() const
+{
+    return TexturePrecision::UNORM16;
+}
+
+// Returns the DR positions mapped onto [0, scale] on both axes. The [0, 1] positions are only recomputed when another dataset is set,
+// its data changed or the number of voxels changed, and the scaled positions of the last used scale are kept next to them.
+const std::vector<float>& VolumeRenderer::getNormalizedPositions(float scale)
+{
+    const std::int64_t numPositions = _volumeDataset->getNumberOfVoxels();
+    const QString datasetId = _reducedPosDataset->getId();
+
+    if (datasetId != _normalizedPositionsDatasetId || _normalizedPositionsVersion != _reducedPosDataVersion || _unitPositions.size() != static_cast<size_t>(numPositions) * 2) {
+        _unitPositions.resize(static_cast<size_t>(numPositions) * 2);
+        _reducedPosDataset->populateDataForDimensions(_unitPositions, std::vector<int>{0, 1});
+
+        const PositionNormalization::Bounds bounds = PositionNormalization::computeBounds(_unitPositions.data(), numPositions);
+        PositionNormalization::normalize(_unitPositions.data(), numPositions, bounds, _unitPositions.data());
+
+        _normalizedPositionsDatasetId = datasetId;
+        _normalizedPositionsVersion = _reducedPosDataVersion;
+        _scaledPositionsScale = -1.0f;
     }
 
-    float rangeX = maxX - minX;
-    float rangeY = maxY - minY;
+    if (scale == 1.0f)
+        return _unitPositions;
 
-    int size = _tfDataset->getImageSize().width(); // We use a square texture so width is also height
-    if (_renderMode == RenderMode::MaterialTransition_2D || _renderMode == RenderMode::NN_MaterialTransition || _renderMode == RenderMode::Alt_NN_MaterialTransition || _renderMode == RenderMode::MaterialTransition_FULL)
-        size = _materialPositionDataset->getImageSize().width();
+    if (scale != _scaledPositionsScale) {
+        _scaledPositions.resize(_unitPositions.size());
+        PositionNormalization::scale(_unitPositions.data(), _unitPositions.size(), scale, _scaledPositions.data());
+        _scaledPositionsScale = scale;
+    }
 
-    for (int i = 0; i < positionData.size(); i += 2)
-    {
-        positionData[i] = ((positionData[i] - minX) / rangeX) * (size - 1);
-        positionData[i + 1] = ((positionData[i + 1] - minY) / rangeY) * (size - 1);
+    return _scaledPositions;
+}
+
+// Reads the per-component quantization that the loader attached to quantized point data, the stored integers are mapped back to the source values
+// before they reach the shaders, the full data sampling and the ANN search
+void VolumeRenderer::updateComponentQuantization()
+{
+    _componentQuantization = VolumeQuantization::ComponentQuantization();
+
+    mv::Dataset<Points> points(_volumeDataset->getParent());
+
+    if (!points.isValid() || !points->hasProperty("QuantizationScale") || !points->hasProperty("QuantizationOffset"))
+        return;
+
+    const auto scale = points->getProperty("QuantizationScale").toList();
+    const auto offset = points->getProperty("QuantizationOffset").toList();
+    const int numComponents = _volumeDataset->getComponentsPerVoxel();
+
+    if (scale.size() != numComponents || offset.size() != numComponents) {
+        qWarning() << "VolumeRenderer::updateComponentQuantization: The quantization does not match the number of components and is ignored";
+        return;
+    }
+
+    for (int c = 0; c < numComponents; c++) {
+        _componentQuantization.scale.push_back(scale[c].toFloat());
+        _componentQuantization.offset.push_back(offset[c].toFloat());
+    }
+}
+
+// Reads the brick occupancy that the loader attached to a point-derived volume, volumes without one are treated as dense
+void VolumeRenderer::updateBrickOccupancy()
+{
+    _brickOccupancy = SparseVolume::BrickOccupancy();
+
+    if (!_volumeDataset->hasProperty("BrickSize") || !_volumeDataset->hasProperty("BrickOccupancy"))
+        return;
+
+    const QByteArray occupied = _volumeDataset->getProperty("BrickOccupancy").toByteArray();
+
+    _brickOccupancy.sizeX = static_cast<std::int32_t>(_volumeSize.x);
+    _brickOccupancy.sizeY = static_cast<std::int32_t>(_volumeSize.y);
+    _brickOccupancy.sizeZ = static_cast<std::int32_t>(_volumeSize.z);
+    _brickOccupancy.brickSize = _volumeDataset->getProperty("BrickSize").toInt();
+    _brickOccupancy.occupied.assign(occupied.begin(), occupied.end());
+
+    if (!_brickOccupancy.isValid()) {
+        qWarning() << "VolumeRenderer::updateBrickOccupancy: The brick occupancy does not match the volume size and is ignored";
+        _brickOccupancy = SparseVolume::BrickOccupancy();
+        return;
     }
+
+    qDebug() << "Occupied bricks: " << _brickOccupancy.getNumberOfOccupiedBricks() << " of " << _brickOccupancy.getNumberOfBricks();
 }
 
 void VolumeRenderer::updateRenderCubes()
@@ -358,8 +577,7 @@ void VolumeRenderer::updateRenderCubes()
     int ny = std::ceil(1.0f / relativeBlockSize.y);
     int nz = std::ceil(1.0f / relativeBlockSize.z);
 
-    std::vector<mv::Vector3f> positions;
-    std::vector<float> occupancyValues;
+    _renderCubePositions.clear();
 
     for (int x = 0; x < nx; ++x)
     {
@@ -367,20 +585,28 @@ void VolumeRenderer::updateRenderCubes()
         {
             for (int z = 0; z < nz; ++z)
             {
+                // Cubes that only hold empty bricks are left out, the rays then start and end at the occupied part of the volume
+                const std::int32_t begin[3] = { x * _renderCubeSize, y * _renderCubeSize, z * _renderCubeSize };
+                const std::int32_t end[3] = { begin[0] + _renderCubeSize, begin[1] + _renderCubeSize, begin[2] + _renderCubeSize };
+
+                if (!_brickOccupancy.isRegionOccupied(begin, end))
+                    continue;
+
                 mv::Vector3f posIndex = mv::Vector3f(x, y, z);
-                positions.push_back(posIndex);
+                _renderCubePositions.push_back(posIndex);
             }
         }
     }
-    qDebug() << "Amount of render cubes: " << positions.size();
+    qDebug() << "Amount of render cubes: " << _renderCubePositions.size() << " of " << nx * ny * nz;
     glBindBuffer(GL_TEXTURE_BUFFER, _renderCubePositionsBufferID);
-    glBufferData(GL_TEXTURE_BUFFER, positions.size() * sizeof(mv::Vector3f), positions.data(), GL_DYNAMIC_DRAW);
+    glBufferData(GL_TEXTURE_BUFFER, _renderCubePositions.size() * sizeof(mv::Vector3f), _renderCubePositions.data(), GL_DYNAMIC_DRAW);
 
-    _renderCubeAmount = positions.size();
+    _renderCubeAmount = _renderCubePositions.size();
 }
 
 // This function handles the loading of volume data that requires the results of the transfer function to already be aplied to the data before being stored in the texture.
-void VolumeRenderer::loadNNVolumeToTexture(mv::Texture3D& targetVolume, std::vector<float>& textureData, QVector<float>& usedTFImage, int width, mv::Vector3f volumeSize, int pointAmount, bool singleValueTFTexture)
+// The caller uploads the resulting 4 component textureData, such that it can choose the precision of the texture.
+void VolumeRenderer::loadNNVolumeData(std::vector<float>& textureData, QVector<float>& usedTFImage, int width, int pointAmount)
 {
     if (!_reducedPosDataset.isValid()) {
         qCritical() << "No DR reduction data set";
@@ -389,34 +615,103 @@ void VolumeRenderer::loadNNVolumeToTexture(mv::Texture3D& targetVolume, std::vec
     textureData = std::vector<float>(pointAmount * 4);
 
     //Get the correct data into textureData 
-    std::vector<float> positionData = std::vector<float>(pointAmount * 2);
-    _reducedPosDataset->populateDataForDimensions(positionData, std::vector<int>{0, 1});
-    normalizePositionData(positionData);
+    const std::vector<float>& positionData = getNormalizedPositions(static_cast<float>(width - 1));
 
     for (int i = 0; i < pointAmount; i++)
     {
         int x = positionData[i * 2];
         int y = positionData[i * 2 + 1];
-        if (singleValueTFTexture) { // If we only have a single field, we need to use the same value for all channels
-            int pixelPos = (y * width + x);
+        int pixelPos = (y * width + x) * 4;
+        textureData[i * 4] = usedTFImage[pixelPos];
+        textureData[(i * 4) + 1] = usedTFImage[pixelPos + 1];
+        textureData[(i * 4) + 2] = usedTFImage[pixelPos + 2];
+        textureData[(i * 4) + 3] = usedTFImage[pixelPos + 3];
+    }
+}
+
+// Looks up the material id at the DR position of every voxel. The ids are gathered as floats such that the nearest pyramid can be built from them,
+// they are only converted to R8UI or R16UI texels while they are uploaded
+void VolumeRenderer::loadMaterialIdVolumeData(std::vector<float>& materialIds)
+{
+    if (!_reducedPosDataset.isValid()) {
+        qCritical() << "No DR reduction data set";
+        return;
+    }
+
+    const int width = _materialPositionDataset->getImageSize().width();
+    const std::int64_t numVoxels = _volumeDataset->getNumberOfVoxels();
+    const std::vector<float>& positionData = getNormalizedPositions(static_cast<float>(width - 1));
+
+    materialIds.resize(numVoxels);
 
-            textureData[i * 4] = usedTFImage[pixelPos];
-            textureData[(i * 4) + 1] = usedTFImage[pixelPos];
-            textureData[(i * 4) + 2] = usedTFImage[pixelPos];
-            textureData[(i * 4) + 3] = usedTFImage[pixelPos];
+    #pragma omp parallel for schedule(static)
+    for (std::int64_t i = 0; i < numVoxels; i++)
+    {
+        int x = positionData[i * 2];
+        int y = positionData[i * 2 + 1];
+        materialIds[i] = _materialPositionImage[y * width + x];
+    }
+}
+
+// Uploads a level of material ids to the (bound) texture as R8UI or R16UI texels, depending on the largest id in the material position texture
+void VolumeRenderer::uploadMaterialIdVolumeLevel(mv::Texture3D& texture, int width, int height, int depth, const std::vector<float>& materialIds, int level)
+{
+    const std::int64_t sliceValues = static_cast<std::int64_t>(width) * height;
+    const float maxMaterialId = _materialIdPixelType == GL_UNSIGNED_BYTE ? 255.0f : 65535.0f;
+
+    texture.streamIntegerData(width, height, depth, _materialIdPixelType, level, [&](void* slab, int z, int slabDepth) {
+        const float* ids = materialIds.data() + z * sliceValues;
+        const std::int64_t numValues = slabDepth * sliceValues;
+
+        if (_materialIdPixelType == GL_UNSIGNED_BYTE) {
+            auto* texels = static_cast<std::uint8_t*>(slab);
+            #pragma omp parallel for schedule(static)
+            for (std::int64_t i = 0; i < numValues; i++)
+                texels[i] = static_cast<std::uint8_t>(std::clamp(std::round(ids[i]), 0.0f, maxMaterialId));
         }
-        else { // If we have multiple fields, we need to use the correct value for each channel
-            int pixelPos = (y * width + x) * 4;
-            textureData[i * 4] = usedTFImage[pixelPos];
-            textureData[(i * 4) + 1] = usedTFImage[pixelPos + 1];
-            textureData[(i * 4) + 2] = usedTFImage[pixelPos + 2];
-            textureData[(i * 4) + 3] = usedTFImage[pixelPos + 3];
+        else {
+            auto* texels = static_cast<std::uint16_t*>(slab);
+            #pragma omp parallel for schedule(static)
+            for (std::int64_t i = 0; i < numValues; i++)
+                texels[i] = static_cast<std::uint16_t>(std::clamp(std::round(ids[i]), 0.0f, maxMaterialId));
         }
+    });
+}
+
+// Fills the volume texture of the NN material transition modes with one integer material id per voxel, instead of the id copied to four float channels.
+// Material ids have to stay exact, so every level of the pyramid takes the id of its nearest voxel.
+void VolumeRenderer::updateMaterialIdVolumeTexture()
+{
+    _volumeTexturePrecision = TexturePrecision::FLOAT32; // Not used by the integer texture, the ids need no dequantization
+    _volumeDequantization = VolumeQuantization::Dequantization();
+
+    if (computeMaterialIdVolume())
+        return;
+
+    const int width = _volumeTextureSize.x;
+    const int height = _volumeTextureSize.y;
+    const int depth = _volumeTextureSize.z;
+
+    std::vector<float> materialIds;
+    loadMaterialIdVolumeData(materialIds);
+    std::vector<VolumePyramid::Level> levels = VolumePyramid::build(materialIds, width, height, depth, 1, VolumePyramid::Filter::Nearest, _maxResolutionLevels);
+
+    auto& cacheEntry = _volumeTextureCache[_volumeTextureGroup];
+    const std::size_t channelSize = mv::Texture3D::getChannelSize(_materialIdPixelType);
+
+    _volumeTexture->bind();
+    uploadMaterialIdVolumeLevel(*_volumeTexture, width, height, depth, materialIds, 0);
+    cacheEntry.memorySize = static_cast<size_t>(width) * height * depth * channelSize;
+    for (int level = 0; level < levels.size(); level++) {
+        uploadMaterialIdVolumeLevel(*_volumeTexture, levels[level].width, levels[level].height, levels[level].depth, levels[level].data, level + 1);
+        cacheEntry.memorySize += static_cast<size_t>(levels[level].width) * levels[level].height * levels[level].depth * channelSize;
     }
-    // Generate and bind a 3D texture
-    targetVolume.bind();
-    targetVolume.setData(volumeSize.x, volumeSize.y, volumeSize.z, textureData, 4);
-    targetVolume.release(); // Unbind the texture
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_BASE_LEVEL, 0);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(levels.size()));
+    _volumeTexture->release();
+
+    _volumeTextureLevels = static_cast<int>(levels.size()) + 1;
+    _activeResolutionLevel = 0;
 }
 
 void VolumeRenderer::updataDataTexture()
@@ -429,28 +724,31 @@ void VolumeRenderer::updataDataTexture()
             int blockAmount = std::ceil(float(_compositeIndices.size()) / 4.0f) * 4; //Since we always assume textures with 4 dimensions all of which need to be filled
             _textureData = std::vector<float>(blockAmount * _volumeDataset->getNumberOfVoxels());
             _volumeTextureSize = _volumeDataset->getVolumeAtlasData(_compositeIndices, _textureData, scalarDataRange);
-            _fullDataMemorySize = sizeof(float) * _textureData.size(); // in bytes
+
+            // The bricks of the atlas hold different components, so quantized point data is mapped back on the CPU instead of through the dequantization uniforms
+            dequantizeAtlasData(_compositeIndices);
+            dequantizeComponentRange(_compositeIndices, scalarDataRange);
+            getStoredComponentRange(_compositeIndices, scalarDataRange);
+            _fullDataMemorySize = getTexelChannelSize(_texturePrecision) * _textureData.size(); // in bytes
             qDebug() << "Full data memory size: " << _fullDataMemorySize;
-            // Generate and bind a 3D texture
-            _volumeTexture.bind();
-            _volumeTexture.setData(_volumeTextureSize.x, _volumeTextureSize.y, _volumeTextureSize.z, _textureData, 4);
-            _volumeTexture.release(); // Unbind the texture
+            uploadVolumeTexture(4, _texturePrecision);
+
+            // The atlas packs the dimensions in bricks that would bleed into each other when downsampled, so only the full resolution is used
+            updateVolumeTexturePyramid(4, VolumePyramid::Filter::Nearest, 1);
         }
         else if (_renderMode == RenderMode::MULTIDIMENSIONAL_COMPOSITE_2D_POS || _renderMode == RenderMode::MaterialTransition_2D) {
             if (!_tfDataset.isValid() || !_reducedPosDataset.isValid()) { // _tfTexture is used in the normalize function
                 qCritical() << "No position data set";
                 return;
             }
-            _textureData = std::vector<float>(_volumeDataset->getNumberOfVoxels() * 2);
+            const std::vector<float>& positionData = getNormalizedPositions(getPositionScale());
+            _textureData.assign(positionData.begin(), positionData.end());
             _volumeTextureSize = _volumeSize;
 
-            _reducedPosDataset->populateDataForDimensions(_textureData, std::vector<int>{0, 1});
-            normalizePositionData(_textureData);
+            uploadVolumeTexture(2, getPositionPrecision());
 
-            // Generate and bind a 3D texture
-            _volumeTexture.bind();
-            _volumeTexture.setData(_volumeTextureSize.x, _volumeTextureSize.y, _volumeTextureSize.z, _textureData, 2);
-            _volumeTexture.release(); // Unbind the texture
+            // Averaging embedding positions would create positions that belong to none of the voxels
+            updateVolumeTexturePyramid(2, VolumePyramid::Filter::Nearest, _maxResolutionLevels);
         }
         else if (_renderMode == RenderMode::NN_MaterialTransition || _renderMode == RenderMode::Alt_NN_MaterialTransition || _renderMode == RenderMode::Smooth_NN_MaterialTransition) {
             if (!_materialPositionDataset.isValid()) {
@@ -459,7 +757,7 @@ void VolumeRenderer::updataDataTexture()
             }
 
             _volumeTextureSize = _volumeSize;
-            loadNNVolumeToTexture(_volumeTexture, _textureData, _materialPositionImage, _materialPositionDataset->getImageSize().width(), _volumeTextureSize, _volumeDataset->getNumberOfVoxels(), true);
+            updateMaterialIdVolumeTexture();
         }
         else if (_renderMode == RenderMode::MULTIDIMENSIONAL_COMPOSITE_COLOR || _renderMode == RenderMode::NN_MULTIDIMENSIONAL_COMPOSITE) {
             if (!_tfDataset.isValid()) {
@@ -468,16 +766,33 @@ void VolumeRenderer::updataDataTexture()
             }
             
             _volumeTextureSize = _volumeSize;
-            loadNNVolumeToTexture(_volumeTexture, _textureData, _tfImage, _tfDataset->getImageSize().width(), _volumeTextureSize, _volumeDataset->getNumberOfVoxels(), false);
+
+            const auto filter = getColorPyramidFilter(_renderMode);
+            _volumeTexturePyramidFilter = filter;
+
+            if (!computeTransferFunctionVolume(_tfTexture, _tfDataset->getImageSize().width(), _tfImage, _colorPrecision, filter)) {
+                loadNNVolumeData(_textureData, _tfImage, _tfDataset->getImageSize().width(), _volumeDataset->getNumberOfVoxels());
+                uploadVolumeTexture(4, _colorPrecision);
+                updateVolumeTexturePyramid(4, filter, _maxResolutionLevels);
+            }
         }
         else if (_renderMode == RenderMode::MIP) {
             _textureData = std::vector<float>(_volumeDataset->getNumberOfVoxels());
-            _volumeTextureSize = _volumeDataset->getVolumeAtlasData(std::vector<uint32_t>{ uint32_t(_mipDimension) }, _textureData, scalarDataRange, 1);
+            const std::vector<uint32_t> mipComponents{ uint32_t(_mipDimension) };
+
+            _volumeTextureSize = _volumeDataset->getVolumeAtlasData(mipComponents, _textureData, scalarDataRange, 1);
+            dequantizeComponentRange(mipComponents, scalarDataRange);
+            getStoredComponentRange(mipComponents, scalarDataRange);
 
-            // Generate and bind a 3D texture
-            _volumeTexture.bind();
-            _volumeTexture.setData(_volumeTextureSize.x, _volumeTextureSize.y, _volumeTextureSize.z, _textureData, 1);
-            _volumeTexture.release(); // Unbind the texture
+            uploadVolumeTexture(1, _texturePrecision);
+
+            // A max filter keeps small bright structures visible in the coarser levels of the projection
+            updateVolumeTexturePyramid(1, VolumePyramid::Filter::Max, _maxResolutionLevels);
+
+            // The texture keeps the stored values of quantized point data, the shader maps them back to the source values through the dequantization uniforms.
+            // This is done after all levels are uploaded, since the levels are quantized with the dequantization of the stored values.
+            if (!_componentQuantization.isEmpty() && uint32_t(_mipDimension) < _componentQuantization.scale.size())
+                VolumeQuantization::foldComponentQuantization(_volumeDequantization, 0, _componentQuantization.scale[_mipDimension], _componentQuantization.offset[_mipDimension]);
         }
         else
             qCritical() << "Unknown render mode";
@@ -486,6 +801,418 @@ void VolumeRenderer::updataDataTexture()
         qCritical() << "No volume data set";
 
     _scalarVolumeDataRange = scalarDataRange;
+
+    // The new texture may push the cached textures of other render modes over the budget
+    evictVolumeTextures();
+}
+
+// Uploads the DR positions of the voxels, normalized to [0, 1], with the same levels as the volume texture.
+// They only change with the volume and the DR positions, so transfer function edits reuse them.
+void VolumeRenderer::updatePositionVolumeTexture()
+{
+    if (!_positionVolumeChanged)
+        return;
+
+    const int width = _volumeSize.x;
+    const int height = _volumeSize.y;
+    const int depth = _volumeSize.z;
+
+    const std::vector<float>& positionData = getNormalizedPositions(1.0f);
+
+    // Averaging embedding positions would create positions that belong to none of the voxels
+    std::vector<VolumePyramid::Level> levels = VolumePyramid::build(positionData, width, height, depth, 2, VolumePyramid::Filter::Nearest, _maxResolutionLevels);
+
+    _positionVolumeTexture.bind();
+    _positionVolumeTexture.setData(width, height, depth, positionData, 2);
+    for (int level = 0; level < levels.size(); level++)
+        _positionVolumeTexture.setData(levels[level].width, levels[level].height, levels[level].depth, levels[level].data, 2, level + 1);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_BASE_LEVEL, 0);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAX_LEVEL, static_cast<int>(levels.size()));
+    _positionVolumeTexture.release();
+
+    _positionVolumeChanged = false;
+}
+
+// Bakes the lookup texture into all levels of the volume texture with a compute pass, every voxel gets the texel at its DR position.
+// Only the lookup texture is read, so a transfer function edit does not touch the volume data on the CPU.
+// Returns false when compute shaders are not available, the caller then builds the volume on the CPU with loadNNVolumeData.
+bool VolumeRenderer::computeTransferFunctionVolume(mv::Texture2D& lookupTexture, int lookupSize, QVector<float>& lookupImage, TexturePrecision precision, VolumePyramid::Filter filter)
+{
+    if (!_tfVolumeComputeShader)
+        return false;
+
+    if (!_reducedPosDataset.isValid()) {
+        qCritical() << "No DR reduction data set";
+        return true;
+    }
+
+    updatePositionVolumeTexture();
+
+    // The lookup texture holds every value a voxel can get, so its range is the range of the volume
+    _volumeTexturePrecision = precision;
+    if (precision == TexturePrecision::UNORM16 || precision == TexturePrecision::UNORM8)
+        _volumeDequantization = VolumeQuantization::computeDequantization(lookupImage.data(), lookupImage.size(), 4);
+    else
+        _volumeDequantization = VolumeQuantization::Dequantization();
+
+    static const GLenum imageFormats[4] = { GL_RGBA32F, GL_RGBA16F, GL_RGBA16, GL_RGBA8 };
+    const GLenum imageFormat = imageFormats[precision];
+
+    const int width = _volumeTextureSize.x;
+    const int height = _volumeTextureSize.y;
+    const int depth = _volumeTextureSize.z;
+    const int numLevels = VolumePyramid::getNumberOfLevels(width, height, depth, _maxResolutionLevels);
+
+    // A transfer function edit keeps the size, precision and levels of the volume, so the storage is only allocated when one of them changes and the compute pass overwrites it
+    if (!_volumeTexture->hasStorage(width, height, depth, imageFormat, numLevels)) {
+        if (_volumeTexture->hasStorage()) {
+            _volumeTexture->recreate();
+            updateVolumeTextureFilter();
+        }
+
+        auto& cacheEntry = _volumeTextureCache[_volumeTextureGroup];
+        cacheEntry.memorySize = 0;
+
+        for (int level = 0; level < numLevels; level++)
+            cacheEntry.memorySize += static_cast<size_t>(VolumePyramid::getLevelSize(width, level)) * VolumePyramid::getLevelSize(height, level) * VolumePyramid::getLevelSize(depth, level) * 4 * getTexelChannelSize(precision);
+
+        _volumeTexture->bind();
+        _volumeTexture->setStorage(width, height, depth, imageFormat, numLevels);
+        _volumeTexture->release();
+    }
+
+    _volumeTexture->bind();
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_BASE_LEVEL, 0);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAX_LEVEL, numLevels - 1);
+    _volumeTexture->release();
+
+    const auto& scale = _volumeDequantization.scale;
+    const auto& offset = _volumeDequantization.offset;
+
+    _tfVolumeComputeShader->bind();
+    lookupTexture.bind(0);
+    _tfVolumeComputeShader->setUniformValue("tfSize", lookupSize);
+    _tfVolumeComputeShader->setUniformValue("dequantizeScale", QVector4D(scale[0], scale[1], scale[2], scale[3]));
+    _tfVolumeComputeShader->setUniformValue("dequantizeOffset", QVector4D(offset[0], offset[1], offset[2], offset[3]));
+
+    // A nearest pyramid is the lookup of the nearest pyramid of the positions, so every level gets its own pass
+    const int numComputedLevels = filter == VolumePyramid::Filter::Nearest ? numLevels : 1;
+    dispatchVolumeCompute(*_tfVolumeComputeShader, imageFormat, numComputedLevels);
+
+    // Averaged colors are downsampled on the GPU as well
+    if (numComputedLevels < numLevels) {
+        _volumeTexture->bind();
+        glGenerateMipmap(GL_TEXTURE_3D);
+        _volumeTexture->release();
+    }
+
+    _volumeTextureLevels = numLevels;
+    _activeResolutionLevel = 0;
+
+    return true;
+}
+
+// Fills every level of the material id volume on the GPU from the matching level of the position volume.
+// Returns false when the compute shader is not available, the caller then looks the ids up on the CPU.
+bool VolumeRenderer::computeMaterialIdVolume()
+{
+    if (!_materialIdVolumeComputeShader)
+        return false;
+
+    if (!_reducedPosDataset.isValid()) {
+        qCritical() << "No DR reduction data set";
+        return true;
+    }
+
+    updatePositionVolumeTexture();
+
+    const GLenum imageFormat = _materialIdPixelType == GL_UNSIGNED_BYTE ? GL_R8UI : GL_R16UI;
+
+    const int width = _volumeTextureSize.x;
+    const int height = _volumeTextureSize.y;
+    const int depth = _volumeTextureSize.z;
+    const int numLevels = VolumePyramid::getNumberOfLevels(width, height, depth, _maxResolutionLevels);
+
+    auto& cacheEntry = _volumeTextureCache[_volumeTextureGroup];
+    cacheEntry.memorySize = 0;
+
+    // Only allocate the levels, the compute pass fills them
+    _volumeTexture->bind();
+    for (int level = 0; level < numLevels; level++) {
+        const int levelWidth = VolumePyramid::getLevelSize(width, level);
+        const int levelHeight = VolumePyramid::getLevelSize(height, level);
+        const int levelDepth = VolumePyramid::getLevelSize(depth, level);
+
+        _volumeTexture->setIntegerData(levelWidth, levelHeight, levelDepth, nullptr, _materialIdPixelType, level);
+        cacheEntry.memorySize += static_cast<size_t>(levelWidth) * levelHeight * levelDepth * mv::Texture3D::getChannelSize(_materialIdPixelType);
+    }
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_BASE_LEVEL, 0);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAX_LEVEL, numLevels - 1);
+    _volumeTexture->release();
+
+    _materialIdVolumeComputeShader->bind();
+    _materialPositionTexture.bind(0);
+    _materialIdVolumeComputeShader->setUniformValue("materialPositionSize", _materialPositionDataset->getImageSize().width());
+    dispatchVolumeCompute(*_materialIdVolumeComputeShader, imageFormat, numLevels);
+
+    _volumeTextureLevels = numLevels;
+    _activeResolutionLevel = 0;
+
+    return true;
+}
+
+// Runs the bound volume compute shader on the first levels of the volume texture, each level reads the same level of the position volume.
+// Releases the shader once the levels are written.
+void VolumeRenderer::dispatchVolumeCompute(QOpenGLShaderProgram& shader, GLenum imageFormat, int numLevels)
+{
+    const int width = _volumeTextureSize.x;
+    const int height = _volumeTextureSize.y;
+    const int depth = _volumeTextureSize.z;
+
+    for (int level = 0; level < numLevels; level++) {
+        const int levelWidth = VolumePyramid::getLevelSize(width, level);
+        const int levelHeight = VolumePyramid::getLevelSize(height, level);
+        const int levelDepth = VolumePyramid::getLevelSize(depth, level);
+
+        glBindImageTexture(0, _positionVolumeTexture.getHandle(), level, GL_TRUE, 0, GL_READ_ONLY, GL_RG32F);
+        glBindImageTexture(1, _volumeTexture->getHandle(), level, GL_TRUE, 0, GL_WRITE_ONLY, imageFormat);
+        glUniform3i(shader.uniformLocation("levelSize"), levelWidth, levelHeight, levelDepth);
+
+        glDispatchCompute((levelWidth + 7) / 8, (levelHeight + 7) / 8, (levelDepth + 3) / 4);
+    }
+
+    glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+    shader.release();
+
+    glBindImageTexture(0, 0, 0, GL_FALSE, 0, GL_READ_ONLY, GL_RG32F);
+    glBindImageTexture(1, 0, 0, GL_FALSE, 0, GL_WRITE_ONLY, imageFormat);
+}
+
+// Gets the value range of the given components from the statistics the loader attached to the volume dataset.
+// The statistics are in the units of the source values, which is also what the shaders see of quantized point data.
+// Returns false (and leaves the range untouched) when the dataset has no statistics, e.g. when it was not created by the loader.
+bool VolumeRenderer::getStoredComponentRange(const std::vector<std::uint32_t>& components, QPair<float, float>& range) const
+{
+    if (components.empty() || !_volumeDataset->hasProperty("ComponentMinimum") || !_volumeDataset->hasProperty("ComponentMaximum"))
+        return false;
+
+    const auto minimum = _volumeDataset->getProperty("ComponentMinimum").toList();
+    const auto maximum = _volumeDataset->getProperty("ComponentMaximum").toList();
+
+    QPair<float, float> storedRange(std::numeric_limits<float>::max(), std::numeric_limits<float>::lowest());
+
+    for (const auto component : components) {
+        if (component >= static_cast<std::uint32_t>(minimum.size()) || component >= static_cast<std::uint32_t>(maximum.size()))
+            return false;
+
+        storedRange.first = std::min(storedRange.first, minimum[component].toFloat());
+        storedRange.second = std::max(storedRange.second, maximum[component].toFloat());
+    }
+
+    range = storedRange;
+    return true;
+}
+
+// Maps a range of stored values of the given components onto the source values, the quantization scales are positive so the bounds stay in order
+void VolumeRenderer::dequantizeComponentRange(const std::vector<std::uint32_t>& components, QPair<float, float>& range) const
+{
+    if (_componentQuantization.isEmpty() || components.empty())
+        return;
+
+    QPair<float, float> sourceRange(std::numeric_limits<float>::max(), std::numeric_limits<float>::lowest());
+
+    for (const auto component : components) {
+        if (component >= _componentQuantization.scale.size())
+            return;
+
+        const float scale = _componentQuantization.scale[component];
+        const float offset = _componentQuantization.offset[component];
+
+        sourceRange.first = std::min(sourceRange.first, range.first * scale + offset);
+        sourceRange.second = std::max(sourceRange.second, range.second * scale + offset);
+    }
+
+    range = sourceRange;
+}
+
+// Maps the stored values in the atlas of _textureData back onto the source values. Every brick of the atlas holds four of the
+// components, in the x-first brick order of the FullDataSampling shader, so the channels of a brick have their own quantization.
+void VolumeRenderer::dequantizeAtlasData(const std::vector<std::uint32_t>& components)
+{
+    if (_componentQuantization.isEmpty())
+        return;
+
+    const int sizeX = static_cast<int>(_volumeSize.x), sizeY = static_cast<int>(_volumeSize.y), sizeZ = static_cast<int>(_volumeSize.z);
+    const int atlasX = static_cast<int>(_volumeTextureSize.x), atlasY = static_cast<int>(_volumeTextureSize.y), atlasZ = static_cast<int>(_volumeTextureSize.z);
+    const int layoutX = atlasX / sizeX, layoutY = atlasY / sizeY;
+
+    // Unused channels of the last brick keep their values
+    const int numBricks = static_cast<int>(components.size() + 3) / 4;
+    std::vector<float> scale(numBricks * 4, 1.0f), offset(numBricks * 4, 0.0f);
+
+    for (std::size_t i = 0; i < components.size(); i++) {
+        if (components[i] >= _componentQuantization.scale.size())
+            continue;
+
+        scale[i] = _componentQuantization.scale[components[i]];
+        offset[i] = _componentQuantization.offset[components[i]];
+    }
+
+    #pragma omp parallel for schedule(static)
+    for (int z = 0; z < atlasZ; z++)
+    {
+        for (int y = 0; y < atlasY; y++)
+        {
+            float* texel = _textureData.data() + (static_cast<std::int64_t>(z) * atlasY + y) * atlasX * 4;
+
+            for (int x = 0; x < atlasX; x++, texel += 4)
+            {
+                const int brick = ((z / sizeZ) * layoutY + y / sizeY) * layoutX + x / sizeX;
+
+                if (brick >= numBricks)
+                    continue;
+
+                for (int c = 0; c < 4; c++)
+                    texel[c] = texel[c] * scale[brick * 4 + c] + offset[brick * 4 + c];
+            }
+        }
+    }
+}
+
+// Uploads _textureData as the full resolution level of the volume texture in the given precision.
+// The normalized precisions quantize every channel to its value range, the shaders undo this with the dequantization uniforms.
+void VolumeRenderer::uploadVolumeTexture(int numComponents, TexturePrecision precision)
+{
+    _volumeTexturePrecision = precision;
+
+    if (precision == TexturePrecision::UNORM16 || precision == TexturePrecision::UNORM8)
+        _volumeDequantization = VolumeQuantization::computeDequantization(_textureData.data(), _textureData.size(), numComponents);
+    else
+        _volumeDequantization = VolumeQuantization::Dequantization();
+
+    _volumeTextureCache[_volumeTextureGroup].memorySize = static_cast<size_t>(_volumeTextureSize.x) * _volumeTextureSize.y * _volumeTextureSize.z * numComponents * getTexelChannelSize(precision);
+
+    // Generate and bind a 3D texture
+    _volumeTexture->bind();
+    uploadVolumeTextureLevel(_volumeTextureSize.x, _volumeTextureSize.y, _volumeTextureSize.z, _textureData, numComponents, 0);
+    _volumeTexture->release(); // Unbind the texture
+}
+
+// Uploads a level of the (bound) volume texture in the precision and with the quantization of its full resolution level.
+// The texels are converted slab by slab straight into the upload buffers, so the level is never copied as a whole.
+void VolumeRenderer::uploadVolumeTextureLevel(int width, int height, int depth, const std::vector<float>& data, int numComponents, int level)
+{
+    const std::int64_t sliceValues = static_cast<std::int64_t>(width) * height * numComponents;
+
+    _volumeTexture->streamData(width, height, depth, numComponents, getVolumePixelType(), level, [&](void* slab, int z, int slabDepth) {
+        convertVolumeTexels(data.data() + z * sliceValues, slabDepth * sliceValues, numComponents, slab);
+    });
+}
+
+// Pixel type of the texels in the precision of the volume texture
+GLenum VolumeRenderer::getVolumePixelType() const
+{
+    switch (_volumeTexturePrecision)
+    {
+    case TexturePrecision::FLOAT16:
+        return GL_HALF_FLOAT;
+    case TexturePrecision::UNORM16:
+        return GL_UNSIGNED_SHORT;
+    case TexturePrecision::UNORM8:
+        return GL_UNSIGNED_BYTE;
+    default:
+        return GL_FLOAT;
+    }
+}
+
+// Converts float texels to the precision of the volume texture and writes them to texels, which holds numValues channels of that precision
+void VolumeRenderer::convertVolumeTexels(const float* data, std::int64_t numValues, int numComponents, void* texels) const
+{
+    if (_volumeTexturePrecision == TexturePrecision::FLOAT16)
+        qFloatToFloat16(static_cast<qfloat16*>(texels), data, static_cast<qsizetype>(numValues));
+    else if (_volumeTexturePrecision == TexturePrecision::UNORM16)
+        VolumeQuantization::quantize(data, numValues, numComponents, _volumeDequantization, static_cast<std::uint16_t*>(texels));
+    else if (_volumeTexturePrecision == TexturePrecision::UNORM8)
+        VolumeQuantization::quantize(data, numValues, numComponents, _volumeDequantization, static_cast<std::uint8_t*>(texels));
+    else
+        std::memcpy(texels, data, numValues * sizeof(float));
+}
+
+void VolumeRenderer::setDequantizationUniforms(mv::ShaderProgram& shader)
+{
+    const auto& scale = _volumeDequantization.scale;
+    const auto& offset = _volumeDequantization.offset;
+
+    shader.uniform4f("dequantizeScale", scale[0], scale[1], scale[2], scale[3]);
+    shader.uniform4f("dequantizeOffset", offset[0], offset[1], offset[2], offset[3]);
+}
+
+// Builds the coarser levels of the data that was just uploaded from _textureData and stores them as the mip levels of the volume texture
+void VolumeRenderer::updateVolumeTexturePyramid(int numComponents, VolumePyramid::Filter filter, int maxLevels)
+{
+    std::vector<VolumePyramid::Level> levels = VolumePyramid::build(_textureData, _volumeTextureSize.x, _volumeTextureSize.y, _volumeTextureSize.z, numComponents, filter, maxLevels);
+
+    auto& cacheEntry = _volumeTextureCache[_volumeTextureGroup];
+
+    _volumeTexture->bind();
+    for (int level = 0; level < levels.size(); level++) {
+        uploadVolumeTextureLevel(levels[level].width, levels[level].height, levels[level].depth, levels[level].data, numComponents, level + 1);
+        cacheEntry.memorySize += levels[level].data.size() * getTexelChannelSize(_volumeTexturePrecision);
+    }
+
+    // Levels left over from a previous (larger) volume are not part of the texture anymore
+    _volumeTextureLevels = static_cast<int>(levels.size()) + 1;
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_BASE_LEVEL, 0);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAX_LEVEL, _volumeTextureLevels - 1);
+    _volumeTexture->release();
+
+    _activeResolutionLevel = 0;
+    qDebug() << "Volume texture resolution levels: " << _volumeTextureLevels;
+}
+
+// Selects the level at which a voxel of the volume covers about one pixel on the screen
+int VolumeRenderer::computeFootprintResolutionLevel()
+{
+    mv::Vector3f renderSize = _useCustomRenderSpace ? _renderSpace : _volumeSize;
+
+    // Distance from the camera to the closest point of the volume, which spans [0, renderSize] in world space
+    QVector3D cameraPos = _camera.getPosition();
+    float dx = std::max({ 0.0f, -cameraPos.x(), cameraPos.x() - renderSize.x });
+    float dy = std::max({ 0.0f, -cameraPos.y(), cameraPos.y() - renderSize.y });
+    float dz = std::max({ 0.0f, -cameraPos.z(), cameraPos.z() - renderSize.z });
+    float distance = std::sqrt(dx * dx + dy * dy + dz * dz);
+
+    if (distance <= 0.0f) // The camera is inside the volume
+        return 0;
+
+    // Number of pixels covered by one world space unit at that distance, the projection matrix holds 1 / tan(fov / 2) at (1, 1)
+    float pixelsPerUnit = 0.5f * _adjustedScreenSize.height() * _camera.getProjectionMatrix()(1, 1) / distance;
+    float voxelSize = std::min({ renderSize.x / _volumeSize.x, renderSize.y / _volumeSize.y, renderSize.z / _volumeSize.z });
+    float voxelFootprint = pixelsPerUnit * voxelSize;
+
+    if (voxelFootprint >= 1.0f)
+        return 0;
+
+    return static_cast<int>(std::floor(std::log2(1.0f / voxelFootprint)));
+}
+
+// Sets the base level of the volume texture, such that all render modes sample the selected resolution without changes to the shaders
+void VolumeRenderer::updateResolutionLevel()
+{
+    int level = _resolutionLevel < 0 ? computeFootprintResolutionLevel() : _resolutionLevel;
+    if (_isInteracting)
+        level += _interactionResolutionLevels;
+    level = std::clamp(level, 0, _volumeTextureLevels - 1);
+
+    if (level != _activeResolutionLevel) {
+        _volumeTexture->bind();
+        glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_BASE_LEVEL, level);
+        _volumeTexture->release();
+        _activeResolutionLevel = level;
+    }
+
+    // Coarser voxels need fewer samples along the ray, the shaders compensate the opacity for the step size
+    _resolutionStepSize = _stepSize * static_cast<float>(1 << level);
 }
 
 void VolumeRenderer::setCamera(const TrackballCamera& camera)
@@ -522,8 +1249,10 @@ void VolumeRenderer::setUseCustomRenderSpace(bool useCustomRenderSpace)
 // Which dimension should we send to the GPU (used for the full data and MIP render modes)
 void VolumeRenderer::setCompositeIndices(std::vector<std::uint32_t> compositeIndices)
 {
-    if (_compositeIndices != compositeIndices)
+    if (_compositeIndices != compositeIndices) {
         _dataSettingsChanged = true;
+        invalidateVolumeTextures({ 1 });
+    }
     _compositeIndices = compositeIndices;
 }
 
@@ -565,69 +1294,191 @@ void VolumeRenderer::setRenderMode(const QString& renderMode)
     else
         qCritical() << "Unknown render mode";
 
-    // Group render modes by needed volume texture requirements
-    auto getRenderModeGroup = [](RenderMode mode) {
-        if (mode == RenderMode::MaterialTransition_FULL || mode == RenderMode::MULTIDIMENSIONAL_COMPOSITE_FULL)
-            return 1;
-        if (mode == RenderMode::MaterialTransition_2D)
-            return 2;
-        if (mode == RenderMode::MULTIDIMENSIONAL_COMPOSITE_2D_POS)
-            return 3;
-        if (mode == RenderMode::NN_MaterialTransition || mode == RenderMode::Alt_NN_MaterialTransition || mode == RenderMode::Smooth_NN_MaterialTransition)
-            return 4;
-        if (mode == RenderMode::MULTIDIMENSIONAL_COMPOSITE_COLOR || mode == RenderMode::NN_MULTIDIMENSIONAL_COMPOSITE)
-            return 5;
-        if (mode == RenderMode::MIP)
-            return 6;
-        return 0; // Unknown group
-        };
+    // The volume textures are created once OpenGL is initialized, init activates the group of the render mode
+    if (!_volumeTexture) {
+        _renderMode = givenMode;
+        return;
+    }
 
     int currentGroup = getRenderModeGroup(givenMode);
 
-    // Only set _dataSettingsChanged to true if the group changes
-    if (getRenderModeGroup(_renderMode) != currentGroup)
+    // Only a group without a cached texture needs to build one
+    if (_volumeTextureGroup != currentGroup && !activateVolumeTexture(currentGroup))
         _dataSettingsChanged = true;
 
-    if (currentGroup == 1 || currentGroup == 2 || currentGroup == 3 || currentGroup == 6) {
-        // For these groups we need to ensure that the volume texture is bound and has the correct settings
-        _volumeTexture.bind();
-        glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        _volumeTexture.release(); // Unbind the texture
-    }
+    // The Color and NN composite modes share their texture, but the coarser levels hold averaged and nearest colors respectively
+    if (currentGroup == 5 && _volumeTexturePyramidFilter != getColorPyramidFilter(givenMode))
+        _dataSettingsChanged = true;
 
-    if (currentGroup == 4) {
-        _volumeTexture.bind();
-        glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-        glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-        _volumeTexture.release(); // Unbind the texture
+    if (currentGroup != 1) {
+        _fullDataModeBatch = -1; // We don't need to use the full data in these modes, so we reset the batch progress counter
     }
 
-    // The NN and Linear version of the same render mode share the same volume texture but they do require slightly different settings
-    if (currentGroup == 5) {
-        _volumeTexture.bind();
-        if (givenMode == RenderMode::NN_MULTIDIMENSIONAL_COMPOSITE) {
-            glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-            glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    _renderMode = givenMode;
+
+    updateVolumeTextureFilter();
+}
+
+// Group render modes by needed volume texture requirements
+int VolumeRenderer::getRenderModeGroup(RenderMode mode)
+{
+    if (mode == RenderMode::MaterialTransition_FULL || mode == RenderMode::MULTIDIMENSIONAL_COMPOSITE_FULL)
+        return 1;
+    if (mode == RenderMode::MaterialTransition_2D)
+        return 2;
+    if (mode == RenderMode::MULTIDIMENSIONAL_COMPOSITE_2D_POS)
+        return 3;
+    if (mode == RenderMode::NN_MaterialTransition || mode == RenderMode::Alt_NN_MaterialTransition || mode == RenderMode::Smooth_NN_MaterialTransition)
+        return 4;
+    if (mode == RenderMode::MULTIDIMENSIONAL_COMPOSITE_COLOR || mode == RenderMode::NN_MULTIDIMENSIONAL_COMPOSITE)
+        return 5;
+    if (mode == RenderMode::MIP)
+        return 6;
+    return 0; // Unknown group
+}
+
+// Filter of the coarser levels of the color volume: the NN composite mode keeps the color of the nearest voxel, the Color mode averages them
+VolumePyramid::Filter VolumeRenderer::getColorPyramidFilter(RenderMode mode)
+{
+    return mode == RenderMode::NN_MULTIDIMENSIONAL_COMPOSITE ? VolumePyramid::Filter::Nearest : VolumePyramid::Filter::Box;
+}
+
+// Sets the interpolation of the volume texture that the current render mode needs
+void VolumeRenderer::updateVolumeTextureFilter()
+{
+    int currentGroup = getRenderModeGroup(_renderMode);
+
+    // Material ids can not be interpolated, the NN and Linear version of the composite color mode share the same volume texture but they do require slightly different settings
+    GLint filter = GL_LINEAR;
+    if (currentGroup == 4 || _renderMode == RenderMode::NN_MULTIDIMENSIONAL_COMPOSITE)
+        filter = GL_NEAREST;
+
+    _volumeTexture->bind();
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, filter);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, filter);
+    _volumeTexture->release(); // Unbind the texture
+}
+
+// Makes the texture of the given render mode group the volume texture, together with the state that was stored with it.
+// The texture of the previous group stays cached unless it was never filled or is waiting for a rebuild.
+// Returns true when the group had a cached texture, otherwise it gets a new texture that still has to be filled.
+bool VolumeRenderer::activateVolumeTexture(int group)
+{
+    auto previous = _volumeTextureCache.find(_volumeTextureGroup);
+
+    if (_volumeTexture && previous != _volumeTextureCache.end()) {
+        auto& entry = previous->second;
+
+        if (entry.memorySize == 0 || _dataSettingsChanged) {
+            entry.texture->destroy();
+            _volumeTextureCache.erase(previous);
         }
         else {
-            glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-            glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            entry.textureSize = _volumeTextureSize;
+            entry.levels = _volumeTextureLevels;
+            entry.pyramidFilter = _volumeTexturePyramidFilter;
+            entry.activeResolutionLevel = _activeResolutionLevel;
+            entry.precision = _volumeTexturePrecision;
+            entry.dequantization = _volumeDequantization;
+            entry.scalarDataRange = _scalarVolumeDataRange;
+            entry.fullDataMemorySize = _fullDataMemorySize;
         }
-        _volumeTexture.release(); // Unbind the texture
     }
 
-    if (currentGroup != 1) {
-        _fullDataModeBatch = -1; // We don't need to use the full data in these modes, so we reset the batch progress counter
+    _volumeTextureGroup = group;
+
+    auto current = _volumeTextureCache.find(group);
+    const bool cached = current != _volumeTextureCache.end();
+
+    if (cached) {
+        const auto& entry = current->second;
+
+        _volumeTextureSize = entry.textureSize;
+        _volumeTextureLevels = entry.levels;
+        _volumeTexturePyramidFilter = entry.pyramidFilter;
+        _activeResolutionLevel = entry.activeResolutionLevel;
+        _volumeTexturePrecision = entry.precision;
+        _volumeDequantization = entry.dequantization;
+        _scalarVolumeDataRange = entry.scalarDataRange;
+        _fullDataMemorySize = entry.fullDataMemorySize;
+        _dataSettingsChanged = false;
+    }
+    else {
+        current = _volumeTextureCache.emplace(group, VolumeTextureCacheEntry()).first;
+        current->second.texture = std::make_unique<mv::Texture3D>();
+        current->second.texture->create();
+        current->second.texture->initialize();
     }
 
-    _renderMode = givenMode;
+    current->second.lastUsed = ++_volumeTextureCacheClock;
+    _volumeTexture = current->second.texture.get();
+
+    qDebug() << "Volume texture of render mode group" << group << (cached ? "taken from the cache" : "has to be built");
+
+    return cached;
+}
+
+// Removes the cached textures of the given render mode groups, as their contents depend on data that changed.
+// The current texture is never removed, the caller rebuilds it when needed.
+void VolumeRenderer::invalidateVolumeTextures(std::initializer_list<int> groups)
+{
+    for (const int group : groups) {
+        auto entry = _volumeTextureCache.find(group);
+
+        if (group == _volumeTextureGroup || entry == _volumeTextureCache.end())
+            continue;
+
+        entry->second.texture->destroy();
+        _volumeTextureCache.erase(entry);
+    }
+}
+
+// Removes the cached textures of all render mode groups apart from the current one
+void VolumeRenderer::invalidateVolumeTextures()
+{
+    for (auto entry = _volumeTextureCache.begin(); entry != _volumeTextureCache.end();) {
+        if (entry->first == _volumeTextureGroup) {
+            ++entry;
+            continue;
+        }
+
+        entry->second.texture->destroy();
+        entry = _volumeTextureCache.erase(entry);
+    }
+}
+
+// Evicts the least recently used cached textures until all textures fit in the budget, the current texture is always kept
+void VolumeRenderer::evictVolumeTextures()
+{
+    size_t totalSize = 0;
+    for (const auto& [group, entry] : _volumeTextureCache)
+        totalSize += entry.memorySize;
+
+    while (totalSize > _volumeTextureCacheBudget) {
+        auto leastRecentlyUsed = _volumeTextureCache.end();
+
+        for (auto entry = _volumeTextureCache.begin(); entry != _volumeTextureCache.end(); ++entry) {
+            if (entry->first != _volumeTextureGroup && (leastRecentlyUsed == _volumeTextureCache.end() || entry->second.lastUsed < leastRecentlyUsed->second.lastUsed))
+                leastRecentlyUsed = entry;
+        }
+
+        if (leastRecentlyUsed == _volumeTextureCache.end())
+            break;
+
+        qDebug() << "Evicting the cached volume texture of render mode group" << leastRecentlyUsed->first;
+
+        totalSize -= leastRecentlyUsed->second.memorySize;
+        leastRecentlyUsed->second.texture->destroy();
+        _volumeTextureCache.erase(leastRecentlyUsed);
+    }
 }
 
 void VolumeRenderer::setMIPDimension(int mipDimension)
 {
-    if (_mipDimension != mipDimension)
+    if (_mipDimension != mipDimension) {
         _dataSettingsChanged = true;
+        invalidateVolumeTextures({ 6 });
+    }
     _mipDimension = mipDimension;
 }
 
@@ -649,6 +1500,113 @@ void VolumeRenderer::setRenderCubeSize(float renderCubeSize)
     }
 }
 
+// Sets the requested resolution level: -1 for automatic selection, 0 for full resolution, 1 for half resolution, etc.
+void VolumeRenderer::setResolutionLevel(int resolutionLevel)
+{
+    _resolutionLevel = resolutionLevel;
+}
+
+void VolumeRenderer::setInteractionResolutionLevels(int interactionResolutionLevels)
+{
+    _interactionResolutionLevels = interactionResolutionLevels;
+}
+
+void VolumeRenderer::setInteracting(bool interacting)
+{
+    _isInteracting = interacting;
+}
+
+// Converts the texture precision string to enum and saves it.
+// Possible strings are: "Float32", "Float16", "UNorm16", "UNorm8"
+void VolumeRenderer::setTexturePrecision(const QString& texturePrecision)
+{
+    TexturePrecision givenPrecision = parseTexturePrecision(texturePrecision);
+
+    // The material id and color volumes have their own precision, and the positions of the 2D modes are always RG16
+    if (_texturePrecision != givenPrecision) {
+        const int group = getRenderModeGroup(_renderMode);
+        if (group == 1 || group == 6)
+            _dataSettingsChanged = true;
+        invalidateVolumeTextures({ 1, 6 });
+    }
+    _texturePrecision = givenPrecision;
+}
+
+// Sets the precision of the transfer function colors that the Color and NN composite modes bake into their volume texture
+void VolumeRenderer::setColorPrecision(const QString& colorPrecision)
+{
+    TexturePrecision givenPrecision = parseTexturePrecision(colorPrecision);
+
+    if (_colorPrecision != givenPrecision) {
+        if (getRenderModeGroup(_renderMode) == 5)
+            _dataSettingsChanged = true;
+        invalidateVolumeTextures({ 5 });
+    }
+    _colorPrecision = givenPrecision;
+}
+
+// Logs the error of storing the transfer function colors of the Color and NN composite modes in the lower precisions, compared to Float32.
+// The colors are looked up on the CPU and converted block by block like the upload does, so it does not need the GPU and works in every render mode.
+void VolumeRenderer::compareColorPrecision()
+{
+    if (!_volumeDataset.isValid() || !_tfDataset.isValid() || !_reducedPosDataset.isValid()) {
+        qCritical() << "The color precision comparison needs a volume, transfer function and position data set";
+        return;
+    }
+
+    const std::int64_t numVoxels = _volumeDataset->getNumberOfVoxels();
+
+    std::vector<float> colors;
+    loadNNVolumeData(colors, _tfImage, _tfDataset->getImageSize().width(), numVoxels);
+
+    const VolumeQuantization::Dequantization dequantization = VolumeQuantization::computeDequantization(colors.data(), colors.size(), 4);
+
+    const std::int64_t blockSize = std::int64_t(1) << 22; // Values converted at once, a multiple of the 4 channels
+    std::vector<std::uint16_t> texels(blockSize);
+    std::vector<float> restored(blockSize);
+
+    qDebug() << "Color volume error compared to Float32 for" << numVoxels << "voxels, per RGBA channel:";
+
+    for (const TexturePrecision precision : { TexturePrecision::FLOAT16, TexturePrecision::UNORM16, TexturePrecision::UNORM8 }) {
+        VolumeQuantization::ErrorStatistics statistics;
+
+        for (std::int64_t offset = 0; offset < static_cast<std::int64_t>(colors.size()); offset += blockSize) {
+            const std::int64_t numValues = std::min(blockSize, static_cast<std::int64_t>(colors.size()) - offset);
+            const float* block = colors.data() + offset;
+
+            if (precision == TexturePrecision::FLOAT16) {
+                qFloatToFloat16(reinterpret_cast<qfloat16*>(texels.data()), block, static_cast<qsizetype>(numValues));
+                qFloatFromFloat16(restored.data(), reinterpret_cast<const qfloat16*>(texels.data()), static_cast<qsizetype>(numValues));
+            }
+            else if (precision == TexturePrecision::UNORM16) {
+                VolumeQuantization::quantize(block, numValues, 4, dequantization, texels.data());
+                VolumeQuantization::dequantize(texels.data(), numValues, 4, dequantization, restored.data());
+            }
+            else {
+                auto* bytes = reinterpret_cast<std::uint8_t*>(texels.data());
+                VolumeQuantization::quantize(block, numValues, 4, dequantization, bytes);
+                VolumeQuantization::dequantize(bytes, numValues, 4, dequantization, restored.data());
+            }
+
+            VolumeQuantization::accumulateError(block, restored.data(), numValues, 4, statistics);
+        }
+
+        const double memorySize = static_cast<double>(numVoxels) * 4 * getTexelChannelSize(precision) / (1024.0 * 1024.0);
+
+        qDebug().noquote() << QString("%1 (%2 MB): max error %3 %4 %5 %6, mean error %7 %8 %9 %10")
+            .arg(texturePrecisionNames[precision]).arg(memorySize, 0, 'f', 1)
+            .arg(statistics.maximum[0], 0, 'g', 3).arg(statistics.maximum[1], 0, 'g', 3).arg(statistics.maximum[2], 0, 'g', 3).arg(statistics.maximum[3], 0, 'g', 3)
+            .arg(statistics.getMean(0), 0, 'g', 3).arg(statistics.getMean(1), 0, 'g', 3).arg(statistics.getMean(2), 0, 'g', 3).arg(statistics.getMean(3), 0, 'g', 3);
+    }
+}
+
+// Sets the VRAM in megabytes the cached volume textures of the render mode groups may take together
+void VolumeRenderer::setTextureCacheBudget(int textureCacheBudget)
+{
+    _volumeTextureCacheBudget = static_cast<size_t>(std::max(textureCacheBudget, 0)) * 1024 * 1024;
+    evictVolumeTextures();
+}
+
 void VolumeRenderer::updateMatrices()
 {
     QVector3D cameraPos = _camera.getPosition();
@@ -751,6 +1709,18 @@ void VolumeRenderer::prepareANN()
     std::vector<float> voxelData(dimensions * numVoxels);
     QPair<float, float> scalarDataRange;
     _volumeDataset->getVolumeData(_compositeIndices, voxelData, scalarDataRange);
+
+    // The queries are sampled from the dequantized atlas, so the index is built on the source values as well
+    if (!_componentQuantization.isEmpty() && _compositeIndices.size() == dimensions) {
+        std::vector<float> scale(dimensions), offset(dimensions);
+
+        for (uint32_t c = 0; c < dimensions; c++) {
+            scale[c] = _componentQuantization.scale[_compositeIndices[c]];
+            offset[c] = _componentQuantization.offset[_compositeIndices[c]];
+        }
+
+        VolumeQuantization::dequantizeComponents(voxelData.data(), static_cast<std::int64_t>(voxelData.size()), scale, offset);
+    }
 #ifdef USE_FAISS
     if (_useFaissANN) {
         _nlist = std::clamp(static_cast<int>(numVoxels / 1000), 32, 4096); // nlist is the number of clusters in Faiss
@@ -775,6 +1745,7 @@ void VolumeRenderer::prepareANN()
                 << "_efC" << _hnswEfConstruction
                 << "_dim" << dimensions
                 << "_voxNum" << numVoxels
+                << (_componentQuantization.isEmpty() ? "" : "_dequantized") // Indices of quantized point data built before they were dequantized hold the stored values
                 << ".bin";
             std::string indexPath = oss.str();
 
@@ -818,7 +1789,7 @@ void VolumeRenderer::prepareANN()
 // And it outputs the results into a vector of floats
 void VolumeRenderer::batchSearch(
     const std::vector<float>& queryData,    // Flat vector: each query is (dimensions) floats
-    std::vector<float>& positionData,       // The 2D position data for the queries
+    const std::vector<float>& positionData, // The 2D position data for the queries
     uint32_t dimensions,                    // Dimensionality of a single query
     int k,                                  // Number of nearest neighbors to retrieve
     bool useWeightedMean,                   // Use weighted mean for the query
@@ -1104,7 +2075,7 @@ void VolumeRenderer::retrieveBatchFullData(std::vector<float>& cpuOutput, int ba
     _frontfacesTexture.bind(1);
     _fullDataSamplerComputeShader->setUniformValue("frontFaces", 1);
 
-    _volumeTexture.bind(2);
+    _volumeTexture->bind(2);
     _fullDataSamplerComputeShader->setUniformValue("volumeData", 2);
 
     mv::Vector3f volumeSize;
@@ -1134,6 +2105,11 @@ void VolumeRenderer::retrieveBatchFullData(std::vector<float>& cpuOutput, int ba
     _fullDataSamplerComputeShader->setUniformValue("numIndices", static_cast<int>(_GPUBatches[batchIndex].size()));
     _fullDataSamplerComputeShader->setUniformValue("bricksNeeded", bricksNeeded);
 
+    const auto& dequantizeScale = _volumeDequantization.scale;
+    const auto& dequantizeOffset = _volumeDequantization.offset;
+    _fullDataSamplerComputeShader->setUniformValue("dequantizeScale", QVector4D(dequantizeScale[0], dequantizeScale[1], dequantizeScale[2], dequantizeScale[3]));
+    _fullDataSamplerComputeShader->setUniformValue("dequantizeOffset", QVector4D(dequantizeOffset[0], dequantizeOffset[1], dequantizeOffset[2], dequantizeOffset[3]));
+
     qDebug() << "Initialized compute shader with write memory size" << _subsetsMemory[batchIndex] / (1024 * 1024) << "MB";
     // Dispatch the compute shader, we launch one invocation per index;
     glDispatchCompute(_GPUBatches[batchIndex].size(), 1, 1);
@@ -1477,8 +2453,12 @@ void VolumeRenderer::updateRenderModeParameters()
         glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
         _tempNNMaterialVolume.release();
 
-        // Load the material position dataset into the texture.
-        loadNNVolumeToTexture(_tempNNMaterialVolume, _textureData, _materialPositionImage, _materialPositionDataset->getImageSize().width(), _volumeSize, _volumeDataset->getNumberOfVoxels(), true);
+        // Load the material ids of the voxels into the texture.
+        std::vector<float> materialIds;
+        loadMaterialIdVolumeData(materialIds);
+        _tempNNMaterialVolume.bind();
+        uploadMaterialIdVolumeLevel(_tempNNMaterialVolume, _volumeSize.x, _volumeSize.y, _volumeSize.z, materialIds, 0);
+        _tempNNMaterialVolume.release();
     }
 }
 
@@ -1512,10 +2492,8 @@ void VolumeRenderer::renderFullData()
     retrieveBatchFullData(cpuOutput, _fullDataModeBatch, true);
 
     // Retrieve the reduced 2D position data (e.g. from a dimension reduction dataset), they are needed for following computation ---
-    int pointAmount = _volumeDataset->getNumberOfVoxels() * 2; // two floats per voxel.
-    std::vector<float> positionData(pointAmount);
-    _reducedPosDataset->populateDataForDimensions(positionData, std::vector<int>{0, 1});
-    normalizePositionData(positionData);
+    // These are cached, so only the first batch after the positions changed pays for reading and normalizing them
+    const std::vector<float>& positionData = getNormalizedPositions(getPositionScale());
 
     // Run approximate nearest-neighbour search on the retrieved CPU data.
     uint32_t sampleDim = _volumeDataset->getComponentsPerVoxel();
@@ -1564,13 +2542,14 @@ void VolumeRenderer::renderComposite2DPos()
     _frontfacesTexture.bind(1);
     _2DCompositeShader.uniform1i("frontFaces", 1);
 
-    _volumeTexture.bind(2);
+    _volumeTexture->bind(2);
     _2DCompositeShader.uniform1i("volumeData", 2);
 
     _tfTexture.bind(3);
     _2DCompositeShader.uniform1i("tfTexture", 3);
 
-    _2DCompositeShader.uniform1f("stepSize", _stepSize);
+    _2DCompositeShader.uniform1f("stepSize", _resolutionStepSize);
+    setDequantizationUniforms(_2DCompositeShader);
 
     mv::Vector3f volumeSize;
     mv::Vector3f invVolumeSize;
@@ -1621,10 +2600,11 @@ void VolumeRenderer::renderCompositeColor()
     _frontfacesTexture.bind(1);
     _colorCompositeShader.uniform1i("frontFaces", 1);
 
-    _volumeTexture.bind(2);
+    _volumeTexture->bind(2);
     _colorCompositeShader.uniform1i("volumeData", 2);
 
-    _colorCompositeShader.uniform1f("stepSize", _stepSize);
+    _colorCompositeShader.uniform1f("stepSize", _resolutionStepSize);
+    setDequantizationUniforms(_colorCompositeShader);
 
     mv::Vector3f volumeSize;
     mv::Vector3f invVolumeSize;
@@ -1680,10 +2660,11 @@ void VolumeRenderer::render1DMip()
     _frontfacesTexture.bind(1);
     _1DMipShader.uniform1i("frontFaces", 1);
 
-    _volumeTexture.bind(2);
+    _volumeTexture->bind(2);
     _1DMipShader.uniform1i("volumeData", 2);
 
-    _1DMipShader.uniform1f("stepSize", _stepSize);
+    _1DMipShader.uniform1f("stepSize", _resolutionStepSize);
+    setDequantizationUniforms(_1DMipShader);
     _1DMipShader.uniform1f("volumeMaxValue", _scalarVolumeDataRange.second);
     _1DMipShader.uniform1i("chosenDim", _mipDimension);
 
@@ -1733,7 +2714,7 @@ void VolumeRenderer::renderMaterialTransition2D()
     _frontfacesTexture.bind(1);
     _materialTransition2DShader.uniform1i("frontFaces", 1);
 
-    _volumeTexture.bind(2);
+    _volumeTexture->bind(2);
     _materialTransition2DShader.uniform1i("volumeData", 2);
 
     _materialPositionTexture.bind(3);
@@ -1742,7 +2723,8 @@ void VolumeRenderer::renderMaterialTransition2D()
     _materialTransitionTexture.bind(4);
     _materialTransition2DShader.uniform1i("materialTexture", 4);
 
-    _materialTransition2DShader.uniform1f("stepSize", _stepSize);
+    _materialTransition2DShader.uniform1f("stepSize", _resolutionStepSize);
+    setDequantizationUniforms(_materialTransition2DShader);
 
     _materialTransition2DShader.uniform1i("useShading", _useShading);
     _materialTransition2DShader.uniform1f("useClutterRemover", _useClutterRemover);
@@ -1797,13 +2779,13 @@ void VolumeRenderer::renderNNMaterialTransition()
     _frontfacesTexture.bind(1);
     _nnMaterialTransitionShader.uniform1i("frontFaces", 1);
 
-    _volumeTexture.bind(2);
+    _volumeTexture->bind(2);
     _nnMaterialTransitionShader.uniform1i("volumeData", 2);
 
     _materialTransitionTexture.bind(3);
     _nnMaterialTransitionShader.uniform1i("materialTexture", 3);
 
-    _nnMaterialTransitionShader.uniform1f("stepSize", _stepSize);
+    _nnMaterialTransitionShader.uniform1f("stepSize", _resolutionStepSize);
     _nnMaterialTransitionShader.uniform1f("useClutterRemover", _useClutterRemover);
     _nnMaterialTransitionShader.uniform1i("useShading", _useShading);
     _nnMaterialTransitionShader.uniform3fv("camPos", 1, &_cameraPos);
@@ -1856,7 +2838,7 @@ void VolumeRenderer::renderAltNNMaterialTransition()
     _frontfacesTexture.bind(1);
     _altNNMaterialTransitionShader.uniform1i("frontFaces", 1);
 
-    _volumeTexture.bind(2);
+    _volumeTexture->bind(2);
     _altNNMaterialTransitionShader.uniform1i("volumeData", 2);
 
     _materialTransitionTexture.bind(3);
@@ -1922,6 +2904,7 @@ void VolumeRenderer::render()
             updataDataTexture();
             _dataSettingsChanged = false;
         }
+        updateResolutionLevel();
         if (_renderMode == RenderMode::MaterialTransition_FULL || _renderMode == RenderMode::MULTIDIMENSIONAL_COMPOSITE_FULL)
             renderFullData();
         else if (_renderMode == RenderMode::MaterialTransition_2D)
@@ -1961,5 +2944,16 @@ void VolumeRenderer::destroy()
     _iboCube.destroy();
     _surfaceShader.destroy();
     _textureShader.destroy();
+
+    for (auto& [group, entry] : _volumeTextureCache)
+        entry.texture->destroy();
+    _volumeTextureCache.clear();
+    _volumeTexture = nullptr;
+
+    _positionVolumeTexture.destroy();
+    delete _tfVolumeComputeShader;
+    _tfVolumeComputeShader = nullptr;
+    delete _materialIdVolumeComputeShader;
+    _materialIdVolumeComputeShader = nullptr;
 }
 
@@ -15,11 +15,25 @@
 #include <QOpenGLTexture>
 #include <QOpenGLFramebufferObject>
 #include <QOpenGLShaderProgram>
+#include <QFloat16>
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <functional>
+#include <initializer_list>
+#include <map>
+#include <memory>
 #include <vector>
 #include <VolumeData/Volumes.h>
 #include <ImageData/Images.h>
 #include <PointData/PointData.h>
 #include "MCArrays.h"
+#include "VolumePyramid.h"
+#include "VolumeQuantization.h"
+#include "PositionNormalization.h"
+
+#include <SparseVolume.h>
+#include <VolumeResampling.h>
 
 #include <hnswlib.h>
 #ifdef USE_FAISS
@@ -46,19 +60,164 @@ namespace mv {
             release();
         }
 
-        void setData(int width, int height, int depth, std::vector<float> _textureData, int voxelDimensions) {
-            if(voxelDimensions == 1)
-                glTexImage3D(GL_TEXTURE_3D, 0, GL_R32F, width, height, depth, 0, GL_RED, GL_FLOAT, _textureData.data());
-            else if (voxelDimensions == 2)
-                glTexImage3D(GL_TEXTURE_3D, 0, GL_RG32F, width, height, depth, 0, GL_RG, GL_FLOAT, _textureData.data());
-            else if (voxelDimensions == 3)
-                glTexImage3D(GL_TEXTURE_3D, 0, GL_RGB32F, width, height, depth, 0, GL_RGB, GL_FLOAT, _textureData.data());
-            else if (voxelDimensions == 4)
-                glTexImage3D(GL_TEXTURE_3D, 0, GL_RGBA32F, width, height, depth, 0, GL_RGBA, GL_FLOAT, _textureData.data());
-            else
+        // Uploads the data to the given mip level, level 0 is the full resolution volume
+        void setData(int width, int height, int depth, const std::vector<float>& _textureData, int voxelDimensions, int level = 0) {
+            const std::size_t sliceValues = static_cast<std::size_t>(width) * height * voxelDimensions;
+            streamData(width, height, depth, voxelDimensions, GL_FLOAT, level, [&](void* slab, int z, int slabDepth) {
+                std::memcpy(slab, _textureData.data() + z * sliceValues, slabDepth * sliceValues * sizeof(float));
+            });
+        }
+
+        // Uploads data of the given pixel type, the internal format follows it: 
+        // GL_FLOAT to R32F-RGBA32F, GL_HALF_FLOAT to R16F-RGBA16F, GL_UNSIGNED_SHORT to R16-RGBA16 (normalized) and GL_UNSIGNED_BYTE to R8-RGBA8 (normalized)
+        // A null data pointer only allocates the level
+        void setData(int width, int height, int depth, const void* data, int voxelDimensions, GLenum pixelType, int level = 0) {
+            static const GLenum floatFormats[4] = { GL_R32F, GL_RG32F, GL_RGB32F, GL_RGBA32F };
+            static const GLenum halfFloatFormats[4] = { GL_R16F, GL_RG16F, GL_RGB16F, GL_RGBA16F };
+            static const GLenum unorm16Formats[4] = { GL_R16, GL_RG16, GL_RGB16, GL_RGBA16 };
+            static const GLenum unorm8Formats[4] = { GL_R8, GL_RG8, GL_RGB8, GL_RGBA8 };
+
+            if (voxelDimensions < 1 || voxelDimensions > 4) {
                 qCritical() << "Unsupported voxel dimensions";
+                return;
+            }
+
+            const GLenum* internalFormats = floatFormats;
+            if (pixelType == GL_HALF_FLOAT)
+                internalFormats = halfFloatFormats;
+            else if (pixelType == GL_UNSIGNED_SHORT)
+                internalFormats = unorm16Formats;
+            else if (pixelType == GL_UNSIGNED_BYTE)
+                internalFormats = unorm8Formats;
+
+            // Rows of 8 and 16 bit texels are not necessarily 4-byte aligned
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+            glTexImage3D(GL_TEXTURE_3D, level, internalFormats[voxelDimensions - 1], width, height, depth, 0, getPixelFormat(voxelDimensions), pixelType, data);
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        }
+
+        // Allocates a level of single channel unsigned integer texels, GL_UNSIGNED_BYTE gives R8UI and GL_UNSIGNED_SHORT R16UI.
+        // These are sampled with a usampler3D and can only be filtered with GL_NEAREST
+        void setIntegerData(int width, int height, int depth, const void* data, GLenum pixelType, int level = 0) {
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+            glTexImage3D(GL_TEXTURE_3D, level, pixelType == GL_UNSIGNED_BYTE ? GL_R8UI : GL_R16UI, width, height, depth, 0, GL_RED_INTEGER, pixelType, data);
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        }
+
+        // Allocates immutable storage for all levels at once, which compute passes then write through image stores.
+        // Immutable storage can not be reallocated, so a texture that needs another size or format has to be recreated first (see hasStorage).
+        void setStorage(int width, int height, int depth, GLenum internalFormat, int numLevels) {
+            glTexStorage3D(GL_TEXTURE_3D, numLevels, internalFormat, width, height, depth);
+            _storage = { width, height, depth, static_cast<int>(internalFormat), numLevels };
+        }
+
+        // Whether the texture has immutable storage at all, or storage with exactly the given size, format and number of levels
+        bool hasStorage() const {
+            return _storage[4] > 0;
+        }
+
+        bool hasStorage(int width, int height, int depth, GLenum internalFormat, int numLevels) const {
+            return _storage == std::array<int, 5>{ width, height, depth, static_cast<int>(internalFormat), numLevels };
+        }
+
+        // Replaces the texture by a new one without storage, with the parameters set by initialize
+        void recreate() {
+            destroy();
+            create();
+            initialize();
+            _storage = {};
+        }
+
+        // Allocates the level once and uploads it in slabs of slices through a ring of pixel buffer objects, no copy of the full level is made.
+        // fillSlab writes the texels of the slices [z, z + slabDepth) to the mapped buffer while the GPU copies the previous slabs into the texture.
+        void streamData(int width, int height, int depth, int voxelDimensions, GLenum pixelType, int level, const std::function<void(void* slab, int z, int slabDepth)>& fillSlab) {
+            setData(width, height, depth, nullptr, voxelDimensions, pixelType, level);
+            streamSlabs(width, height, depth, getPixelFormat(voxelDimensions), pixelType, static_cast<std::size_t>(std::clamp(voxelDimensions, 1, 4)) * getChannelSize(pixelType), level, fillSlab);
+        }
+
+        // Same as streamData for a level of single channel unsigned integer texels, see setIntegerData
+        void streamIntegerData(int width, int height, int depth, GLenum pixelType, int level, const std::function<void(void* slab, int z, int slabDepth)>& fillSlab) {
+            setIntegerData(width, height, depth, nullptr, pixelType, level);
+            streamSlabs(width, height, depth, GL_RED_INTEGER, pixelType, getChannelSize(pixelType), level, fillSlab);
+        }
+
+        static GLenum getPixelFormat(int voxelDimensions) {
+            static const GLenum pixelFormats[4] = { GL_RED, GL_RG, GL_RGB, GL_RGBA };
+            return pixelFormats[std::clamp(voxelDimensions, 1, 4) - 1];
         }
 
+        // Number of bytes per channel of the given pixel type
+        static std::size_t getChannelSize(GLenum pixelType) {
+            if (pixelType == GL_HALF_FLOAT || pixelType == GL_UNSIGNED_SHORT)
+                return 2;
+            if (pixelType == GL_UNSIGNED_BYTE)
+                return 1;
+            return sizeof(float);
+        }
+
+    private:
+        // Uploads an allocated level slab by slab. The ring only lives for the upload, such that textures do not each keep up to
+        // _numUploadBuffers * _maxSlabSize bytes of buffers around; deleting them right away is safe, since OpenGL defers it until the copies are done.
+        void streamSlabs(int width, int height, int depth, GLenum pixelFormat, GLenum pixelType, std::size_t texelSize, int level, const std::function<void(void* slab, int z, int slabDepth)>& fillSlab) {
+            const std::size_t sliceSize = static_cast<std::size_t>(width) * height * texelSize;
+
+            if (sliceSize == 0 || depth <= 0)
+                return;
+
+            const int slabDepth = std::clamp(static_cast<int>(_maxSlabSize / sliceSize), 1, depth);
+            const GLsizeiptr slabSize = static_cast<GLsizeiptr>(sliceSize * slabDepth);
+
+            std::array<GLuint, _numUploadBuffers> uploadBuffers = {};        // Pixel buffer objects the slabs are streamed through
+            std::array<bool, _numUploadBuffers> isAllocated = {};
+            std::array<GLsync, _numUploadBuffers> uploadFences = {};         // Signalled once the GPU has copied the slab out of the buffer
+
+            glGenBuffers(_numUploadBuffers, uploadBuffers.data());
+
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+            for (int z = 0, slab = 0; z < depth; z += slabDepth, slab++) {
+                const int ring = slab % _numUploadBuffers;
+                const int currentDepth = std::min(slabDepth, depth - z);
+
+                // The buffer can only be refilled once the GPU has copied its previous slab into a texture
+                if (uploadFences[ring]) {
+                    glClientWaitSync(uploadFences[ring], GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+                    glDeleteSync(uploadFences[ring]);
+                    uploadFences[ring] = nullptr;
+                }
+
+                glBindBuffer(GL_PIXEL_UNPACK_BUFFER, uploadBuffers[ring]);
+                if (!isAllocated[ring]) {
+                    glBufferData(GL_PIXEL_UNPACK_BUFFER, slabSize, nullptr, GL_STREAM_DRAW);
+                    isAllocated[ring] = true;
+                }
+
+                void* mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, static_cast<GLsizeiptr>(sliceSize * currentDepth), GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+                if (!mapped) {
+                    qCritical() << "Failed to map the volume upload buffer";
+                    break;
+                }
+
+                fillSlab(mapped, z, currentDepth);
+                glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+
+                // With a bound unpack buffer the data pointer is an offset into the buffer
+                glTexSubImage3D(GL_TEXTURE_3D, level, 0, 0, z, width, height, currentDepth, pixelFormat, pixelType, nullptr);
+                uploadFences[ring] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+            }
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+            for (const auto fence : uploadFences)
+                if (fence)
+                    glDeleteSync(fence);
+
+            glDeleteBuffers(_numUploadBuffers, uploadBuffers.data());
+        }
+
+        static constexpr int _numUploadBuffers = 3;                         // Slabs in flight, one is filled while the GPU copies the others
+        static constexpr std::size_t _maxSlabSize = 16 * 1024 * 1024;       // Size of a slab in bytes, a single slice can exceed it
+
+        std::array<int, 5> _storage = {};                                   // Width, height, depth, internal format and levels of the immutable storage, all zero without it
     };
 }
 
@@ -75,6 +234,14 @@ enum RenderMode {
     MaterialTransition_FULL
 };
 
+// Storage format of the volume texture, the normalized formats quantize every channel to its value range
+enum TexturePrecision {
+    FLOAT32,
+    FLOAT16,
+    UNORM16,
+    UNORM8
+};
+
 class VolumeRenderer : protected QOpenGLFunctions_4_3_Core
 {
 public:
@@ -99,11 +266,33 @@ public:
 
     void setRenderCubeSize(float renderCubeSize);
 
-    void loadNNVolumeToTexture(mv::Texture3D& targetVolume, std::vector<float>& textureData, QVector<float>& usedTFImage, int width, mv::Vector3f volumeSize, int pointAmount, bool singleValueTFTexture);
+    void setResolutionLevel(int resolutionLevel);
+    void setInteractionResolutionLevels(int interactionResolutionLevels);
+    void setInteracting(bool interacting);
+    void setTexturePrecision(const QString& texturePrecision);
+    void setColorPrecision(const QString& colorPrecision);
+    void compareColorPrecision();
+    void setTextureCacheBudget(int textureCacheBudget);
+
+    void loadNNVolumeData(std::vector<float>& textureData, QVector<float>& usedTFImage, int width, int pointAmount);
+    void loadMaterialIdVolumeData(std::vector<float>& materialIds);
 
     void updataDataTexture();
 
     mv::Vector3f getVolumeSize() { return _volumeSize; }
+
+    // Whether the volume texture of the current render mode fits in the GPU memory and the maximum 3D texture size, setData ignores volumes that do not.
+    // numComponents is the number of components the full data modes pack into their atlas, the other modes upload a fixed number of channels.
+    bool fitsOnGPU(const mv::Dataset<Volumes>& dataset, int numComponents) const;
+
+    // Number of bytes a voxel takes in the textures the current render mode uploads
+    size_t getBytesPerVoxel(int numComponents) const;
+
+    // Number of bytes the full resolution level of the volume texture may take, the coarser levels and the other GPU data are kept out of it
+    size_t getVolumeMemoryBudget() const;
+
+    // Largest size of a volume region whose texture for the current render mode fits in the GPU memory and the maximum 3D texture size, used to resample volumes that do not fit
+    void computeFittingVolumeSize(const VolumeResampling::Region& region, int numComponents, std::int32_t targetSize[3]) const;
     bool getFullRenderModeInProgress() { return _fullDataModeBatch != -1; }
 
     void init();
@@ -124,7 +313,7 @@ private:
 
     // Full data render mode methods
     void prepareANN();
-    void batchSearch(const std::vector<float>& queryData, std::vector<float>& positionData, uint32_t dimensions, int k, bool useWeightedMean, std::vector<float>& meanPositionData);
+    void batchSearch(const std::vector<float>& queryData, const std::vector<float>& positionData, uint32_t dimensions, int k, bool useWeightedMean, std::vector<float>& meanPositionData);
     void getFacesTextureData(std::vector<float>& frontfacesData, std::vector<float>& backfacesData);
     void getGPUFullDataModeBatches(std::vector<float>& frontfacesData, std::vector<float>& backfacesData);
     void retrieveBatchFullData(std::vector<float>& cpuOutput, int batchIndex, bool deleteBuffers);
@@ -141,10 +330,48 @@ private:
     void renderNNMaterialTransition();
     void renderAltNNMaterialTransition();
 
-    void normalizePositionData(std::vector<float>& positionData);
+    float getPositionScale() const;
+    TexturePrecision getPositionPrecision() const;
+    const std::vector<float>& getNormalizedPositions(float scale);
+    bool getStoredComponentRange(const std::vector<std::uint32_t>& components, QPair<float, float>& range) const;
+    void dequantizeComponentRange(const std::vector<std::uint32_t>& components, QPair<float, float>& range) const;
+    void dequantizeAtlasData(const std::vector<std::uint32_t>& components);
 
+    void updateComponentQuantization();
+    void updateBrickOccupancy();
     void updateRenderCubes();
 
+    // Volume texture upload methods
+    void uploadVolumeTexture(int numComponents, TexturePrecision precision);
+    void uploadVolumeTextureLevel(int width, int height, int depth, const std::vector<float>& data, int numComponents, int level);
+    GLenum getVolumePixelType() const;
+    void convertVolumeTexels(const float* data, std::int64_t numValues, int numComponents, void* texels) const;
+    void setDequantizationUniforms(mv::ShaderProgram& shader);
+
+    // Transfer function volume methods, the Color and NN modes bake the transfer function into the volume texture on the GPU
+    void updatePositionVolumeTexture();
+    bool computeTransferFunctionVolume(mv::Texture2D& lookupTexture, int lookupSize, QVector<float>& lookupImage, TexturePrecision precision, VolumePyramid::Filter filter);
+    void dispatchVolumeCompute(QOpenGLShaderProgram& shader, GLenum imageFormat, int numLevels);
+
+    // Material id volume methods, the NN material transition modes store one integer material id per voxel
+    void updateMaterialIdVolumeTexture();
+    void uploadMaterialIdVolumeLevel(mv::Texture3D& texture, int width, int height, int depth, const std::vector<float>& materialIds, int level);
+    bool computeMaterialIdVolume();
+
+    // Volume texture cache methods
+    static int getRenderModeGroup(RenderMode mode);
+    static VolumePyramid::Filter getColorPyramidFilter(RenderMode mode);
+    bool activateVolumeTexture(int group);
+    void invalidateVolumeTextures(std::initializer_list<int> groups);
+    void invalidateVolumeTextures();
+    void evictVolumeTextures();
+    void updateVolumeTextureFilter();
+
+    // Multi-resolution methods
+    void updateVolumeTexturePyramid(int numComponents, VolumePyramid::Filter filter, int maxLevels);
+    int computeFootprintResolutionLevel();
+    void updateResolutionLevel();
+
 private:
     RenderMode                  _renderMode;          /* Render mode options*/
     int                         _mipDimension;
@@ -161,6 +388,9 @@ private:
     mv::ShaderProgram _fullDataCompositeShader;
     mv::ShaderProgram _fullDataMaterialTransitionShader;
     QOpenGLShaderProgram* _fullDataSamplerComputeShader; // This has a different type since mv::ShaderProgram does not support compute shaders
+    QOpenGLShaderProgram* _tfVolumeComputeShader = nullptr; // Bakes the transfer function into the volume texture, null when compute shaders are not available
+    QOpenGLShaderProgram* _materialIdVolumeComputeShader = nullptr; // Looks up the material ids of the voxels, null when compute shaders are not available
+    GLenum _materialIdPixelType = GL_UNSIGNED_BYTE; // GL_UNSIGNED_BYTE (R8UI) or GL_UNSIGNED_SHORT (R16UI), depending on the largest material id
 
     mv::Vector3f _minClippingPlane;
     mv::Vector3f _maxClippingPlane;
@@ -178,9 +408,51 @@ private:
     bool _useShading = false;
     bool _ANNAlgorithmTrained = false; 
 
-    // (WIP) Originally this was used for empty space skipping, but it wasn't fully implemented and now this part is left in solly for the purpose having the camera kind of work inside the volume
+    // Multi-resolution parameters, the coarser levels of the volume texture are stored as its mip levels
+    static constexpr int _maxResolutionLevels = 4;  // Full, half, quarter and eighth resolution
+    int _volumeTextureLevels = 1;                   // Number of levels currently stored in the volume texture
+    VolumePyramid::Filter _volumeTexturePyramidFilter = VolumePyramid::Filter::Nearest;   // Filter the coarser levels of the current volume texture were built with
+    int _resolutionLevel = -1;                      // Requested level, -1 selects the level from the screen-space voxel footprint
+    int _interactionResolutionLevels = 1;           // Number of coarser levels used while the camera is being moved
+    int _activeResolutionLevel = 0;                 // Level that is currently set as the base level of the volume texture
+    bool _isInteracting = false;
+    float _resolutionStepSize = 0.5f;               // Step size scaled to the voxel size of the active level
+
+    // Quantization parameters
+    TexturePrecision _texturePrecision = TexturePrecision::FLOAT32;         // Requested precision of the volume texture
+    TexturePrecision _colorPrecision = TexturePrecision::FLOAT32;           // Requested precision of the baked transfer function colors of the Color and NN composite modes
+    TexturePrecision _volumeTexturePrecision = TexturePrecision::FLOAT32;   // Precision of the current volume texture, FLOAT32 for the R8UI/R16UI material ids, which need no dequantization
+    VolumeQuantization::Dequantization _volumeDequantization;               // Maps the texels of the current volume texture back to the data values
+    VolumeQuantization::ComponentQuantization _componentQuantization;       // Maps the stored values of quantized point data back to the source values, empty when the point data holds them
+
+    // Volume texture prepared for a group of render modes together with the state the render modes read, kept while other groups are rendered
+    struct VolumeTextureCacheEntry
+    {
+        std::unique_ptr<mv::Texture3D> texture;
+        size_t memorySize = 0;                      // Bytes taken by all levels of the texture, zero while it has not been filled
+        std::uint64_t lastUsed = 0;                 // Value of the cache clock when the group was last activated
+
+        mv::Vector3f textureSize;
+        int levels = 1;
+        VolumePyramid::Filter pyramidFilter = VolumePyramid::Filter::Nearest;
+        int activeResolutionLevel = 0;
+        TexturePrecision precision = TexturePrecision::FLOAT32;
+        VolumeQuantization::Dequantization dequantization;
+        QPair<float, float> scalarDataRange;
+        size_t fullDataMemorySize = 0;
+    };
+
+    // Volume texture cache parameters, switching back to a cached group skips the rebuild and upload of its texture
+    std::map<int, VolumeTextureCacheEntry> _volumeTextureCache;                         // Entries by render mode group
+    int _volumeTextureGroup = 0;                                                        // Group of the current volume texture
+    std::uint64_t _volumeTextureCacheClock = 0;                                         // Incremented on every activation to order the entries by use
+    size_t _volumeTextureCacheBudget = static_cast<size_t>(2 * 1024 * 1024) * 1024;     // VRAM in bytes the cached textures may take, least recently used groups are evicted first
+
+    // Render cubes cover the volume and set where the rays start and end, cubes without occupied bricks are left out to skip empty space
     int _renderCubeSize = 20;
     int _renderCubeAmount = 1;
+    std::vector<mv::Vector3f> _renderCubePositions;     // Cube offsets in the cube grid of the drawn cubes
+    SparseVolume::BrickOccupancy _brickOccupancy;       // Occupied bricks of a point-derived volume, empty (invalid) for dense volumes
 
     mv::Texture2D _frontfacesTexture;
     mv::Texture2D _backfacesTexture;
@@ -191,12 +463,21 @@ private:
     mv::Texture2D _tfTexture;                   //2D texture containing the transfer function
     mv::Texture2D _materialTransitionTexture;   //2D texture containing the material transition texture
     mv::Texture2D _materialPositionTexture;     //2D texture containing the material position texture
-    mv::Texture3D _volumeTexture;               //3D texture containing the volume data
+    mv::Texture3D* _volumeTexture = nullptr;    //3D texture containing the volume data, owned by the entry of the current render mode group in the volume texture cache
+
+    mv::Texture3D _positionVolumeTexture;       //3D texture containing the normalized [0, 1] DR positions of the voxels, with the same levels as the volume texture
+    bool _positionVolumeChanged = true;         // Whether the position texture has to be rebuilt, as the volume or the DR positions changed
+
+    std::uint64_t _reducedPosDataVersion = 0;       // Incremented every time the DR positions are set or changed
+    QString _normalizedPositionsDatasetId;          // Id of the DR dataset the normalized positions were computed from
+    std::uint64_t _normalizedPositionsVersion = 0;  // Version of the DR positions the normalized positions were computed from
+    std::vector<float> _unitPositions;              // DR positions normalized to [0, 1], shared by all render modes
+    std::vector<float> _scaledPositions;            // DR positions normalized to [0, _scaledPositionsScale] for the lookup texture of the last used render mode
+    float _scaledPositionsScale = -1.0f;
 
     mv::Texture3D _tempNNMaterialVolume; // Temporary texture used for the NN material transition rendering, it is used to store the material volume data that is used to clean up noisy material transitions
 
     // IDs for the render cube buffers
-    // (WIP) Originally this was used for empty space skipping, but it wasn't fully implemented and now this part is left in solly for the purpose having the camera kind of work inside the volume
     GLuint _renderCubePositionsBufferID;
     GLuint _renderCubePositionsTexID;
 
@@ -230,12 +511,15 @@ private:
     QPair<float, float> _scalarVolumeDataRange;
     QPair<float, float> _scalarImageDataRange;
     QVector<float> _tfImage;                        // storage for the transfer function data
+    QSize _tfImageSize;                             // Size of the transfer function, the positions of the 2D position mode are normalized to it
     QVector<float> _materialPositionImage;          // storage for the material transfer function data
     std::vector<float> _textureData;                // Storage for the volume data, currently used as a temporary storage for the volume data that is loaded into the texture (The fullDataRenderMode will use it for some auxiliary data so it won't reliably actually contain the current value there)
     float _stepSize = 0.5f;
     mv::Vector3f _cameraPos;
 
+    GLint _maxTextureSize = 2048; // Maximum number of voxels along an axis of a 3D texture, queried once OpenGL is initialized (2048 is the minimum OpenGL 4.3 guarantees)
     size_t _fullDataMemorySize = 0; // The size of the full data in bytes
+    size_t _gpuMemorySize = static_cast<size_t>(4 * 1024 * 1024) * 1024; // Dedicated video memory in bytes, queried once OpenGL is initialized when the driver exposes it
     size_t _fullGPUMemorySize = static_cast<size_t>(2 * 1024 * 1024) * 1024; // The size of the full data in bytes on the GPU if we use normal int it causes a overflow; The SSBOs are limited to 2GB, so even if the GPU has more VRAM we limit the size to 2GB for the full data mode.
 
     // ANN-related members  
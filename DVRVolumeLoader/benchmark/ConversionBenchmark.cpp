@@ -0,0 +1,89 @@
+// Measures the throughput of VolumeConversion::convertElements for every raw source type (u8, u16, f32) and point data element type pair.
+// Usage: ConversionBenchmark [number of elements] [number of runs], the best run of each pair is reported in GB/s of source data read.
+
+#include "VolumeConversion.h"
+
+#include <PointData/PointData.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <tuple>
+#include <vector>
+
+#include <OpenMPSupport.h>
+
+namespace {
+
+template <typename T>
+std::vector<char> makeSource(std::int64_t numElements)
+{
+    std::vector<T> values(numElements);
+
+    for (std::int64_t i = 0; i < numElements; i++)
+        values[i] = static_cast<T>(i % 251);
+
+    std::vector<char> source(numElements * sizeof(T));
+    std::copy(reinterpret_cast<const char*>(values.data()), reinterpret_cast<const char*>(values.data()) + source.size(), source.begin());
+
+    return source;
+}
+
+template <typename T, typename S>
+double measure(const std::vector<char>& source, std::int64_t numElements, int numRuns)
+{
+    std::vector<S> destination(numElements);
+
+    // The first run also faults in the destination pages, so it is not counted
+    VolumeConversion::convertElements<T, S>(source.data(), destination.data(), numElements);
+
+    double bestSeconds = 1e30;
+
+    for (int run = 0; run < numRuns; run++)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        VolumeConversion::convertElements<T, S>(source.data(), destination.data(), numElements);
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        bestSeconds = std::min(bestSeconds, elapsed.count());
+    }
+
+    return static_cast<double>(numElements) * sizeof(T) / std::max(bestSeconds, 1e-9) / 1e9;
+}
+
+template <typename T, unsigned N = 0>
+void measureElementTypes(const char* sourceName, std::int64_t numElements, int numRuns)
+{
+    if constexpr (N < PointData::getNumberOfSupportedElementTypes())
+    {
+        using S = PointData::ElementTypeAt<N>;
+
+        const auto source = makeSource<T>(numElements);
+
+        std::printf("%-4s -> %-10s %8.2f GB/s\n", sourceName, std::get<N>(PointData::getElementTypeNames()), measure<T, S>(source, numElements, numRuns));
+
+        measureElementTypes<T, N + 1>(sourceName, numElements, numRuns);
+    }
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+    const std::int64_t numElements  = argc > 1 ? std::atoll(argv[1]) : (std::int64_t(1) << 27);
+    const int numRuns               = argc > 2 ? std::max(1, std::atoi(argv[2])) : 5;
+
+#ifdef _OPENMP
+    std::printf("%lld elements, best of %d runs, %d threads\n", static_cast<long long>(numElements), numRuns, omp_get_max_threads());
+#else
+    std::printf("%lld elements, best of %d runs, single thread\n", static_cast<long long>(numElements), numRuns);
+#endif
+
+    measureElementTypes<std::uint8_t>("u8", numElements, numRuns);
+    measureElementTypes<std::uint16_t>("u16", numElements, numRuns);
+    measureElementTypes<float>("f32", numElements, numRuns);
+
+    return 0;
+}
@@ -1,155 +1,1318 @@
 #include "DVRVolumeLoader.h"
+#include "TimeSeries.h"
+#include "VolumeCache.h"
+#include "VolumeConversion.h"
+#include "Voxelizer.h"
+
+#include <BrickedVolume.h>
+#include <ResampledVolume.h>
+#include <SparseVolume.h>
+
+#ifdef USE_HDF5
+#include "HDF5Reader.h"
+#endif
 
 #include <PointData/PointData.h>
 
 
-#include <Set.h>
+#include <Set.h>
+#include <util/Exception.h>
+
+#include <QtCore>
+#include <QtDebug>
+#include <QFutureWatcher>
+#include <QScopeGuard>
+#include <QtConcurrent>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <numeric>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+Q_PLUGIN_METADATA(IID "nl.tudelft.DVRVolumeLoader")
+
+using namespace mv;
+using namespace mv::gui;
+using namespace mv::util;
+
+// =============================================================================
+// View
+// =============================================================================
+
+DVRVolumeLoader::~DVRVolumeLoader(void)
+{
+
+}
+
+void DVRVolumeLoader::init()
+{
+
+}
+
+namespace {
+
+// Reports the load progress in the range [0, 1], returns false when the load should be cancelled
+using ProgressCallback = std::function<bool(float)>;
+
+// Number of points that are scattered between progress updates
+constexpr std::int64_t voxelizeChunkSize = 1 << 22;
+
+// Converts voxels of numDims raw elements into point data elements, or quantizes them into the full range of S when component ranges are given (integer types only).
+// When a component selection is given only those components are gathered, the ranges and statistics are then indexed by the position in the selection.
+// The range, sum and count of the values are gathered into the statistics in the same pass.
+template <typename T, typename S>
+void convertOrQuantizeVoxels(const char* source, S* destination, std::int64_t numVoxels, int32_t numDims, const std::vector<int>& selection, const VolumeConversion::ComponentRanges* ranges, bool swapBytes, VolumeConversion::ComponentStatistics& statistics)
+{
+    if (!selection.empty())
+    {
+        VolumeConversion::gatherComponents<T, S>(source, destination, numVoxels, numDims, selection, swapBytes, ranges, &statistics);
+        return;
+    }
+
+    const auto numElements = numVoxels * numDims;
+
+    if constexpr (std::is_integral_v<S>)
+    {
+        if (ranges != nullptr)
+        {
+            VolumeConversion::quantizeElements<T, S>(source, destination, numElements, *ranges, swapBytes, &statistics);
+            return;
+        }
+    }
+
+    VolumeConversion::convertElements<T, S>(source, destination, numElements, swapBytes, &statistics);
+}
+
+// Parses a comma separated list of component indices and inclusive index ranges, such as "0-7, 12".
+// An empty list (or one that selects all components in order) gives an empty selection, which loads every component.
+std::vector<int> parseComponentSelection(const QString& text, int32_t numComponents)
+{
+    std::vector<int> selection;
+
+    for (const auto& part : text.split(',', Qt::SkipEmptyParts))
+    {
+        const auto bounds = part.trimmed().split('-');
+
+        bool firstValid = false, lastValid = false;
+        const int first = bounds.first().trimmed().toInt(&firstValid);
+        const int last = bounds.size() == 2 ? bounds.last().trimmed().toInt(&lastValid) : first;
+
+        if (!firstValid || (bounds.size() == 2 && !lastValid) || bounds.size() > 2 || first > last)
+            throw std::runtime_error(QString("Component selection \"%1\" is not a list of indices and ranges such as \"0-7, 12\".").arg(part.trimmed()).toStdString());
+
+        if (first < 0 || last >= numComponents)
+            throw std::runtime_error(QString("Component selection \"%1\" is out of range, the file has %2 components.").arg(part.trimmed()).arg(numComponents).toStdString());
+
+        for (int component = first; component <= last; component++)
+            selection.push_back(component);
+    }
+
+    bool isEverything = static_cast<int32_t>(selection.size()) == numComponents;
+
+    for (std::size_t k = 0; k < selection.size() && isEverything; k++)
+        isEverything = selection[k] == static_cast<int>(k);
+
+    if (isEverything)
+        selection.clear();
+
+    return selection;
+}
+
+// Parses the region of a volume that is resampled from inclusive voxel ranges per axis, such as "0-255, 0-255, 100-199".
+// An empty text gives the whole volume.
+VolumeResampling::Region parseCropRegion(const QString& text, const Size3D& volumeSize)
+{
+    auto region = VolumeResampling::getFullRegion(volumeSize.width(), volumeSize.height(), volumeSize.depth());
+
+    if (text.isEmpty())
+        return region;
+
+    const auto parts = text.split(',');
+
+    if (parts.size() != 3)
+        throw std::runtime_error(QString("Crop region \"%1\" is not a voxel range per axis such as \"0-255, 0-255, 100-199\".").arg(text).toStdString());
+
+    const std::int32_t size[3] = { volumeSize.width(), volumeSize.height(), volumeSize.depth() };
+
+    for (int axis = 0; axis < 3; axis++)
+    {
+        const auto bounds = parts[axis].trimmed().split('-');
+
+        bool firstValid = false, lastValid = false;
+        const int first = bounds.first().trimmed().toInt(&firstValid);
+        const int last = bounds.size() == 2 ? bounds.last().trimmed().toInt(&lastValid) : -1;
+
+        if (!firstValid || !lastValid || bounds.size() != 2 || first > last)
+            throw std::runtime_error(QString("Crop region \"%1\" is not a voxel range such as \"0-255\".").arg(parts[axis].trimmed()).toStdString());
+
+        if (first < 0 || last >= size[axis])
+            throw std::runtime_error(QString("Crop region \"%1\" is out of range, the volume has %2 voxels along that axis.").arg(parts[axis].trimmed()).arg(size[axis]).toStdString());
+
+        region.begin[axis]  = first;
+        region.end[axis]    = last + 1;
+    }
+
+    return region;
+}
+
+// Fills the histograms of the statistics from the stored point data elements, once their ranges are complete.
+// Quantized elements are mapped back to their original values with the dequantization of the ranges.
+template <typename S>
+void updateHistograms(const std::vector<S>& data, const VolumeConversion::ComponentRanges* ranges, VolumeConversion::ComponentStatistics& statistics)
+{
+    const int numComponents = statistics.getNumberOfComponents();
+
+    std::vector<double> scale(numComponents, 1.0), offset(numComponents, 0.0);
+
+    if constexpr (std::is_integral_v<S>)
+    {
+        if (ranges != nullptr)
+            for (int c = 0; c < numComponents; c++)
+                VolumeConversion::getDequantization<S>(*ranges, c, scale[c], offset[c]);
+    }
+
+    VolumeConversion::updateHistograms<S>(data.data(), static_cast<std::int64_t>(data.size()), statistics, scale, offset);
+}
+
+// Gathers the statistics of point data elements that are already in memory, for data that is not converted on load
+template <typename S>
+void computeStatistics(const std::vector<S>& data, VolumeConversion::ComponentStatistics& statistics)
+{
+    VolumeConversion::updateStatistics<S>(data.data(), static_cast<std::int64_t>(data.size()), statistics);
+    updateHistograms<S>(data, nullptr, statistics);
+}
+
+// Gathers the statistics of quantized point data elements in the units of the source values: value = stored * scale + offset, per component
+template <typename S>
+void computeDequantizedStatistics(const std::vector<S>& data, const std::vector<double>& scale, const std::vector<double>& offset, VolumeConversion::ComponentStatistics& statistics)
+{
+    VolumeConversion::updateStatistics<S>(data.data(), static_cast<std::int64_t>(data.size()), statistics);
+
+    // The scales are positive, so the mapped ranges stay in order
+    for (int c = 0; c < statistics.getNumberOfComponents(); c++)
+    {
+        statistics.ranges.minimum[c]    = statistics.ranges.minimum[c] * scale[c] + offset[c];
+        statistics.ranges.maximum[c]    = statistics.ranges.maximum[c] * scale[c] + offset[c];
+        statistics.sum[c]               = statistics.sum[c] * scale[c] + offset[c] * static_cast<double>(statistics.count[c]);
+    }
+
+    VolumeConversion::updateHistograms<S>(data.data(), static_cast<std::int64_t>(data.size()), statistics, scale, offset);
+}
+
+// Takes the statistics that were exported with a bricked volume, the histogram of a component counts all of its values that are not NaN
+void readHeaderStatistics(const BrickedVolume::Header& header, VolumeConversion::ComponentStatistics& statistics)
+{
+    statistics = VolumeConversion::ComponentStatistics(static_cast<int>(header.numComponents));
+
+    for (std::uint32_t c = 0; c < header.numComponents; c++)
+    {
+        const auto& histogram = header.componentHistograms[c];
+
+        statistics.ranges.minimum[c]    = header.componentMinimum[c];
+        statistics.ranges.maximum[c]    = header.componentMaximum[c];
+        statistics.count[c]             = static_cast<std::int64_t>(std::accumulate(histogram.begin(), histogram.end(), quint64(0)));
+        statistics.sum[c]               = header.componentMean[c] * static_cast<double>(statistics.count[c]);
+
+        if (histogram.size() == statistics.histograms[c].size())
+            std::copy(histogram.begin(), histogram.end(), statistics.histograms[c].begin());
+    }
+}
+
+// Attaches the per-component statistics to the volumes dataset, such that views do not have to scan the volume for value ranges
+void setStatisticsProperties(mv::Dataset<Volumes>& volumeDataset, const VolumeConversion::ComponentStatistics& statistics)
+{
+    QVariantList minimum, maximum, mean, histograms;
+
+    for (int c = 0; c < statistics.getNumberOfComponents(); c++)
+    {
+        // Components without values get an empty range
+        const bool hasValues = statistics.count[c] > 0;
+
+        minimum.append(hasValues ? statistics.ranges.minimum[c] : 0.0);
+        maximum.append(hasValues ? statistics.ranges.maximum[c] : 0.0);
+        mean.append(statistics.getMean(c));
+
+        QVariantList histogram;
+        histogram.reserve(VolumeConversion::histogramBins);
+
+        for (const auto binCount : statistics.histograms[c])
+            histogram.append(static_cast<qulonglong>(binCount));
+
+        histograms.append(QVariant(histogram));
+    }
+
+    volumeDataset->setProperty("ComponentMinimum", minimum);
+    volumeDataset->setProperty("ComponentMaximum", maximum);
+    volumeDataset->setProperty("ComponentMean", mean);
+    volumeDataset->setProperty("ComponentHistograms", histograms);
+}
+
+// Attaches the brick occupancy of a mostly empty volume to the volumes dataset, such that views skip the render cubes without occupied bricks
+void setOccupancyProperties(mv::Dataset<Volumes>& volumeDataset, const SparseVolume::BrickOccupancy& occupancy)
+{
+    // Dense volumes gain nothing from the occupancy, so it is left out
+    if (!occupancy.isValid() || occupancy.getNumberOfOccupiedBricks() == occupancy.getNumberOfBricks())
+        return;
+
+    volumeDataset->setProperty("BrickSize", occupancy.brickSize);
+    volumeDataset->setProperty("BrickOccupancy", QByteArray(reinterpret_cast<const char*>(occupancy.occupied.data()), static_cast<qsizetype>(occupancy.occupied.size())));
+
+    qDebug() << "DVRVolumeLoader: Occupied" << occupancy.getNumberOfOccupiedBricks() << "of" << occupancy.getNumberOfBricks() << "bricks of" << occupancy.brickSize << "voxels";
+}
+
+// Stores how the quantized values map back to the original values as properties of the point data: value = stored * scale + offset, per component
+template <typename S>
+void setQuantizationProperties(mv::Dataset<Points>& point_data, const VolumeConversion::ComponentRanges& ranges)
+{
+    if constexpr (std::is_integral_v<S>)
+    {
+        QVariantList scale, offset;
+
+        for (int c = 0; c < ranges.getNumberOfComponents(); c++)
+        {
+            double componentScale, componentOffset;
+            VolumeConversion::getDequantization<S>(ranges, c, componentScale, componentOffset);
+
+            scale.append(componentScale);
+            offset.append(componentOffset);
+        }
+
+        point_data->setProperty("QuantizationScale", scale);
+        point_data->setProperty("QuantizationOffset", offset);
+
+        qDebug() << "DVRVolumeLoader: Quantized" << ranges.getNumberOfComponents() << "components into" << sizeof(S) << "byte elements";
+    }
+}
+
+// Converts the binary data straight into a preallocated vector, the conversion itself is spread over all cores.
+// With a component selection only the selected components are read from the contents and stored.
+// When quantizing, the ranges of the (selected) components are returned through ranges.
+template <typename T, typename S>
+std::vector<S> convertData(const char* contents, std::size_t numBytes, int32_t numDims, bool swapBytes, bool quantize, const std::vector<int>& selection, std::optional<VolumeConversion::ComponentRanges>& ranges, VolumeConversion::ComponentStatistics& statistics)
+{
+    const auto numElements = static_cast<std::int64_t>(numBytes / sizeof(T));
+    const auto numVoxels = numElements / numDims;
+    const auto numStoredDims = selection.empty() ? numDims : static_cast<int32_t>(selection.size());
+    std::vector<S> data(selection.empty() ? numElements : numVoxels * numStoredDims);
+
+    // Quantization maps the range of each component onto the storage type, which takes an extra (parallel) pass to find the ranges
+    if (quantize) {
+        ranges.emplace(numDims);
+        VolumeConversion::updateComponentRanges<T>(contents, numVoxels * numDims, *ranges, swapBytes);
+
+        if (!selection.empty())
+            ranges = VolumeConversion::selectRanges(*ranges, selection);
+    }
+
+    // Only the conversion pass is timed, it reads all components of the voxels whether they are selected or not
+    QElapsedTimer timer;
+    timer.start();
+
+    convertOrQuantizeVoxels<T, S>(contents, data.data(), numVoxels, numDims, selection, ranges ? &*ranges : nullptr, swapBytes, statistics);
+
+    const double seconds = std::max(timer.nsecsElapsed() * 1e-9, 1e-9);
+    const auto numReadBytes = static_cast<double>(numVoxels) * numDims * sizeof(T);
+    qDebug() << "DVRVolumeLoader: Converted" << data.size() << "elements from" << sizeof(T) << "to" << sizeof(S) << "byte elements in" << seconds << "s (" << numReadBytes / seconds / 1e9 << "GB/s read)";
+
+    updateHistograms<S>(data, ranges ? &*ranges : nullptr, statistics);
+
+    if (std::lldiv(static_cast<long long>(numElements), static_cast<long long>(numDims)).rem != 0)
+        qWarning() << "WARNING: DVRVolumeLoader.cpp::convertData: Data size divided by number of dimension is not an integer. Something might have gone wrong.";
+
+    return data;
+}
+
+template <typename T, typename S>
+void readDataAndAddToCore(mv::Dataset<Points>& point_data, int32_t numDims, const char* contents, std::size_t numBytes, bool swapBytes, bool quantize, const std::vector<int>& selection, VolumeConversion::ComponentStatistics& statistics)
+{
+    if constexpr (std::is_same_v<T, float> || std::is_same_v<T, unsigned char> || std::is_same_v<T, std::uint16_t>)
+    {
+        const auto numStoredDims = selection.empty() ? numDims : static_cast<int32_t>(selection.size());
+
+        std::optional<VolumeConversion::ComponentRanges> ranges;
+
+        auto data = convertData<T, S>(contents, numBytes, numDims, swapBytes, quantize, selection, ranges, statistics);
+
+        // add data to the core
+        point_data->setData(std::move(data), numStoredDims);
+
+        if (ranges)
+            setQuantizationProperties<S>(point_data, *ranges);
+    }
+    else
+    {
+        qWarning() << "DVRVolumeLoader.cpp::readDataAndAddToCore: No data loaded. Template typename not implemented.";
+    }
+}
+
+// Checks that the file holds the raw data of the volume from dataOffset onwards, trailing bytes are ignored with a warning
+void checkDataSize(const QFile& file, qint64 dataOffset, qint64 expectedBytes)
+{
+    const auto availableBytes = file.size() - dataOffset;
+
+    if (availableBytes < expectedBytes)
+        throw DataLoadException(file.fileName(), QString("File holds %1 bytes, but the given volume size and number of dimensions require %2 bytes.").arg(availableBytes).arg(expectedBytes));
+
+    if (availableBytes > expectedBytes)
+        qWarning() << "WARNING: DVRVolumeLoader.cpp::checkDataSize: File is larger than the given volume size and number of dimensions require," << availableBytes - expectedBytes << "trailing bytes are ignored.";
+}
+
+// Reads the file from dataOffset onwards in slabs of slabDepth z-slices, such that only a single slab of raw data is resident next to the converted data.
+// When quantizing, the file is read twice: the first pass finds the range of every component and the second stores the quantized values.
+// Returns false when the load was cancelled through the progress callback.
+template <typename T, typename S>
+bool readSlabsAndAddToCore(mv::Dataset<Points>& point_data, int32_t numDims, QFile& file, qint64 dataOffset, bool swapBytes, const Size3D& volumeSize, int slabDepth, bool quantize, const std::vector<int>& selection, VolumeConversion::ComponentStatistics& statistics, const ProgressCallback& progressCallback)
+{
+    const auto voxelsPerSlice = static_cast<std::int64_t>(volumeSize.width()) * volumeSize.height();
+    const auto elementsPerSlice = voxelsPerSlice * numDims;
+    const auto numElements = elementsPerSlice * volumeSize.depth();
+
+    // Check the file size before anything is allocated, instead of finding out after the whole file was converted
+    checkDataSize(file, dataOffset, static_cast<qint64>(numElements * sizeof(T)));
+
+    // Slabs are read whole, but only the selected components are stored
+    const auto numStoredDims = selection.empty() ? numDims : static_cast<int32_t>(selection.size());
+
+    std::vector<S> data(voxelsPerSlice * volumeSize.depth() * numStoredDims);
+    std::vector<char> slab(static_cast<std::size_t>(slabDepth * elementsPerSlice * sizeof(T)));
+
+    std::optional<VolumeConversion::ComponentRanges> ranges;
+
+    const int numPasses = quantize ? 2 : 1;
+
+    for (int pass = 0; pass < numPasses; pass++)
+    {
+        const bool isRangePass = quantize && pass == 0;
+
+        if (isRangePass)
+            ranges.emplace(numDims);
+        else if (ranges && !selection.empty())
+            ranges = VolumeConversion::selectRanges(*ranges, selection);
+
+        if (!file.seek(dataOffset))
+            throw DataLoadException(file.fileName(), QString("Could not seek to the data offset %1.").arg(dataOffset));
+
+        for (int z = 0; z < volumeSize.depth(); z += slabDepth)
+        {
+            const int numSlices = std::min(slabDepth, volumeSize.depth() - z);
+            const auto slabElements = numSlices * elementsPerSlice;
+            const auto slabBytes = static_cast<qint64>(slabElements * sizeof(T));
+
+            if (file.read(slab.data(), slabBytes) != slabBytes)
+                throw DataLoadException(file.fileName(), QString("Could not read z-slices %1 to %2.").arg(z).arg(z + numSlices - 1));
+
+            if (isRangePass)
+                VolumeConversion::updateComponentRanges<T>(slab.data(), slabElements, *ranges, swapBytes);
+            else
+                convertOrQuantizeVoxels<T, S>(slab.data(), data.data() + z * voxelsPerSlice * numStoredDims, numSlices * voxelsPerSlice, numDims, selection, ranges ? &*ranges : nullptr, swapBytes, statistics);
+
+            if (!progressCallback((pass + static_cast<float>(z + numSlices) / volumeSize.depth()) / numPasses))
+                return false;
+        }
+    }
+
+    updateHistograms<S>(data, ranges ? &*ranges : nullptr, statistics);
+
+    // add data to the core
+    point_data->setData(std::move(data), numStoredDims);
+
+    if (ranges)
+        setQuantizationProperties<S>(point_data, *ranges);
+
+    return true;
+}
+
+// Decodes a bricked volume one brick layer at a time, the bricks within a layer are decompressed in parallel straight into the point data.
+// Returns false when the load was cancelled through the progress callback.
+template <typename S>
+bool readBricksAndAddToCore(mv::Dataset<Points>& point_data, QFile& file, const BrickedVolume::Header& header, VolumeConversion::ComponentStatistics& statistics, const ProgressCallback& progressCallback)
+{
+    if (sizeof(S) != header.elementSize)
+        throw DataLoadException(file.fileName(), QString("Element size %1 does not match the %2 element type.").arg(header.elementSize).arg(header.elementTypeName));
+
+    const uchar* mapping = file.map(0, file.size());
+    if (mapping == nullptr)
+        throw DataLoadException(file.fileName(), "File could not be memory-mapped.");
+
+    std::vector<S> data(header.getNumberOfVoxels() * header.numComponents);
+
+    QElapsedTimer timer;
+    timer.start();
+
+    const auto numBricks        = header.getNumberOfBricks();
+    const auto bricksPerLayer   = static_cast<std::uint64_t>(header.getNumberOfBricksX()) * header.getNumberOfBricksY();
+
+    for (std::uint64_t firstBrick = 0; firstBrick < numBricks; firstBrick += bricksPerLayer)
+    {
+        const auto lastBrick = std::min(firstBrick + bricksPerLayer, numBricks);
+
+        BrickedVolume::decodeBricks(reinterpret_cast<const char*>(mapping), header, firstBrick, lastBrick, reinterpret_cast<char*>(data.data()));
+
+        if (!progressCallback(static_cast<float>(lastBrick) / numBricks))
+            return false;
+    }
+
+    const double seconds = std::max(timer.nsecsElapsed() * 1e-9, 1e-9);
+    qDebug() << "DVRVolumeLoader: Decoded" << numBricks << "bricks," << file.size() << "bytes into" << data.size() * sizeof(S) << "bytes in" << seconds << "s (" << (data.size() * sizeof(S)) / seconds / 1e9 << "GB/s decoded)";
+
+    file.unmap(const_cast<uchar*>(mapping));
+
+    // The exported statistics describe the source values, the stored values of a quantized volume would give the statistics of the integers
+    if (header.hasStatistics())
+        readHeaderStatistics(header, statistics);
+    else if (header.isQuantized())
+        computeDequantizedStatistics<S>(data, header.quantizationScale, header.quantizationOffset, statistics);
+    else
+        computeStatistics<S>(data, statistics);
+
+    if (header.isQuantized())
+    {
+        QVariantList scale, offset;
+
+        for (std::uint32_t c = 0; c < header.numComponents; c++)
+        {
+            scale.append(header.quantizationScale[c]);
+            offset.append(header.quantizationOffset[c]);
+        }
+
+        point_data->setProperty("QuantizationScale", scale);
+        point_data->setProperty("QuantizationOffset", offset);
+    }
+
+    // add data to the core
+    point_data->setData(std::move(data), static_cast<int>(header.numComponents));
+
+    return true;
+}
+
+// Converts the gray values of a decoded slice into point data elements and gathers their statistics, called on a worker thread per slice
+template <typename T, typename S>
+void convertSlice(const QImage& slice, S* destination, VolumeConversion::ComponentStatistics& statistics)
+{
+    const auto width = static_cast<std::int64_t>(slice.width());
+
+    // Rows are converted one at a time, since image rows may be padded
+    for (int y = 0; y < slice.height(); y++)
+    {
+        const auto row = reinterpret_cast<const char*>(slice.constScanLine(y));
+
+        VolumeConversion::convertBlock<T, S>(row, destination + y * width, width);
+        VolumeConversion::accumulateStatistics<T>(row, width, 0, statistics, false);
+    }
+}
+
+// Decodes the slices of a stack in parallel with one slice per task, every slice is converted straight into its z-offset of the point data elements.
+// The conversion of a slice is serial, the slices themselves are what is spread over the cores.
+template <typename S>
+bool readSliceStackAndAddToCore(mv::Dataset<Points>& point_data, const SliceStack& sliceStack, VolumeConversion::ComponentStatistics& statistics, const ProgressCallback& progressCallback)
+{
+    const auto numSlices        = sliceStack.getNumberOfSlices();
+    const auto voxelsPerSlice   = static_cast<std::int64_t>(sliceStack.sizeX) * sliceStack.sizeY;
+
+    std::vector<S> data(voxelsPerSlice * numSlices);
+    std::vector<std::int32_t> slices(numSlices);
+    std::iota(slices.begin(), slices.end(), 0);
+
+    QElapsedTimer timer;
+    timer.start();
+
+    QMutex mutex;
+    std::exception_ptr error;
+    std::atomic<bool> hasFailed(false);
+
+    auto future = QtConcurrent::map(slices, [&](std::int32_t z) {
+        try {
+            const QImage slice = readSlice(sliceStack, z);
+
+            VolumeConversion::ComponentStatistics sliceStatistics(1);
+
+            if (sliceStack.dataType == BinaryDataType::UINT16)
+                convertSlice<std::uint16_t, S>(slice, data.data() + z * voxelsPerSlice, sliceStatistics);
+            else
+                convertSlice<unsigned char, S>(slice, data.data() + z * voxelsPerSlice, sliceStatistics);
+
+            QMutexLocker locker(&mutex);
+            statistics.merge(sliceStatistics);
+        }
+        catch (...) {
+            QMutexLocker locker(&mutex);
+            if (!error)
+                error = std::current_exception();
+            hasFailed = true;
+        }
+    });
+
+    // Report the progress from this thread, the progress callback is not thread-safe
+    while (!future.isFinished()) {
+        if (!progressCallback(static_cast<float>(future.progressValue()) / numSlices) || hasFailed) {
+            future.cancel();
+            future.waitForFinished();
+            break;
+        }
+
+        QThread::msleep(50);
+    }
+
+    if (error)
+        std::rethrow_exception(error);
+
+    if (future.isCanceled())
+        return false;
+
+    const double seconds = std::max(timer.nsecsElapsed() * 1e-9, 1e-9);
+    qDebug() << "DVRVolumeLoader: Decoded" << numSlices << "slices in" << seconds << "s (" << numSlices / seconds << "slices/s)";
+
+    updateHistograms<S>(data, nullptr, statistics);
+
+    // add data to the core
+    point_data->setData(std::move(data), 1);
+
+    return true;
+}
+
+// Calls the function object with a random access iterator to the values of the points and the number of values per point.
+// Full datasets are visited in place, subsets are gathered into a contiguous buffer first.
+template <typename FunctionObject>
+void visitPointValues(Dataset<Points>& points, FunctionObject functionObject)
+{
+    const auto numDimensions = static_cast<std::int64_t>(points->getNumDimensions());
+
+    if (points->isFull()) {
+        points->visitFromBeginToEnd([&functionObject, numDimensions](auto begin, auto end) {
+            functionObject(begin, numDimensions);
+        });
+    }
+    else {
+        std::vector<float> values(static_cast<std::size_t>(points->getNumPoints()) * numDimensions);
+        std::vector<int> dimensionIndices(numDimensions);
+
+        std::iota(dimensionIndices.begin(), dimensionIndices.end(), 0);
+        points->populateDataForDimensions(values, dimensionIndices);
+
+        functionObject(values.cbegin(), numDimensions);
+    }
+}
+
+// Calls the function object with a value of the source type that is specified by the binary data type
+template <typename FunctionObject>
+void visitBinaryDataType(BinaryDataType dataType, FunctionObject functionObject)
+{
+    if (dataType == BinaryDataType::FLOAT)
+        functionObject(float{});
+    else if (dataType == BinaryDataType::UBYTE)
+        functionObject(static_cast<unsigned char>(0));
+    else if (dataType == BinaryDataType::UINT16)
+        functionObject(std::uint16_t{});
+}
+
+// Recursively searches for the data element type that is specified by the selectedDataElementType parameter, and calls the function object with a value of that type
+template <unsigned N = 0, typename FunctionObject>
+void recursiveVisitElementType(const QString& selectedDataElementType, FunctionObject functionObject)
+{
+    if constexpr (N < PointData::getNumberOfSupportedElementTypes())
+    {
+        const QLatin1String nthDataElementTypeName(std::get<N>(PointData::getElementTypeNames()));
+
+        if (selectedDataElementType == nthDataElementTypeName)
+        {
+            functionObject(PointData::ElementTypeAt<N>{});
+        }
+        else
+        {
+            recursiveVisitElementType<N + 1>(selectedDataElementType, functionObject);
+        }
+    }
+}
+
+// Everything the load pipeline needs, copied from the dialog and the loader on the GUI thread such that the worker never touches widgets
+struct LoadSettings
+{
+    DatasetSource                           datasetSource = DatasetSource::File;
+    std::int32_t                            width = 0;                  /** Number of voxels on the x-axis */
+    std::int32_t                            height = 0;                 /** Number of voxels on the y-axis */
+    std::int32_t                            depth = 0;                  /** Number of voxels on the z-axis */
+    std::int32_t                            valueDimensions = 1;        /** Number of values per voxel */
+    QString                                 storeAs;                    /** Point data element type name */
+    BinaryDataType                          dataType = BinaryDataType::FLOAT;
+    IngestMode                              ingestMode = IngestMode::MemoryMapped;
+    std::int32_t                            slabDepth = 1;
+    QString                                 components;                 /** Components that are loaded from raw files, empty loads all */
+    bool                                    timeSeries = false;         /** Whether the file is the first timestep of a series */
+    std::int32_t                            numPrefetchedTimesteps = 2; /** Number of timesteps that are decoded ahead */
+    bool                                    quantize = false;
+    bool                                    useCache = false;           /** Whether converted files are read from and written to the cache */
+    qint64                                  maximumCacheSize = qint64(64) << 30; /** Budget of the cache in bytes, the least recently used volumes are removed beyond it */
+    Voxelizer::Kernel                       voxelizationKernel = Voxelizer::Kernel::Nearest;
+    bool                                    fillGaps = false;
+    Dataset<Points>                         spatialDataset;
+    Dataset<Points>                         valueDataset;
+    QString                                 fileName;
+    std::optional<VolumeHeader>             volumeHeader;
+    std::optional<BrickedVolume::Header>    brickedVolumeHeader;
+    std::optional<SliceStack>               sliceStack;
+    QString                                 hdf5FileName;               /** HDF5 file of the point cloud */
+    QString                                 positionsArray;             /** Path of the coordinate array in the HDF5 file */
+    QString                                 valuesArray;                /** Path of the value array in the HDF5 file */
+    std::optional<VolumeResampling::Region> resampleRegion;             /** Region of which a resampled copy is created after loading, empty for none */
+    std::int32_t                            resampleSize = 512;         /** Number of voxels along the longest axis of the resampled copy */
+    VolumeResampling::Filter                resampleFilter = VolumeResampling::Filter::Box;
+
+    Size3D getVolumeSize() const {
+        return Size3D(width, height, depth);
+    }
+};
+
+// Outcome of the load pipeline, an error is rethrown on the GUI thread such that it can be shown to the user
+struct LoadResult
+{
+    bool                loaded = false;     /** Whether the point data was filled, false when cancelled or failed */
+    VolumeConversion::ComponentStatistics statistics; /** Per-component statistics of the loaded values */
+    SparseVolume::BrickOccupancy occupancy; /** Occupied bricks of voxelized point datasets, empty for files */
+    VolumeResampling::ResampledValues resampled; /** Resampled copy of the loaded volume, without data when none was requested or it was cancelled */
+    QString             cacheKey;           /** Key under which the converted volume is cached once it is published, empty when it is not cached */
+    QString             errorTitle;         /** Title of the message box that shows the error */
+    std::exception_ptr  error;              /** Error that stopped the load (if any) */
+};
+
+// Hands the grid of a voxelizer over to the point data, together with its statistics and brick occupancy
+void finishVoxelization(Voxelizer& voxelizer, bool fillGaps, std::int32_t numComponents, Dataset<Points>& point_data, VolumeConversion::ComponentStatistics& statistics, SparseVolume::BrickOccupancy& occupancy)
+{
+    auto voxels = voxelizer.finalize(fillGaps);
+
+    occupancy = voxelizer.getOccupancy();
+
+    statistics = VolumeConversion::ComponentStatistics(numComponents);
+    computeStatistics<float>(voxels, statistics);
+
+    point_data->setData(std::move(voxels), numComponents);
+}
+
+// Voxelizes the spatial and value point datasets into the point data, returns false when the load was cancelled through the progress callback
+bool voxelizePointDatasets(const LoadSettings& settings, Dataset<Points>& point_data, VolumeConversion::ComponentStatistics& statistics, SparseVolume::BrickOccupancy& occupancy, const ProgressCallback& progressCallback)
+{
+    Dataset<Points> spatialDataset = settings.spatialDataset;
+    Dataset<Points> valueDataset = settings.valueDataset;
+
+    if (!spatialDataset.isValid() || !valueDataset.isValid())
+        throw std::runtime_error("Both a spatial and a value dataset need to be selected.");
+
+    if (spatialDataset->getNumPoints() != valueDataset->getNumPoints())
+        throw std::runtime_error("The spatial and value datasets have a different number of points.");
+
+    if (spatialDataset->getNumDimensions() < 3)
+        throw std::runtime_error("The spatial dataset needs at least three dimensions.");
+
+    if (valueDataset->getNumDimensions() < static_cast<unsigned int>(settings.valueDimensions))
+        throw std::runtime_error("The value dataset has fewer dimensions than the number of value dimensions.");
+
+    const auto numPoints = static_cast<std::int64_t>(spatialDataset->getNumPoints());
+
+    Voxelizer voxelizer(settings.width, settings.height, settings.depth, settings.valueDimensions, settings.voxelizationKernel);
+
+    QElapsedTimer timer;
+    timer.start();
+
+    bool loaded = true;
+
+    // The positions and values are read in place, the bounding box takes one parallel pass and the scatter another
+    visitPointValues(spatialDataset, [&](auto positions, std::int64_t positionStride) {
+        voxelizer.setBounds(Voxelizer::computeBounds(positions, positionStride, numPoints));
+
+        visitPointValues(valueDataset, [&](auto values, std::int64_t valueStride) {
+
+            // Scatter in chunks such that the progress is reported and the load can be cancelled
+            for (std::int64_t begin = 0; begin < numPoints && loaded; begin += voxelizeChunkSize) {
+                const auto end = std::min(begin + voxelizeChunkSize, numPoints);
+
+                voxelizer.scatter(positions, positionStride, values, valueStride, begin, end);
+
+                loaded = progressCallback(static_cast<float>(end) / numPoints);
+            }
+        });
+    });
+
+    if (!loaded)
+        return false;
+
+    finishVoxelization(voxelizer, settings.fillGaps, settings.valueDimensions, point_data, statistics, occupancy);
+
+    qDebug() << "DVRVolumeLoader: Voxelized" << numPoints << "points in" << timer.elapsed() << "ms";
+
+    return true;
+}
+
+#ifdef USE_HDF5
+// Voxelizes a point cloud that is stored as a coordinate and a value array in an HDF5 file, returns false when the load was cancelled through the progress callback.
+// The arrays are read in blocks of rows with hyperslabs, the next block is read on another thread while the current one is scattered,
+// such that only the grid and two blocks are in memory instead of the whole point cloud.
+bool voxelizeHDF5Arrays(const LoadSettings& settings, Dataset<Points>& point_data, VolumeConversion::ComponentStatistics& statistics, SparseVolume::BrickOccupancy& occupancy, const ProgressCallback& progressCallback)
+{
+    const HDF5Array positions(settings.hdf5FileName, settings.positionsArray);
+    const HDF5Array values(settings.hdf5FileName, settings.valuesArray);
+
+    if (positions.getNumberOfRows() != values.getNumberOfRows())
+        throw std::runtime_error("The position and value arrays have a different number of points.");
+
+    if (positions.getNumberOfColumns() < 3)
+        throw std::runtime_error("The position array needs at least three columns.");
+
+    const auto numPoints        = positions.getNumberOfRows();
+    const auto positionStride   = static_cast<std::int64_t>(positions.getNumberOfColumns());
+    const auto numComponents    = values.getNumberOfColumns();
+
+    // Blocks are a multiple of the chunk size of the positions, such that no chunk is decompressed twice
+    const auto chunkRows = std::max(positions.getChunkRows(), std::int64_t(1));
+    const auto blockSize = std::max(voxelizeChunkSize / chunkRows, std::int64_t(1)) * chunkRows;
+
+    struct Block
+    {
+        std::vector<float>  positions;
+        std::vector<float>  values;
+        std::int64_t        count = 0;
+        std::exception_ptr  error;
+    };
+
+    const auto readBlock = [&](std::int64_t begin, bool withValues) -> Block {
+        Block block;
+
+        try {
+            block.count = std::min(blockSize, numPoints - begin);
+            block.positions.resize(block.count * positionStride);
+            positions.readRows(begin, block.count, block.positions.data());
+
+            if (withValues) {
+                block.values.resize(block.count * numComponents);
+                values.readRows(begin, block.count, block.values.data());
+            }
+        }
+        catch (...) {
+            block.error = std::current_exception();
+        }
+
+        return block;
+    };
+
+    // Passes over the blocks in order, reading the next block while the current one is processed. Returns false when cancelled.
+    const auto streamBlocks = [&](bool withValues, float progressOffset, const std::function<void(const Block&)>& process) -> bool {
+        auto next = QtConcurrent::run(readBlock, std::int64_t(0), withValues);
+
+        // The read ahead reads through the arrays, so it has to finish before they go out of scope, also when process or the progress callback throws
+        const auto waitForNext = qScopeGuard([&next]() {
+            next.waitForFinished();
+        });
+
+        for (std::int64_t begin = 0; begin < numPoints; begin += blockSize)
+        {
+            const Block block = next.result();
+
+            if (block.error)
+                std::rethrow_exception(block.error);
+
+            const auto end = begin + block.count;
+
+            if (end < numPoints)
+                next = QtConcurrent::run(readBlock, end, withValues);
+
+            process(block);
+
+            if (!progressCallback(progressOffset + 0.5f * static_cast<float>(end) / numPoints))
+                return false;
+        }
+
+        return true;
+    };
+
+    QElapsedTimer timer;
+    timer.start();
+
+    Voxelizer voxelizer(settings.width, settings.height, settings.depth, numComponents, settings.voxelizationKernel);
+
+    // The bounding box needs all positions before the first point is scattered, so the positions are read twice
+    Voxelizer::Bounds bounds;
+
+    const bool bounded = streamBlocks(false, 0.0f, [&](const Block& block) {
+        bounds.extend(Voxelizer::computeBounds(block.positions.data(), positionStride, block.count));
+    });
+
+    if (!bounded)
+        return false;
+
+    voxelizer.setBounds(bounds);
+
+    const bool scattered = streamBlocks(true, 0.5f, [&](const Block& block) {
+        voxelizer.scatter(block.positions.data(), positionStride, block.values.data(), static_cast<std::int64_t>(numComponents), 0, block.count);
+    });
+
+    if (!scattered)
+        return false;
+
+    finishVoxelization(voxelizer, settings.fillGaps, numComponents, point_data, statistics, occupancy);
+
+    qDebug() << "DVRVolumeLoader: Voxelized" << numPoints << "points from" << settings.hdf5FileName << "in" << timer.elapsed() << "ms";
+
+    return true;
+}
+#endif
+
+// Reads the (raw, self-describing or bricked) volume file into the point data, returns false when the load was cancelled through the progress callback
+bool readVolumeFile(const LoadSettings& settings, Dataset<Points>& point_data, VolumeConversion::ComponentStatistics& statistics, const ProgressCallback& progressCallback)
+{
+    if (settings.sliceStack) {
+        bool loaded = false;
+
+        recursiveVisitElementType(settings.storeAs, [&](auto targetValue) {
+            using S = decltype(targetValue);
 
-#include <QtCore>
-#include <QtDebug>
+            loaded = readSliceStackAndAddToCore<S>(point_data, *settings.sliceStack, statistics, progressCallback);
+        });
 
-#include <cstdlib>
-#include <fstream>
-#include <type_traits>
-#include <vector>
+        return loaded;
+    }
 
-Q_PLUGIN_METADATA(IID "nl.tudelft.DVRVolumeLoader")
+    // Self-describing files point to the raw data, which may be located in another file and start after a header
+    const auto& volumeHeader   = settings.volumeHeader;
+    const auto dataFileName    = volumeHeader ? volumeHeader->dataFileName : settings.fileName;
+    const auto dataOffset      = volumeHeader ? volumeHeader->dataOffset : qint64(0);
+    const auto swapBytes       = volumeHeader ? volumeHeader->swapBytes : false;
 
-using namespace mv;
-using namespace mv::gui;
+    qDebug() << "Loading volume data file: " << dataFileName;
 
-// =============================================================================
-// View
-// =============================================================================
+    QFile file(dataFileName);
 
-DVRVolumeLoader::~DVRVolumeLoader(void)
-{
+    if (!file.open(QIODevice::ReadOnly))
+        throw DataLoadException(dataFileName, "File could not be opened.");
+
+    bool loaded = true;
+
+    if (settings.brickedVolumeHeader) {
+
+        // Bricked volumes are decoded into the element type they were exported with, so no conversion is needed
+        recursiveVisitElementType(settings.brickedVolumeHeader->elementTypeName, [&](auto targetValue) {
+            using S = decltype(targetValue);
+
+            loaded = readBricksAndAddToCore<S>(point_data, file, *settings.brickedVolumeHeader, statistics, progressCallback);
+        });
+    }
+    else {
+        // Only the selected components are read and stored, so the statistics cover just those
+        const auto selection = parseComponentSelection(settings.components, settings.valueDimensions);
+
+        if (!selection.empty())
+            statistics = VolumeConversion::ComponentStatistics(static_cast<int>(selection.size()));
+
+        visitBinaryDataType(settings.dataType, [&](auto sourceValue) {
+            using T = decltype(sourceValue);
+
+            recursiveVisitElementType(settings.storeAs, [&](auto targetValue) {
+                using S = decltype(targetValue);
+
+                if (settings.ingestMode == IngestMode::Streaming) {
+                    loaded = readSlabsAndAddToCore<T, S>(point_data, settings.valueDimensions, file, dataOffset, swapBytes, settings.getVolumeSize(), settings.slabDepth, settings.quantize, selection, statistics, progressCallback);
+                }
+                else {
+                    // Map the file instead of reading it, such that the conversion reads straight from the page cache and only the converted data is resident.
+                    // The size is checked first, since the conversion reads as many elements as the volume size asks for.
+                    const auto volumeSize = settings.getVolumeSize();
+                    const auto dataSize = static_cast<qint64>(volumeSize.width()) * volumeSize.height() * volumeSize.depth() * settings.valueDimensions * static_cast<qint64>(sizeof(T));
+
+                    checkDataSize(file, dataOffset, dataSize);
+
+                    const uchar* mapping = file.map(dataOffset, dataSize);
+                    if (mapping == nullptr)
+                        throw DataLoadException(dataFileName, "File could not be memory-mapped.");
+
+                    readDataAndAddToCore<T, S>(point_data, settings.valueDimensions, reinterpret_cast<const char*>(mapping), static_cast<std::size_t>(dataSize), swapBytes, settings.quantize, selection, statistics);
+
+                    file.unmap(const_cast<uchar*>(mapping));
+                }
+            });
+        });
+
+        // Name the dimensions after the components they were read from
+        if (loaded && !selection.empty()) {
+            std::vector<QString> dimensionNames;
+            dimensionNames.reserve(selection.size());
+
+            for (const auto component : selection)
+                dimensionNames.push_back(QString("Dim %1").arg(component));
+
+            point_data->setDimensionNames(dimensionNames);
+        }
+    }
+
+    file.close();
 
+    return loaded;
 }
 
-void DVRVolumeLoader::init()
+// Makes the decoder of the timesteps of a series, which converts a timestep file the same way the first one was loaded (always memory mapped).
+// Every timestep gets its own quantization and statistics, which are set together with its data.
+TimeSeries::Decoder makeTimeSeriesDecoder(const LoadSettings& settings)
 {
+    return [settings](const QString& fileName) -> TimeSeries::Publisher {
 
-}
+        // Self-describing files may point to data in another file, so the header of every timestep is read
+        std::optional<VolumeHeader> volumeHeader;
 
-namespace {
+        if (settings.volumeHeader)
+            volumeHeader = readVolumeHeader(fileName);
 
+        const auto dataFileName    = volumeHeader ? volumeHeader->dataFileName : fileName;
+        const auto dataOffset      = volumeHeader ? volumeHeader->dataOffset : qint64(0);
+        const auto swapBytes       = volumeHeader ? volumeHeader->swapBytes : false;
 
-template <typename T, typename S>
-void readDataAndAddToCore(mv::Dataset<Points>& point_data, int32_t numDims, const std::vector<char>& contents)
+        QFile file(dataFileName);
+
+        if (!file.open(QIODevice::ReadOnly))
+            throw DataLoadException(dataFileName, "File could not be opened.");
+
+        const auto dataSize = volumeHeader ? volumeHeader->getNumberOfBytes() : file.size();
+        const uchar* mapping = file.map(dataOffset, dataSize);
+        if (mapping == nullptr)
+            throw DataLoadException(dataFileName, "File could not be memory-mapped.");
+
+        const auto selection = parseComponentSelection(settings.components, settings.valueDimensions);
+        const auto numStoredDims = selection.empty() ? settings.valueDimensions : static_cast<int32_t>(selection.size());
+
+        TimeSeries::Publisher publisher;
+
+        visitBinaryDataType(settings.dataType, [&](auto sourceValue) {
+            using T = decltype(sourceValue);
+
+            recursiveVisitElementType(settings.storeAs, [&](auto targetValue) {
+                using S = decltype(targetValue);
+
+                // Every timestep has to have the layout of the first one
+                const auto expectedBytes = static_cast<qint64>(settings.getVolumeSize().width()) * settings.getVolumeSize().height() * settings.getVolumeSize().depth() * settings.valueDimensions * static_cast<qint64>(sizeof(T));
+
+                if (dataSize < expectedBytes)
+                    throw DataLoadException(dataFileName, QString("File holds %1 bytes, but the timesteps of the series require %2 bytes.").arg(dataSize).arg(expectedBytes));
+
+                std::optional<VolumeConversion::ComponentRanges> ranges;
+                VolumeConversion::ComponentStatistics statistics(numStoredDims);
+
+                const auto data = std::make_shared<std::vector<S>>(convertData<T, S>(reinterpret_cast<const char*>(mapping), static_cast<std::size_t>(expectedBytes), settings.valueDimensions, swapBytes, settings.quantize, selection, ranges, statistics));
+
+                // The decoded data stays in the ring, so the point data gets a copy
+                publisher = [data, numStoredDims, ranges, statistics](Dataset<Points>& points, Dataset<Volumes>& volumes) {
+                    points->setData(std::vector<S>(*data), numStoredDims);
+
+                    if (ranges)
+                        setQuantizationProperties<S>(points, *ranges);
+
+                    setStatisticsProperties(volumes, statistics);
+                };
+            });
+        });
+
+        file.unmap(const_cast<uchar*>(mapping));
+
+        return publisher;
+    };
+}
+
+// Gets the point data element type name of S
+template <typename S, unsigned N = 0>
+QString getElementTypeName()
 {
+    if constexpr (N >= PointData::getNumberOfSupportedElementTypes())
+        return QString();
+    else if constexpr (std::is_same_v<S, PointData::ElementTypeAt<N>>)
+        return QString::fromLatin1(std::get<N>(PointData::getElementTypeNames()));
+    else
+        return getElementTypeName<S, N + 1>();
+}
 
-    // convert binary data to float vector
-    std::vector<S> data;
-    auto add_to_data = [&data](auto val) ->void {
-        auto c = static_cast<S>(val);
-        data.push_back(c);
+// Computes the cache key of a volume file from the files it is read from and the parameters that change the converted point data
+QString computeCacheKey(const LoadSettings& settings)
+{
+    QStringList sourceFileNames = { settings.fileName };
+
+    if (settings.volumeHeader && QFileInfo(settings.volumeHeader->dataFileName) != QFileInfo(settings.fileName))
+        sourceFileNames.append(settings.volumeHeader->dataFileName);
+
+    if (settings.sliceStack)
+        sourceFileNames = settings.sliceStack->fileNames;
+
+    const QStringList parameters = {
+        QString::number(settings.width),
+        QString::number(settings.height),
+        QString::number(settings.depth),
+        QString::number(settings.valueDimensions),
+        settings.storeAs,
+        QString::number(static_cast<int>(settings.dataType)),
+        QString::number(settings.quantize),
+        settings.components
     };
 
-    if constexpr (std::is_same_v<T, float>) {
-        for (size_t i = 0; i < contents.size() / 4; i++)
-        {
-            float f = ((float*)contents.data())[i];
-            add_to_data(f);
-        }
-    }
-    else if constexpr (std::is_same_v<T, unsigned char>)
-    {
-        for (size_t i = 0; i < contents.size(); i++)
-        {
-            T c = static_cast<T>(contents[i]);
-            add_to_data(c);
-        }
-    }
-    else if constexpr (std::is_same_v<T, std::uint16_t>)
-    {
-        for (size_t i = 0; i < contents.size() / 2; i++)
+    return VolumeCache::computeKey(sourceFileNames, parameters);
+}
+
+// Fills the point data and statistics from the cache, returns false when the volume is not cached
+bool readCachedVolume(const QString& cacheKey, Dataset<Points>& point_data, VolumeConversion::ComponentStatistics& statistics)
+{
+    VolumeCache cache;
+
+    if (!cache.open(cacheKey))
+        return false;
+
+    QElapsedTimer timer;
+    timer.start();
+
+    const auto& header = cache.getHeader();
+
+    bool loaded = false;
+
+    recursiveVisitElementType(header.elementTypeName, [&](auto targetValue) {
+        using S = decltype(targetValue);
+
+        const auto numElements = static_cast<std::int64_t>(header.numPoints) * header.numDimensions;
+        const auto numBytes = numElements * static_cast<std::int64_t>(sizeof(S));
+
+        if (numBytes != cache.getPayloadSize())
+            return;
+
+        std::vector<S> data(numElements);
+
+        // Copy in parallel chunks, such that the page faults of the mapping are serviced concurrently
+        constexpr std::int64_t chunkSize = 1 << 24;
+        const auto numChunks = (numBytes + chunkSize - 1) / chunkSize;
+        auto* destination = reinterpret_cast<char*>(data.data());
+
+        #pragma omp parallel for schedule(dynamic)
+        for (std::int64_t chunk = 0; chunk < numChunks; chunk++)
         {
-            std::uint16_t f = ((std::uint16_t*)contents.data())[i];
-            add_to_data(f);
+            const auto offset = chunk * chunkSize;
+            std::memcpy(destination + offset, cache.getPayload() + offset, static_cast<std::size_t>(std::min(chunkSize, numBytes - offset)));
         }
-    }
-    else
-    {
-        qWarning() << "DVRVolumeLoader.cpp::readDataAndAddToCore: No data loaded. Template typename not implemented.";
+
+        point_data->setData(std::move(data), header.numDimensions);
+        loaded = true;
+    });
+
+    if (!loaded) {
+        qWarning() << "DVRVolumeLoader: Ignoring cached volume" << cacheKey << "with an unexpected size or element type";
+        return false;
     }
 
-    if(std::lldiv(static_cast<long long>(data.size()), static_cast<long long>(numDims)).rem != 0)
-        qWarning() << "WARNING: DVRVolumeLoader.cpp::readDataAndAddToCore: Data size divided by number of dimension is not an integer. Something might have gone wrong.";
+    if (header.dimensionNames.size() == header.numDimensions)
+        point_data->setDimensionNames(std::vector<QString>(header.dimensionNames.begin(), header.dimensionNames.end()));
 
-    // add data to the core
-    point_data->setData(std::move(data), numDims);
-    events().notifyDatasetDataChanged(point_data);
+    if (!header.quantizationScale.isEmpty()) {
+        point_data->setProperty("QuantizationScale", header.quantizationScale);
+        point_data->setProperty("QuantizationOffset", header.quantizationOffset);
+    }
+
+    statistics = header.statistics;
 
-    qDebug() << "Number of dimensions: " << point_data->getNumDimensions();
-    qDebug() << "BIN file loaded. Num data points: " << point_data->getNumPoints();
+    const double seconds = std::max(timer.nsecsElapsed() * 1e-9, 1e-9);
+    qDebug() << "DVRVolumeLoader: Read cached volume" << cacheKey << "in" << seconds << "s (" << cache.getPayloadSize() / seconds / 1e9 << "GB/s)";
 
+    return true;
 }
 
-// Recursively searches for the data element type that is specified by the selectedDataElementType parameter. 
-template <typename T, unsigned N = 0>
-void recursiveReadDataAndAddToCore(const QString& selectedDataElementType, mv::Dataset<Points>& point_data, int32_t numDims, const std::vector<char>& contents)
+// Writes the converted point data and statistics to the cache, failures only cost the next load its speed up
+void writeCachedVolume(const QString& cacheKey, Dataset<Points>& point_data, const VolumeConversion::ComponentStatistics& statistics, qint64 maximumCacheSize)
 {
-    const QLatin1String nthDataElementTypeName(std::get<N>(PointData::getElementTypeNames()));
+    QElapsedTimer timer;
+    timer.start();
 
-    if (selectedDataElementType == nthDataElementTypeName)
-    {
-        readDataAndAddToCore<T, PointData::ElementTypeAt<N>>(point_data, numDims, contents);
-    }
-    else
-    {
-        recursiveReadDataAndAddToCore<T, N + 1>(selectedDataElementType, point_data, numDims, contents);
+    VolumeCache::Header header;
+
+    header.numDimensions    = static_cast<std::int32_t>(point_data->getNumDimensions());
+    header.numPoints        = point_data->getNumPoints();
+    header.statistics       = statistics;
+
+    for (const auto& dimensionName : point_data->getDimensionNames())
+        header.dimensionNames.append(dimensionName);
+
+    if (point_data->hasProperty("QuantizationScale")) {
+        header.quantizationScale    = point_data->getProperty("QuantizationScale").toList();
+        header.quantizationOffset   = point_data->getProperty("QuantizationOffset").toList();
     }
+
+    bool written = false;
+
+    point_data->visitFromBeginToEnd([&](auto begin, auto end) {
+        using S = std::remove_cv_t<std::remove_reference_t<decltype(*begin)>>;
+
+        header.elementTypeName = getElementTypeName<S>();
+
+        written = VolumeCache::write(cacheKey, header, reinterpret_cast<const char*>(&*begin), static_cast<qint64>((end - begin) * sizeof(S)));
+    });
+
+    if (written)
+        qDebug() << "DVRVolumeLoader: Cached volume" << cacheKey << "in" << timer.elapsed() << "ms";
+
+    VolumeCache::prune(maximumCacheSize);
 }
 
-template <>
-void recursiveReadDataAndAddToCore<float, PointData::getNumberOfSupportedElementTypes()>(const QString&, mv::Dataset<Points>&, int32_t, const std::vector<char>&)
+// Writes the converted point data to the cache on a worker thread, such that the volume is shown without waiting for the write.
+// The write reads the elements of the point data, so removing the dataset blocks until the write is done.
+void writeCachedVolumeInBackground(const QString& cacheKey, const Dataset<Points>& point_data, const VolumeConversion::ComponentStatistics& statistics, qint64 maximumCacheSize, QObject* parent)
 {
-    // This specialization does nothing, intensionally! 
+    auto* cacheWatcher = new QFutureWatcher<void>(parent);
+
+    // The handle is owned by the watcher, such that it only signals the removal while the write may still be running
+    auto* cachedPoints = new Dataset<Points>(point_data);
+
+    cachedPoints->setParent(cacheWatcher);
+
+    QObject::connect(cachedPoints, &Dataset<Points>::dataAboutToBeRemoved, cacheWatcher, [cacheWatcher]() -> void {
+        cacheWatcher->waitForFinished();
+    });
+
+    QObject::connect(cacheWatcher, &QFutureWatcher<void>::finished, cacheWatcher, &QObject::deleteLater);
+
+    cacheWatcher->setFuture(QtConcurrent::run([cacheKey, point_data, statistics, maximumCacheSize]() mutable -> void {
+        writeCachedVolume(cacheKey, point_data, statistics, maximumCacheSize);
+    }));
 }
 
-template <>
-void recursiveReadDataAndAddToCore<unsigned char, PointData::getNumberOfSupportedElementTypes()>(const QString&, mv::Dataset<Points>&, int32_t, const std::vector<char>&)
+// Reads a volume file through the cache: a cached volume is read as is, otherwise the file is converted and the key is returned in
+// missedCacheKey, such that the volume is cached once it is published. Bricked volumes are read at disk speed already and are never cached.
+bool readVolumeFileCached(const LoadSettings& settings, Dataset<Points>& point_data, VolumeConversion::ComponentStatistics& statistics, const ProgressCallback& progressCallback, QString& missedCacheKey)
 {
-    // This specialization does nothing, intensionally! 
+    const auto cacheKey = computeCacheKey(settings);
+
+    if (readCachedVolume(cacheKey, point_data, statistics))
+        return true;
+
+    if (!readVolumeFile(settings, point_data, statistics, progressCallback))
+        return false;
+
+    // The timesteps of a series replace the point data, which would race with the write
+    if (!settings.timeSeries)
+        missedCacheKey = cacheKey;
+
+    return true;
 }
 
-template <>
-void recursiveReadDataAndAddToCore<std::uint16_t, PointData::getNumberOfSupportedElementTypes()>(const QString&, mv::Dataset<Points>&, int32_t, const std::vector<char>&)
+// Runs the load pipeline, called on a worker thread. Only the point data and the resampled copy are computed here, the datasets are created and announced on the GUI thread.
+LoadResult runLoad(const LoadSettings& settings, Dataset<Points> point_data, const ProgressCallback& progressCallback, const ProgressCallback& resampleProgressCallback)
 {
-    // This specialization does nothing, intensionally! 
+    LoadResult result;
+
+    result.statistics = VolumeConversion::ComponentStatistics(settings.valueDimensions);
+
+    try {
+        if (settings.datasetSource == DatasetSource::PointDatasets)
+            result.loaded = voxelizePointDatasets(settings, point_data, result.statistics, result.occupancy, progressCallback);
+#ifdef USE_HDF5
+        else if (settings.datasetSource == DatasetSource::HDF5File)
+            result.loaded = voxelizeHDF5Arrays(settings, point_data, result.statistics, result.occupancy, progressCallback);
+#endif
+        else if (settings.useCache && !settings.brickedVolumeHeader)
+            result.loaded = readVolumeFileCached(settings, point_data, result.statistics, progressCallback, result.cacheKey);
+        else
+            result.loaded = readVolumeFile(settings, point_data, result.statistics, progressCallback);
+    }
+    catch (const std::exception&) {
+        result.loaded       = false;
+        result.errorTitle   = settings.datasetSource == DatasetSource::File ? "Unable to load the volume" : "Unable to voxelize the point cloud";
+        result.error        = std::current_exception();
+    }
+
+    // The resampled copy is computed right after loading, while the loaded elements are still in the cache of the CPU
+    if (result.loaded && settings.resampleRegion) {
+        std::int32_t targetSize[3];
+        VolumeResampling::computeScaledSize(*settings.resampleRegion, settings.resampleSize, targetSize);
+
+        const int brickSize = result.occupancy.isValid() ? result.occupancy.brickSize : 0;
+
+        result.resampled = VolumeResampling::resampleValues(point_data, settings.getVolumeSize(), brickSize, *settings.resampleRegion, targetSize, settings.resampleFilter, resampleProgressCallback);
+    }
+
+    return result;
 }
 
 }
 
 QString DVRVolumeLoader::getFile()
 {
-    QString fileName = AskForFileName(tr("BIN Files (*.bin)"));
+    QString fileName = AskForFileName(tr("Volume Files (*.bin *.nrrd *.nhdr *.mhd *.mha *.dvrb);;Slice Stacks (*.tif *.tiff *.png)"));
 
     // Don't try to load a file if the dialog was cancelled or the file name is empty
     if (fileName.isNull() || fileName.isEmpty())
         return QString();
 
-    qDebug() << "Loading BIN file: " << fileName;
+    if (!QFileInfo::exists(fileName))
+        throw DataLoadException(fileName, "File was not found at location.");
 
-    // read in binary data
+    qDebug() << "Selected volume file: " << fileName;
 
-    std::ifstream in(fileName.toStdString(), std::ios::in | std::ios::binary);
-    if (in)
-    {
-        in.seekg(0, std::ios::end);
-        _contents.resize(in.tellg());
-        in.seekg(0, std::ios::beg);
-        in.read(&_contents[0], _contents.size());
-        in.close();
-    }
-    else
-    {
-        throw DataLoadException(fileName, "File was not found at location.");
+    // Only the header of self-describing files is read here, the voxel data is mapped or streamed once the dialog is accepted.
+    // The file is parsed completely before anything is assigned, such that a file that fails to parse leaves the previous selection intact.
+    std::optional<VolumeHeader> volumeHeader;
+    std::optional<BrickedVolume::Header> brickedVolumeHeader;
+    std::optional<SliceStack> sliceStack;
+
+    if (isVolumeHeaderFile(fileName))
+        volumeHeader = readVolumeHeader(fileName);
+
+    // A slice image stands for all slices of its stack, they are decoded once the dialog is accepted
+    if (isSliceImageFile(fileName))
+        sliceStack = findSliceStack(fileName);
+
+    if (BrickedVolume::isBrickedVolumeFile(fileName)) {
+        QFile file(fileName);
+
+        if (!file.open(QIODevice::ReadOnly))
+            throw DataLoadException(fileName, "File could not be opened.");
+
+        try {
+            brickedVolumeHeader = BrickedVolume::readHeader(file);
+        }
+        catch (const std::runtime_error& e) {
+            throw DataLoadException(fileName, e.what());
+        }
+
+        const auto& elementTypeNames = PointData::getElementTypeNames();
+
+        if (std::find(elementTypeNames.begin(), elementTypeNames.end(), brickedVolumeHeader->elementTypeName.toStdString()) == elementTypeNames.end())
+            throw DataLoadException(fileName, QString("Element type %1 is not supported by point data.").arg(brickedVolumeHeader->elementTypeName));
     }
+
+    _fileName               = fileName;
+    _volumeHeader           = volumeHeader;
+    _brickedVolumeHeader    = brickedVolumeHeader;
+    _sliceStack             = sliceStack;
+
     return QFileInfo(fileName).baseName();
 }
 
+QStringList DVRVolumeLoader::getHDF5File()
+{
+#ifdef USE_HDF5
+    QString fileName = AskForFileName(tr("HDF5 Files (*.h5 *.hdf5 *.he5)"));
+
+    if (fileName.isNull() || fileName.isEmpty())
+        return QStringList();
+
+    // Only the arrays are listed here, they are read in blocks once the dialog is accepted
+    const auto arrays = listHDF5Arrays(fileName);
+
+    if (arrays.isEmpty())
+        throw DataLoadException(fileName, "The file has no numeric arrays with one or two dimensions.");
+
+    qDebug() << "Selected HDF5 file: " << fileName << "with arrays" << arrays;
+
+    _hdf5FileName = fileName;
+
+    return arrays;
+#else
+    throw DataLoadException(QString(), "This build does not support HDF5 files (enable USE_HDF5).");
+#endif
+}
+
 void DVRVolumeLoader::loadData()
 {
     DVRVolumeLoadingInputDialog* inputDialog = new DVRVolumeLoadingInputDialog(nullptr, *this);
@@ -157,109 +1320,176 @@ void DVRVolumeLoader::loadData()
     connect(inputDialog, &QDialog::accepted, this, [this, inputDialog]() -> void {
 
         if (!inputDialog->getDatasetName().isEmpty()) {
+            const auto datasetName = inputDialog->getDatasetName();
             auto sourceDataset = inputDialog->getSourceDataset();
-            auto numDims = inputDialog->getNumberOfValueDimensions();
-            auto storeAs = inputDialog->getStoreAs();
+
+            LoadSettings settings;
+
+            settings.datasetSource          = inputDialog->getDatasetSource();
+            settings.width                  = inputDialog->getNumberOfDimensionsX();
+            settings.height                 = inputDialog->getNumberOfDimensionsY();
+            settings.depth                  = inputDialog->getNumberOfDimensionsZ();
+            settings.valueDimensions        = inputDialog->getNumberOfValueDimensions();
+            settings.storeAs                = inputDialog->getStoreAs();
+            settings.dataType               = inputDialog->getDataType();
+            settings.ingestMode             = inputDialog->getIngestMode();
+            settings.slabDepth              = inputDialog->getSlabDepth();
+            settings.components             = inputDialog->getComponents();
+            settings.timeSeries             = settings.datasetSource == DatasetSource::File && inputDialog->getTimeSeries();
+            settings.numPrefetchedTimesteps = inputDialog->getNumberOfPrefetchedTimesteps();
+            settings.quantize               = inputDialog->getQuantize();
+            settings.useCache               = inputDialog->getUseCache();
+            settings.maximumCacheSize       = qint64(inputDialog->getCacheSize()) << 30;
+            settings.voxelizationKernel     = inputDialog->getVoxelizationKernel();
+            settings.fillGaps               = inputDialog->getFillGaps();
+            settings.spatialDataset         = inputDialog->getSpatialDataset();
+            settings.valueDataset           = inputDialog->getValueDataset();
+            settings.fileName               = _fileName;
+            settings.volumeHeader           = _volumeHeader;
+            settings.brickedVolumeHeader    = _brickedVolumeHeader;
+            settings.sliceStack             = _sliceStack;
+            settings.hdf5FileName           = _hdf5FileName;
+            settings.positionsArray         = inputDialog->getPositionsArray();
+            settings.valuesArray            = inputDialog->getValuesArray();
+            settings.resampleSize           = inputDialog->getResampleSize();
+            settings.resampleFilter         = inputDialog->getResampleFilter();
+
+            // The crop region is checked before loading, such that a typo does not cost a complete load
+            if (inputDialog->getResample()) {
+                try {
+                    settings.resampleRegion = parseCropRegion(inputDialog->getCropRegion(), settings.getVolumeSize());
+                }
+                catch (const std::exception& e) {
+                    exceptionMessageBox("Unable to resample the volume", e);
+                    return;
+                }
+            }
 
             Dataset<Points> point_data;
 
             if (sourceDataset.isValid())
-                point_data = mv::data().createDerivedDataset<Points>(inputDialog->getDatasetName(), sourceDataset);
+                point_data = mv::data().createDerivedDataset<Points>(datasetName, sourceDataset);
             else
-                point_data = mv::data().createDataset<Points>("Points", inputDialog->getDatasetName());
-
-
-            Size3D volumeBoxSize = Size3D(inputDialog->getNumberOfDimensionsX(), inputDialog->getNumberOfDimensionsY(), inputDialog->getNumberOfDimensionsZ());
-            int valueDimensions = inputDialog->getNumberOfValueDimensions();
-
-            if (inputDialog->getDatasetSource() == DatasetSource::PointDatasets) {
-                Dataset<Points> spatialDataset = inputDialog->getSpatialDataset();
-                Dataset<Points> valueDataset = inputDialog->getValueDataset();
-
-                mv::Vector3f min = mv::Vector3f(FLT_MAX, FLT_MAX, FLT_MAX);
-                mv::Vector3f max = mv::Vector3f(FLT_MIN, FLT_MIN, FLT_MIN);
-                std::vector<float> spatialPositions;
-                spatialDataset->visitData([&min, &max, &spatialPositions](auto pointData) {
-                    for (const auto& point : pointData)
-                    {
-                        min.x = std::min(min.x, static_cast<float>(point[0]));
-                        min.y = std::min(min.y, static_cast<float>(point[1]));
-                        min.z = std::min(min.z, static_cast<float>(point[2]));
-                        max.x = std::max(max.x, static_cast<float>(point[0]));
-                        max.y = std::max(max.y, static_cast<float>(point[1]));
-                        max.z = std::max(max.z, static_cast<float>(point[2]));
-
-                        for (auto& value : point) {
-                            spatialPositions.push_back(value);
-                        }
+                point_data = mv::data().createDataset<Points>("Points", datasetName);
+
+            auto& task = point_data->getTask();
+
+            task.setName("Loading " + datasetName);
+            task.setMayKill(true);
+            task.setRunning();
+
+            // Update the dataset task from the worker thread, the task forwards the progress to the GUI and the abort request of the user back
+            const ProgressCallback progressCallback = [&task](float progress) -> bool {
+                task.setProgress(progress);
+                task.setProgressDescription(QString("Loading (%1%)").arg(static_cast<int>(progress * 100.0f)));
+                return !task.isAborting();
+            };
+
+            const ProgressCallback resampleProgressCallback = [&task](float progress) -> bool {
+                task.setProgress(progress);
+                task.setProgressDescription(QString("Resampling (%1%)").arg(static_cast<int>(progress * 100.0f)));
+                return !task.isAborting();
+            };
+
+            // The file reading, conversion and voxelization run on a worker thread such that the GUI stays responsive, the result is published back on the GUI thread
+            auto* loadWatcher = new QFutureWatcher<LoadResult>(this);
+
+            connect(loadWatcher, &QFutureWatcher<LoadResult>::finished, this, [this, loadWatcher, point_data, settings, datasetName]() mutable -> void {
+                LoadResult result = loadWatcher->result();
+
+                loadWatcher->deleteLater();
+
+                auto& task = point_data->getTask();
+
+                if (result.error) {
+                    task.setAborted();
+                    mv::data().removeDataset(point_data);
+
+                    try {
+                        std::rethrow_exception(result.error);
                     }
-                });
-                std::vector<float> newDataset(volumeBoxSize.width() * volumeBoxSize.height() * volumeBoxSize.depth() * valueDimensions, 0.0f);
-                std::vector<float> numValuesPlaced(volumeBoxSize.width() * volumeBoxSize.height() * volumeBoxSize.depth() * valueDimensions, 0.0f);
-                int i = 0;
-                valueDataset->visitData([this, &spatialPositions, &numValuesPlaced, &newDataset, &min, &max, &volumeBoxSize, &valueDimensions, &i](auto pointData) {
-                    for (const auto& point : pointData)
-                    {
-                        mv::Vector3f normalizedPos = normalizePosition(mv::Vector3f(spatialPositions[i], spatialPositions[i + 1], spatialPositions[i + 2]), min, max, volumeBoxSize);
-                        int x = int(std::round(normalizedPos.x));
-                        int y = int(std::round(normalizedPos.y));
-                        int z = int(std::round(normalizedPos.z));
-                        int voxelIndex = x + y * volumeBoxSize.width() + z * volumeBoxSize.width() * volumeBoxSize.height();
-                        //Populate the texture data with values 
-                        for (int j = 0; j < valueDimensions; ++j) {
-                            newDataset[voxelIndex * valueDimensions + j] += point[j];
-                            numValuesPlaced[voxelIndex * valueDimensions + j] += 1;
-                        }
-                        i = i + 3;
+                    catch (const std::exception& e) {
+                        exceptionMessageBox(result.errorTitle, e);
                     }
-                });
 
-                for (size_t i = 0; i < numValuesPlaced.size(); ++i) { // Average the values
-                    if(numValuesPlaced[i] != 0) {
-                        newDataset[i] = newDataset[i] / numValuesPlaced[i];
-                    }
+                    return;
                 }
-                point_data->setData(newDataset, valueDimensions);
-            }
-            else {
 
-                if (inputDialog->getDataType() == BinaryDataType::FLOAT)
-                {
-                    recursiveReadDataAndAddToCore<float>(storeAs, point_data, numDims, _contents);
+                if (!result.loaded) {
+                    qDebug() << "DVRVolumeLoader::loadData: Loading was cancelled";
+                    task.setAborted();
+                    mv::data().removeDataset(point_data);
+                    return;
                 }
-                else if (inputDialog->getDataType() == BinaryDataType::UBYTE)
-                {
-                    recursiveReadDataAndAddToCore<unsigned char>(storeAs, point_data, numDims, _contents);
-                }
-                else if (inputDialog->getDataType() == BinaryDataType::UINT16)
-                {
-                    recursiveReadDataAndAddToCore<std::uint16_t>(storeAs, point_data, numDims, _contents);
+
+                events().notifyDatasetDataChanged(point_data);
+
+                qDebug() << "Number of dimensions: " << point_data->getNumDimensions();
+                qDebug() << "Volume loaded. Num data points: " << point_data->getNumPoints();
+
+                task.setFinished();
+
+                //Create the Volumes dataset
+                auto volumeDataset = mv::data().createDataset<Volumes>("Volumes", datasetName, point_data);
+
+                volumeDataset->setVolumeSize(settings.getVolumeSize());
+                volumeDataset->setComponentsPerVoxel(point_data->getNumDimensions());
+
+                setStatisticsProperties(volumeDataset, result.statistics);
+                setOccupancyProperties(volumeDataset, result.occupancy);
+
+                // The other timesteps of a series are decoded on demand, the time series lives as long as the datasets
+                if (settings.timeSeries) {
+
+                    // The series starts at the loaded file
+                    auto fileNames = findNumberedFiles(settings.fileName);
+                    fileNames = fileNames.mid(std::max(0, static_cast<int>(fileNames.indexOf(QFileInfo(settings.fileName).absoluteFilePath()))));
+
+                    if (fileNames.size() > 1)
+                        new TimeSeries(fileNames, makeTimeSeriesDecoder(settings), point_data, volumeDataset, settings.numPrefetchedTimesteps);
+                    else
+                        qWarning() << "DVRVolumeLoader::loadData: No further timesteps found after" << settings.fileName;
                 }
-            }
 
-            //Create the Volumes dataset
-            auto volumeDataset = mv::data().createDataset<Volumes>("Volumes", inputDialog->getDatasetName(), point_data);
+                events().notifyDatasetDataChanged(volumeDataset);
+
+                _volumesDataset = volumeDataset;
+
+                if (!result.cacheKey.isEmpty())
+                    writeCachedVolumeInBackground(result.cacheKey, point_data, result.statistics, settings.maximumCacheSize, this);
+
+                // The resampled copy becomes a child of the loaded volume, which stays available at full resolution
+                if (settings.resampleRegion) {
+                    auto& resampled = result.resampled;
 
-            volumeDataset->setVolumeSize(volumeBoxSize);
-            volumeDataset->setComponentsPerVoxel(valueDimensions);
+                    if (!resampled.error.isEmpty()) {
+                        exceptionMessageBox("Unable to resample the volume", std::runtime_error(resampled.error.toStdString()));
+                    }
+                    else if (!resampled.isValid()) {
+                        qDebug() << "DVRVolumeLoader::loadData: Resampling was cancelled";
+                    }
+                    else {
+                        resampled.source = volumeDataset;
 
-            events().notifyDatasetDataChanged(volumeDataset);
+                        try {
+                            VolumeResampling::createResampledVolume(resampled);
+                        }
+                        catch (const std::exception& e) {
+                            exceptionMessageBox("Unable to resample the volume", e);
+                        }
+                    }
+                }
+            });
 
-            _volumesDataset = volumeDataset;
+            loadWatcher->setFuture(QtConcurrent::run([settings, point_data, progressCallback, resampleProgressCallback]() -> LoadResult {
+                return runLoad(settings, point_data, progressCallback, resampleProgressCallback);
+            }));
         } else { qWarning() << "DVRVolumeLoader::loadData: No dataset name provided."; }
     });
 
     inputDialog->open();
 }
 
-mv::Vector3f DVRVolumeLoader::normalizePosition(const mv::Vector3f& pos, mv::Vector3f min, mv::Vector3f max, Size3D size) {
-    mv::Vector3f normalizedPos;
-    normalizedPos.x = (pos.x - min.x) / (max.x - min.x) * (size.width() - 1);
-    normalizedPos.y = (pos.y - min.y) / (max.y - min.y) * (size.height() - 1);
-    normalizedPos.z = (pos.z - min.z) / (max.z - min.z) * (size.depth() - 1);
-    return normalizedPos;
-}
-
 // =============================================================================
 // Factory
 // =============================================================================
@@ -294,15 +1524,35 @@ DVRVolumeLoadingInputDialog::DVRVolumeLoadingInputDialog(QWidget* parent, DVRVol
     _numberOfDimensionsYAction(this, "Number of dimensions (Y)", 1, 1000000, 1),
     _numberOfDimensionsZAction(this, "Number of dimensions (Z)", 1, 1000000, 1),
     _storeAsAction(this, "Store as"),
+    _quantizeAction(this, "Quantize", false),
+    _ingestModeAction(this, "Ingest mode", { "Memory mapped", "Streaming" }),
+    _slabDepthAction(this, "Slab depth (Z)", 1, 1000000, 16),
+    _componentsAction(this, "Components"),
+    _timeSeriesAction(this, "Time series", false),
+    _prefetchTimestepsAction(this, "Prefetch timesteps", 0, 16, 2),
+    _useCacheAction(this, "Cache converted volume", false),
+    _cacheSizeAction(this, "Cache size (GB)", 1, 4096, 64),
+    _resampleAction(this, "Resample", false),
+    _resampleSizeAction(this, "Resample size", 1, 16384, 512),
+    _resampleFilterAction(this, "Resample filter", { "Box", "Trilinear", "Max" }),
+    _cropRegionAction(this, "Crop region"),
+    _voxelizationKernelAction(this, "Voxelization", { "Nearest (average)", "Trilinear splat", "Maximum", "Minimum" }),
+    _fillGapsAction(this, "Fill empty voxels", false),
     _isDerivedAction(this, "Mark as derived", false),
     _sourceDatasetPickerAction(this, "Source dataset"),
     _spatialDatasetPickerAction(this, "Spatial dataset"),
     _valueDatasetPickerAction(this, "Value dataset"),
+    _positionsArrayAction(this, "Positions"),
+    _valuesArrayAction(this, "Values"),
+    _hdf5FileLoadAction(this, "Load HDF5 File"),
     _acceptAction(this, "Accept"),
     _fileLoadAction(this, "Load File"),
     _settingsGroupAction(this, "Settings"),
     _fileGroupAction(this, "File selection"),
     _datasetGroupAction(this, "Dataset selection"),
+    _hdf5GroupAction(this, "HDF5 selection"),
+    _hasSliceStack(false),
+    _hdf5FileRadioButton(nullptr),
     _selectedWidget(nullptr)
 {
     setWindowTitle(tr("DVRVolume Loader"));
@@ -311,6 +1561,29 @@ DVRVolumeLoadingInputDialog::DVRVolumeLoadingInputDialog(QWidget* parent, DVRVol
     _numberOfDimensionsYAction.setDefaultWidgetFlags(IntegralAction::WidgetFlag::SpinBox);
     _numberOfDimensionsZAction.setDefaultWidgetFlags(IntegralAction::WidgetFlag::SpinBox);
     _numberOfValueDimensionsAction.setDefaultWidgetFlags(IntegralAction::WidgetFlag::SpinBox);
+    _slabDepthAction.setDefaultWidgetFlags(IntegralAction::WidgetFlag::SpinBox);
+
+    _ingestModeAction.setToolTip("Memory mapped converts the whole file at once, streaming reads it in slabs of z-slices and can be cancelled");
+    _slabDepthAction.setToolTip("Number of z-slices that are read and converted per slab when streaming");
+    _componentsAction.setToolTip("Comma separated list of the value dimensions that are loaded, with ranges such as \"0-7, 12\". Leave empty to load all value dimensions");
+    _componentsAction.setPlaceHolderString("All");
+    _timeSeriesAction.setToolTip("Load the selected file as the first timestep of a series, the next timesteps are the files next to it whose names only differ in a higher trailing number");
+    _prefetchTimestepsAction.setToolTip("Number of timesteps after the shown timestep that are decoded ahead in the background");
+    _prefetchTimestepsAction.setDefaultWidgetFlags(IntegralAction::WidgetFlag::SpinBox);
+    _useCacheAction.setToolTip("Keep the converted volume on disk, such that loading the same file with the same settings again skips the conversion.\nThe converted volume takes as much disk space as it takes memory, bricked volumes are never cached.");
+    _cacheSizeAction.setToolTip("Disk space of the cache of converted volumes, the least recently used volumes are removed beyond it");
+    _cacheSizeAction.setDefaultWidgetFlags(IntegralAction::WidgetFlag::SpinBox);
+    _resampleAction.setToolTip("Also create a resampled copy of the volume, for volumes that do not fit on the GPU at full resolution");
+    _resampleSizeAction.setToolTip("Number of voxels along the longest axis of the resampled copy, the other axes keep their aspect ratio");
+    _resampleSizeAction.setDefaultWidgetFlags(IntegralAction::WidgetFlag::SpinBox);
+    _resampleFilterAction.setToolTip("Filter used to resample the volume, max keeps thin bright structures visible");
+    _cropRegionAction.setToolTip("Inclusive voxel range per axis of the part of the volume that is resampled, such as \"0-255, 0-255, 100-199\". Leave empty to resample the whole volume");
+    _cropRegionAction.setPlaceHolderString("Whole volume");
+    _voxelizationKernelAction.setToolTip("How the values of the points are combined into voxels");
+    _fillGapsAction.setToolTip("Give voxels without points the values of the nearest voxel with points");
+    _positionsArrayAction.setToolTip("Array of the HDF5 file with one point per row and the x, y and z coordinates in the first three columns");
+    _valuesArrayAction.setToolTip("Array of the HDF5 file with one point per row and a value per column, all columns are loaded");
+    _quantizeAction.setToolTip("Map the value range of every dimension onto the full range of the integer storage type, the scale and offset to recover the values are stored as dataset properties");
 
     QStringList pointDataTypes;
     for (const char* const typeName : PointData::getElementTypeNames())
@@ -326,6 +1599,17 @@ DVRVolumeLoadingInputDialog::DVRVolumeLoadingInputDialog(QWidget* parent, DVRVol
     _numberOfDimensionsYAction.setValue(dvrVolumeLoader.getSetting("NumberOfDimensionsY").toInt());
     _numberOfDimensionsZAction.setValue(dvrVolumeLoader.getSetting("NumberOfDimensionsZ").toInt());
     _storeAsAction.setCurrentIndex(dvrVolumeLoader.getSetting("StoreAs").toInt());
+    _ingestModeAction.setCurrentIndex(dvrVolumeLoader.getSetting("IngestMode", 0).toInt());
+    _slabDepthAction.setValue(dvrVolumeLoader.getSetting("SlabDepth", 16).toInt());
+    _voxelizationKernelAction.setCurrentIndex(dvrVolumeLoader.getSetting("VoxelizationKernel", 0).toInt());
+    _fillGapsAction.setChecked(dvrVolumeLoader.getSetting("FillGaps", false).toBool());
+    _quantizeAction.setChecked(dvrVolumeLoader.getSetting("Quantize", false).toBool());
+    _prefetchTimestepsAction.setValue(dvrVolumeLoader.getSetting("PrefetchTimesteps", 2).toInt());
+    _useCacheAction.setChecked(dvrVolumeLoader.getSetting("UseCache", false).toBool());
+    _cacheSizeAction.setValue(dvrVolumeLoader.getSetting("CacheSize", 64).toInt());
+    _resampleAction.setChecked(dvrVolumeLoader.getSetting("Resample", false).toBool());
+    _resampleSizeAction.setValue(dvrVolumeLoader.getSetting("ResampleSize", 512).toInt());
+    _resampleFilterAction.setCurrentIndex(dvrVolumeLoader.getSetting("ResampleFilter", 0).toInt());
 
     _settingsGroupAction.addAction(&_dataTypeAction);
     _settingsGroupAction.addAction(&_numberOfValueDimensionsAction);
@@ -333,6 +1617,11 @@ DVRVolumeLoadingInputDialog::DVRVolumeLoadingInputDialog(QWidget* parent, DVRVol
     _settingsGroupAction.addAction(&_numberOfDimensionsYAction);
     _settingsGroupAction.addAction(&_numberOfDimensionsZAction);
     _settingsGroupAction.addAction(&_storeAsAction);
+    _settingsGroupAction.addAction(&_quantizeAction);
+    _settingsGroupAction.addAction(&_resampleAction);
+    _settingsGroupAction.addAction(&_resampleSizeAction);
+    _settingsGroupAction.addAction(&_resampleFilterAction);
+    _settingsGroupAction.addAction(&_cropRegionAction);
     _settingsGroupAction.addAction(&_isDerivedAction);
     _settingsGroupAction.addAction(&_sourceDatasetPickerAction);
     _settingsGroupAction.addAction(&_datasetNameAction);
@@ -345,6 +1634,11 @@ DVRVolumeLoadingInputDialog::DVRVolumeLoadingInputDialog(QWidget* parent, DVRVol
     _dataSourceButtonGroup->addButton(_fileRadioButton, DatasetSource::File);
     _dataSourceButtonGroup->addButton(_pointDatasetsRadioButton, DatasetSource::PointDatasets);
 
+#ifdef USE_HDF5
+    _hdf5FileRadioButton = new QRadioButton(tr("HDF5 File"), this);
+    _dataSourceButtonGroup->addButton(_hdf5FileRadioButton, DatasetSource::HDF5File);
+#endif
+
     _fileRadioButton->setChecked(true); // Default to None
 
     auto layout = new QVBoxLayout();
@@ -356,8 +1650,18 @@ DVRVolumeLoadingInputDialog::DVRVolumeLoadingInputDialog(QWidget* parent, DVRVol
     buttonsLayout->setContentsMargins(150, 0, 0, 0);
     buttonsLayout->addWidget(_fileRadioButton);
     buttonsLayout->addWidget(_pointDatasetsRadioButton);
+
+    if (_hdf5FileRadioButton)
+        buttonsLayout->addWidget(_hdf5FileRadioButton);
     layout->addLayout(buttonsLayout);
 
+    _fileGroupAction.addAction(&_ingestModeAction);
+    _fileGroupAction.addAction(&_slabDepthAction);
+    _fileGroupAction.addAction(&_componentsAction);
+    _fileGroupAction.addAction(&_timeSeriesAction);
+    _fileGroupAction.addAction(&_prefetchTimestepsAction);
+    _fileGroupAction.addAction(&_useCacheAction);
+    _fileGroupAction.addAction(&_cacheSizeAction);
     _fileGroupAction.addAction(&_fileLoadAction);
     _fileGroupAction.addAction(&_acceptAction);
 
@@ -367,15 +1671,45 @@ DVRVolumeLoadingInputDialog::DVRVolumeLoadingInputDialog(QWidget* parent, DVRVol
 
     _datasetGroupAction.addAction(&_spatialDatasetPickerAction);
     _datasetGroupAction.addAction(&_valueDatasetPickerAction);
+    _datasetGroupAction.addAction(&_voxelizationKernelAction);
+    _datasetGroupAction.addAction(&_fillGapsAction);
     _datasetGroupAction.addAction(&_acceptAction);
 
+    _hdf5GroupAction.addAction(&_hdf5FileLoadAction);
+    _hdf5GroupAction.addAction(&_positionsArrayAction);
+    _hdf5GroupAction.addAction(&_valuesArrayAction);
+    _hdf5GroupAction.addAction(&_voxelizationKernelAction);
+    _hdf5GroupAction.addAction(&_fillGapsAction);
+    _hdf5GroupAction.addAction(&_acceptAction);
+
     _selectedWidget = _fileGroupAction.createWidget(this);
     layout->addWidget(_selectedWidget);
     setLayout(layout);
 
     // Add functionality to the file button
     connect(&_fileLoadAction, &TriggerAction::triggered, &dvrVolumeLoader, [this, &dvrVolumeLoader]() -> void {
-        _datasetNameAction.setString(dvrVolumeLoader.getFile());
+        try {
+            _datasetNameAction.setString(dvrVolumeLoader.getFile());
+        }
+        catch (const std::exception& e) {
+            exceptionMessageBox("Unable to open the volume file", e);
+        }
+
+        setVolumeHeader(dvrVolumeLoader.getVolumeHeader());
+        setBrickedVolumeHeader(dvrVolumeLoader.getBrickedVolumeHeader());
+        setSliceStack(dvrVolumeLoader.getSliceStack());
+        });
+
+    connect(&_hdf5FileLoadAction, &TriggerAction::triggered, &dvrVolumeLoader, [this, &dvrVolumeLoader]() -> void {
+        try {
+            const auto arrays = dvrVolumeLoader.getHDF5File();
+
+            if (!arrays.isEmpty())
+                setHDF5Arrays(arrays);
+        }
+        catch (const std::exception& e) {
+            exceptionMessageBox("Unable to open the HDF5 file", e);
+        }
         });
 
     //Update the selected widget when a radio button is clicked
@@ -392,6 +1726,9 @@ DVRVolumeLoadingInputDialog::DVRVolumeLoadingInputDialog(QWidget* parent, DVRVol
         else if (_datasetSource == DatasetSource::PointDatasets) {
             _selectedWidget = _datasetGroupAction.createWidget(this);
         }
+        else if (_datasetSource == DatasetSource::HDF5File) {
+            _selectedWidget = _hdf5GroupAction.createWidget(this);
+        }
         layout->addWidget(_selectedWidget);
         layout->update();
         });
@@ -423,6 +1760,43 @@ DVRVolumeLoadingInputDialog::DVRVolumeLoadingInputDialog(QWidget* parent, DVRVol
     // Update dataset picker at startup
     updateDatasetPicker();
 
+    // The slab depth only applies to streaming
+    const auto updateSlabDepth = [this]() -> void {
+        _slabDepthAction.setEnabled(!_hasSliceStack && getIngestMode() == IngestMode::Streaming);
+        };
+
+    connect(&_ingestModeAction, &OptionAction::currentIndexChanged, this, updateSlabDepth);
+
+    // The prefetch only applies to time series
+    const auto updatePrefetchTimesteps = [this]() -> void {
+        _prefetchTimestepsAction.setEnabled(getTimeSeries());
+        };
+
+    connect(&_timeSeriesAction, &ToggleAction::toggled, this, updatePrefetchTimesteps);
+    connect(&_timeSeriesAction, &ToggleAction::enabledChanged, this, updatePrefetchTimesteps);
+
+    updatePrefetchTimesteps();
+
+    // The cache size only applies when caching
+    const auto updateCacheSize = [this]() -> void {
+        _cacheSizeAction.setEnabled(getUseCache());
+        };
+
+    connect(&_useCacheAction, &ToggleAction::toggled, this, updateCacheSize);
+    connect(&_useCacheAction, &ToggleAction::enabledChanged, this, updateCacheSize);
+
+    updateCacheSize();
+
+    updateSlabDepth();
+
+    connect(&_storeAsAction, &OptionAction::currentIndexChanged, this, &DVRVolumeLoadingInputDialog::updateQuantizeAction);
+
+    updateQuantizeAction();
+
+    connect(&_resampleAction, &ToggleAction::toggled, this, &DVRVolumeLoadingInputDialog::updateResampleActions);
+
+    updateResampleActions();
+
     // Accept when the load action is triggered
     connect(&_acceptAction, &TriggerAction::triggered, this, [this, &dvrVolumeLoader]() {
 
@@ -433,8 +1807,126 @@ DVRVolumeLoadingInputDialog::DVRVolumeLoadingInputDialog(QWidget* parent, DVRVol
         dvrVolumeLoader.setSetting("NumberOfDimensionsY", _numberOfDimensionsYAction.getValue());
         dvrVolumeLoader.setSetting("NumberOfDimensionsZ", _numberOfDimensionsZAction.getValue());
         dvrVolumeLoader.setSetting("StoreAs", _storeAsAction.getCurrentIndex());
+        dvrVolumeLoader.setSetting("IngestMode", _ingestModeAction.getCurrentIndex());
+        dvrVolumeLoader.setSetting("SlabDepth", _slabDepthAction.getValue());
+        dvrVolumeLoader.setSetting("VoxelizationKernel", _voxelizationKernelAction.getCurrentIndex());
+        dvrVolumeLoader.setSetting("FillGaps", _fillGapsAction.isChecked());
+        dvrVolumeLoader.setSetting("Quantize", _quantizeAction.isChecked());
+        dvrVolumeLoader.setSetting("PrefetchTimesteps", _prefetchTimestepsAction.getValue());
+        dvrVolumeLoader.setSetting("UseCache", _useCacheAction.isChecked());
+        dvrVolumeLoader.setSetting("CacheSize", _cacheSizeAction.getValue());
+        dvrVolumeLoader.setSetting("Resample", _resampleAction.isChecked());
+        dvrVolumeLoader.setSetting("ResampleSize", _resampleSizeAction.getValue());
+        dvrVolumeLoader.setSetting("ResampleFilter", _resampleFilterAction.getCurrentIndex());
 
         accept();
     });
 }
 
+void DVRVolumeLoadingInputDialog::setVolumeHeader(const std::optional<VolumeHeader>& volumeHeader)
+{
+    if (volumeHeader) {
+        _numberOfDimensionsXAction.setValue(volumeHeader->sizeX);
+        _numberOfDimensionsYAction.setValue(volumeHeader->sizeY);
+        _numberOfDimensionsZAction.setValue(volumeHeader->sizeZ);
+        _numberOfValueDimensionsAction.setValue(volumeHeader->numComponents);
+
+        if (volumeHeader->dataType == BinaryDataType::FLOAT)
+            _dataTypeAction.setCurrentIndex(0);
+        else if (volumeHeader->dataType == BinaryDataType::UINT16)
+            _dataTypeAction.setCurrentIndex(1);
+        else
+            _dataTypeAction.setCurrentIndex(2);
+    }
+
+    // Values described by the header can not be edited, raw BIN files still need them from the user
+    const bool isEditable = !volumeHeader.has_value();
+
+    _dataTypeAction.setEnabled(isEditable);
+    _numberOfValueDimensionsAction.setEnabled(isEditable);
+    _numberOfDimensionsXAction.setEnabled(isEditable);
+    _numberOfDimensionsYAction.setEnabled(isEditable);
+    _numberOfDimensionsZAction.setEnabled(isEditable);
+}
+
+void DVRVolumeLoadingInputDialog::setBrickedVolumeHeader(const std::optional<BrickedVolume::Header>& brickedVolumeHeader)
+{
+    if (brickedVolumeHeader) {
+        _numberOfDimensionsXAction.setValue(brickedVolumeHeader->sizeX);
+        _numberOfDimensionsYAction.setValue(brickedVolumeHeader->sizeY);
+        _numberOfDimensionsZAction.setValue(brickedVolumeHeader->sizeZ);
+        _numberOfValueDimensionsAction.setValue(brickedVolumeHeader->numComponents);
+        _storeAsAction.setCurrentText(brickedVolumeHeader->elementTypeName);
+
+        _dataTypeAction.setEnabled(false);
+        _numberOfValueDimensionsAction.setEnabled(false);
+        _numberOfDimensionsXAction.setEnabled(false);
+        _numberOfDimensionsYAction.setEnabled(false);
+        _numberOfDimensionsZAction.setEnabled(false);
+    }
+
+    // Bricked volumes are always loaded with the element type and components they were exported with
+    _storeAsAction.setEnabled(!brickedVolumeHeader.has_value());
+    _componentsAction.setEnabled(!brickedVolumeHeader.has_value());
+    _timeSeriesAction.setEnabled(!brickedVolumeHeader.has_value());
+    _useCacheAction.setEnabled(!brickedVolumeHeader.has_value());
+
+    updateQuantizeAction();
+}
+
+void DVRVolumeLoadingInputDialog::setSliceStack(const std::optional<SliceStack>& sliceStack)
+{
+    _hasSliceStack = sliceStack.has_value();
+
+    // Slices are decoded in parallel straight into the point data, so they are never read as slabs
+    _ingestModeAction.setEnabled(!_hasSliceStack);
+    _slabDepthAction.setEnabled(!_hasSliceStack && getIngestMode() == IngestMode::Streaming);
+
+    updateQuantizeAction();
+
+    if (!sliceStack)
+        return;
+
+    _numberOfDimensionsXAction.setValue(sliceStack->sizeX);
+    _numberOfDimensionsYAction.setValue(sliceStack->sizeY);
+    _numberOfDimensionsZAction.setValue(sliceStack->getNumberOfSlices());
+    _numberOfValueDimensionsAction.setValue(1);
+    _dataTypeAction.setCurrentIndex(sliceStack->dataType == BinaryDataType::UINT16 ? 1 : 2);
+
+    _dataTypeAction.setEnabled(false);
+    _numberOfValueDimensionsAction.setEnabled(false);
+    _numberOfDimensionsXAction.setEnabled(false);
+    _numberOfDimensionsYAction.setEnabled(false);
+    _numberOfDimensionsZAction.setEnabled(false);
+
+    // Slices have a single component and a stack is a single timestep
+    _componentsAction.setEnabled(false);
+    _timeSeriesAction.setEnabled(false);
+}
+
+void DVRVolumeLoadingInputDialog::setHDF5Arrays(const QStringList& arrays)
+{
+    static const QRegularExpression positionName("coord|pos|xyz|spatial", QRegularExpression::CaseInsensitiveOption);
+
+    _positionsArrayAction.setOptions(arrays);
+    _valuesArrayAction.setOptions(arrays);
+
+    const auto positionsIndex = std::max(static_cast<int>(arrays.indexOf(positionName)), 0);
+
+    _positionsArrayAction.setCurrentIndex(positionsIndex);
+    _valuesArrayAction.setCurrentIndex(arrays.size() > 1 && positionsIndex == 0 ? 1 : 0);
+}
+
+void DVRVolumeLoadingInputDialog::updateQuantizeAction()
+{
+    // Only integer types benefit from quantization, floating point types store the values as they are.
+    // Slices are converted as soon as they are decoded, before the value range of the stack is known.
+    _quantizeAction.setEnabled(_storeAsAction.isEnabled() && !_hasSliceStack && !getStoreAs().contains("float"));
+}
+
+void DVRVolumeLoadingInputDialog::updateResampleActions()
+{
+    _resampleSizeAction.setEnabled(_resampleAction.isChecked());
+    _resampleFilterAction.setEnabled(_resampleAction.isChecked());
+    _cropRegionAction.setEnabled(_resampleAction.isChecked());
+}
@@ -15,6 +15,15 @@
 
 #include <VolumeData/Volumes.h>
 
+#include "SliceStack.h"
+#include "VolumeHeader.h"
+#include "Voxelizer.h"
+
+#include <BrickedVolume.h>
+#include <VolumeResampling.h>
+
+#include <optional>
+
 using namespace mv::plugin;
 
 // =============================================================================
@@ -23,14 +32,14 @@ using namespace mv::plugin;
 
 class DVRVolumeLoader;
 
-enum BinaryDataType
+enum DatasetSource
 {
-    FLOAT, UBYTE, UINT16
+    File, PointDatasets, HDF5File
 };
 
-enum DatasetSource
+enum IngestMode
 {
-    File, PointDatasets
+    MemoryMapped, Streaming
 };
 
 class DVRVolumeLoadingInputDialog : public QDialog
@@ -94,6 +103,113 @@ public:
         return _storeAsAction.getCurrentText();
     }
 
+    /** Get whether the values are quantized into the full range of the (integer) storage type */
+    bool getQuantize() const {
+        return _quantizeAction.isEnabled() && _quantizeAction.isChecked();
+    }
+
+    /** Get how the binary file is read */
+    IngestMode getIngestMode() const {
+        return static_cast<IngestMode>(_ingestModeAction.getCurrentIndex());
+    }
+
+    /** Get the number of z-slices that are read per slab when streaming */
+    std::int32_t getSlabDepth() const {
+        return _slabDepthAction.getValue();
+    }
+
+    /** Get the value dimensions that are loaded from the file as a list of indices and ranges such as "0-7, 12", empty loads all of them */
+    QString getComponents() const {
+        return _componentsAction.isEnabled() ? _componentsAction.getString().trimmed() : QString();
+    }
+
+    /** Get whether the file is loaded as the first timestep of a time series */
+    bool getTimeSeries() const {
+        return _timeSeriesAction.isEnabled() && _timeSeriesAction.isChecked();
+    }
+
+    /** Get the number of timesteps that are decoded ahead of the shown timestep */
+    std::int32_t getNumberOfPrefetchedTimesteps() const {
+        return _prefetchTimestepsAction.getValue();
+    }
+
+    /** Get whether converted files are read from and written to the on-disk cache, bricked volumes are never cached */
+    bool getUseCache() const {
+        return _useCacheAction.isEnabled() && _useCacheAction.isChecked();
+    }
+
+    /** Get the budget of the on-disk cache in gigabytes */
+    std::int32_t getCacheSize() const {
+        return _cacheSizeAction.getValue();
+    }
+
+    /** Get whether a resampled copy of the volume is created after loading */
+    bool getResample() const {
+        return _resampleAction.isChecked();
+    }
+
+    /** Get the number of voxels along the longest axis of the resampled copy */
+    std::int32_t getResampleSize() const {
+        return _resampleSizeAction.getValue();
+    }
+
+    /** Get the filter used to resample the volume */
+    VolumeResampling::Filter getResampleFilter() const {
+        return static_cast<VolumeResampling::Filter>(_resampleFilterAction.getCurrentIndex());
+    }
+
+    /** Get the region of the volume that is resampled as inclusive voxel ranges such as "0-255, 0-255, 100-199", empty resamples the whole volume */
+    QString getCropRegion() const {
+        return _cropRegionAction.getString().trimmed();
+    }
+
+    /**
+     * Fill in the volume size, number of value dimensions and data type from a self-describing header and lock them,
+     * or unlock them for manual input when there is no header
+     * @param volumeHeader Header of the selected file (if any)
+     */
+    void setVolumeHeader(const std::optional<VolumeHeader>& volumeHeader);
+
+    /**
+     * Fill in and lock the volume size, number of value dimensions and storage type from the header of a bricked volume,
+     * must be called after setVolumeHeader(...) as it only unlocks the storage type
+     * @param brickedVolumeHeader Header of the selected bricked volume (if any)
+     */
+    void setBrickedVolumeHeader(const std::optional<BrickedVolume::Header>& brickedVolumeHeader);
+
+    /**
+     * Fill in and lock the volume size, number of value dimensions and data type of a slice stack,
+     * must be called after setBrickedVolumeHeader(...) as it only locks the options that do not apply to slice stacks
+     * @param sliceStack Slice stack of the selected image (if any)
+     */
+    void setSliceStack(const std::optional<SliceStack>& sliceStack);
+
+    /** Get how point values are combined into voxels when voxelizing point datasets */
+    Voxelizer::Kernel getVoxelizationKernel() const {
+        return static_cast<Voxelizer::Kernel>(_voxelizationKernelAction.getCurrentIndex());
+    }
+
+    /** Get whether voxels without points are filled with the values of the nearest voxel with points */
+    bool getFillGaps() const {
+        return _fillGapsAction.isChecked();
+    }
+
+    /** Get the path of the coordinate array in the selected HDF5 file */
+    QString getPositionsArray() const {
+        return _positionsArrayAction.getCurrentText();
+    }
+
+    /** Get the path of the value array in the selected HDF5 file */
+    QString getValuesArray() const {
+        return _valuesArrayAction.getCurrentText();
+    }
+
+    /**
+     * Offer the arrays of the selected HDF5 file as positions and values, arrays with position-like names are picked as the positions
+     * @param arrays Paths of the numeric arrays in the file
+     */
+    void setHDF5Arrays(const QStringList& arrays);
+
     /** Get whether the dataset will be marked as derived */
     bool getIsDerived() const {
         return _isDerivedAction.isChecked();
@@ -112,6 +228,13 @@ public:
         return _valueDatasetPickerAction.getCurrentDataset();
     }
 
+protected:
+    /** Enable quantization only for integer storage types of files that are not bricked */
+    void updateQuantizeAction();
+
+    /** Enable the resample settings only when resampling */
+    void updateResampleActions();
+
 protected:
     mv::gui::StringAction            _datasetNameAction;             /** Dataset name action */
     mv::gui::OptionAction            _dataTypeAction;                /** Data type action */
@@ -120,20 +243,40 @@ protected:
     mv::gui::IntegralAction          _numberOfDimensionsYAction;     /** Number of dimensions on y-axis action */
     mv::gui::IntegralAction          _numberOfDimensionsZAction;     /** Number of dimensions on z-axis action */
     mv::gui::OptionAction            _storeAsAction;                 /** Store as action */
+    mv::gui::ToggleAction            _quantizeAction;                /** Quantize into the storage type range action */
+    mv::gui::OptionAction            _ingestModeAction;              /** Ingest mode action (memory mapped or streaming) */
+    mv::gui::IntegralAction          _slabDepthAction;               /** Number of z-slices per streamed slab action */
+    mv::gui::StringAction            _componentsAction;              /** Selection of the value dimensions that are loaded action */
+    mv::gui::ToggleAction            _timeSeriesAction;              /** Load as the first timestep of a time series action */
+    mv::gui::IntegralAction          _prefetchTimestepsAction;       /** Number of timesteps that are decoded ahead action */
+    mv::gui::ToggleAction            _useCacheAction;                /** Use the cache of converted volumes action */
+    mv::gui::IntegralAction          _cacheSizeAction;               /** Budget of the cache of converted volumes in gigabytes action */
+    mv::gui::ToggleAction            _resampleAction;                /** Create a resampled copy after loading action */
+    mv::gui::IntegralAction          _resampleSizeAction;            /** Number of voxels along the longest axis of the resampled copy action */
+    mv::gui::OptionAction            _resampleFilterAction;          /** Resample filter action */
+    mv::gui::StringAction            _cropRegionAction;              /** Region of the volume that is resampled action */
+    mv::gui::OptionAction            _voxelizationKernelAction;      /** Voxelization kernel action */
+    mv::gui::ToggleAction            _fillGapsAction;                /** Fill empty voxels action */
     mv::gui::ToggleAction            _isDerivedAction;               /** Mark dataset as derived action */
     mv::gui::DatasetPickerAction     _sourceDatasetPickerAction;     /** Dataset picker action for picking source datasets */
     mv::gui::DatasetPickerAction     _spatialDatasetPickerAction;    /** Dataset picker action for picking spatial datasets */
     mv::gui::DatasetPickerAction     _valueDatasetPickerAction;      /** Dataset picker action for picking value datasets */
+    mv::gui::OptionAction            _positionsArrayAction;          /** Coordinate array of the HDF5 file action */
+    mv::gui::OptionAction            _valuesArrayAction;             /** Value array of the HDF5 file action */
+    mv::gui::TriggerAction           _hdf5FileLoadAction;            /** HDF5 file action */
     mv::gui::TriggerAction           _acceptAction;                  /** Load action */
     mv::gui::TriggerAction           _fileLoadAction;                /** File action */
     mv::gui::GroupAction             _settingsGroupAction;           /** Shared group action */
     mv::gui::GroupAction             _fileGroupAction;               /** File specific group action */
     mv::gui::GroupAction             _datasetGroupAction;            /** Datasets specific group action */
+    mv::gui::GroupAction             _hdf5GroupAction;               /** HDF5 file specific group action */
 
     DatasetSource                    _datasetSource;                 /** Dataset source */
+    bool                             _hasSliceStack;                 /** Whether the selected file is a slice of a stack */
 
     QRadioButton*                   _fileRadioButton;                /** File radio button */
     QRadioButton*                   _pointDatasetsRadioButton;       /** Point datasets radio button */
+    QRadioButton*                   _hdf5FileRadioButton;            /** HDF5 file radio button, only when built with USE_HDF5 */
     QButtonGroup*                   _dataSourceButtonGroup;          /** Data source button group */
 
     QWidget*                        _selectedWidget;                 /** File widget */
@@ -156,9 +299,34 @@ public:
     void loadData() Q_DECL_OVERRIDE;
     QString getFile();
 
+    /**
+     * Ask for an HDF5 file with a point cloud and list its numeric arrays
+     * @return Paths of the arrays in the file, empty when no file was selected
+     * @throws DataLoadException when the file can not be read (or the plugin was built without USE_HDF5)
+     */
+    QStringList getHDF5File();
+
+    /** Get the header of the selected file when it is self-describing (NRRD or MetaImage) */
+    const std::optional<VolumeHeader>& getVolumeHeader() const {
+        return _volumeHeader;
+    }
+
+    /** Get the slices of the stack when the selected file is a slice image (.tif, .tiff or .png) */
+    const std::optional<SliceStack>& getSliceStack() const {
+        return _sliceStack;
+    }
+
+    /** Get the header of the selected file when it is a bricked volume (.dvrb) */
+    const std::optional<BrickedVolume::Header>& getBrickedVolumeHeader() const {
+        return _brickedVolumeHeader;
+    }
+
 protected:
-    std::vector<char> _contents;
-    mv::Vector3f normalizePosition(const mv::Vector3f& pos, mv::Vector3f min, mv::Vector3f max, Size3D size);
+    QString _fileName;                                               /** Path of the selected volume file, mapped or streamed on load */
+    std::optional<VolumeHeader>     _volumeHeader;                   /** Header of the selected file, empty for raw BIN files */
+    std::optional<BrickedVolume::Header> _brickedVolumeHeader;       /** Header and brick index of the selected bricked volume */
+    std::optional<SliceStack>       _sliceStack;                     /** Slices of the stack of the selected slice image */
+    QString                         _hdf5FileName;                   /** Path of the selected HDF5 file */
     mv::Dataset<Volumes>            _volumesDataset;                 /** Volumes dataset */
 
 };
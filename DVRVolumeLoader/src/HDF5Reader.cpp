@@ -0,0 +1,177 @@
+#include "HDF5Reader.h"
+
+#include <LoaderPlugin.h>
+
+#include <QMutex>
+#include <QMutexLocker>
+#include <QtDebug>
+
+using namespace mv::plugin;
+
+namespace {
+
+// Serializes all calls into the HDF5 library, which is not thread-safe unless it was built to be
+QMutex& getHDF5Mutex()
+{
+    static QMutex mutex;
+    return mutex;
+}
+
+// Opens a file read-only, the HDF5 error stack is not printed since failures are reported with exceptions
+hid_t openFile(const QString& fileName)
+{
+    H5Eset_auto2(H5E_DEFAULT, nullptr, nullptr);
+
+    const hid_t file = H5Fopen(fileName.toUtf8().constData(), H5F_ACC_RDONLY, H5P_DEFAULT);
+
+    if (file < 0)
+        throw DataLoadException(fileName, "File could not be opened as HDF5 file.");
+
+    return file;
+}
+
+// Gets whether a dataset holds numbers in one or two dimensions
+bool isNumericArray(hid_t dataset)
+{
+    const hid_t type    = H5Dget_type(dataset);
+    const hid_t space   = H5Dget_space(dataset);
+
+    const H5T_class_t typeClass = H5Tget_class(type);
+    const int numDimensions     = H5Sget_simple_extent_ndims(space);
+
+    H5Sclose(space);
+    H5Tclose(type);
+
+    return (typeClass == H5T_INTEGER || typeClass == H5T_FLOAT) && (numDimensions == 1 || numDimensions == 2);
+}
+
+// H5Lvisit and H5L_info_t are mapped by the API compatibility level of the build, which may be older than the library (H5_USE_110_API).
+// From 1.12 on the versioned names are used explicitly, such that the callback always matches the visit function.
+#if H5_VERSION_GE(1, 12, 0)
+using LinkInfo = H5L_info2_t;
+#else
+using LinkInfo = H5L_info_t;
+#endif
+
+herr_t collectArray(hid_t group, const char* name, const LinkInfo* info, void* arrays)
+{
+    if (info->type != H5L_TYPE_HARD)
+        return 0;
+
+    const hid_t object = H5Oopen(group, name, H5P_DEFAULT);
+
+    if (object < 0)
+        return 0;
+
+    if (H5Iget_type(object) == H5I_DATASET && isNumericArray(object))
+        static_cast<QStringList*>(arrays)->append("/" + QString::fromUtf8(name));
+
+    H5Oclose(object);
+
+    return 0;
+}
+
+// Visits all links below the group with collectArray, which appends the paths of the numeric arrays to arrays
+herr_t visitLinks(hid_t group, QStringList& arrays)
+{
+#if H5_VERSION_GE(1, 12, 0)
+    return H5Lvisit2(group, H5_INDEX_NAME, H5_ITER_INC, collectArray, &arrays);
+#else
+    return H5Lvisit(group, H5_INDEX_NAME, H5_ITER_INC, collectArray, &arrays);
+#endif
+}
+
+}
+
+QStringList listHDF5Arrays(const QString& fileName)
+{
+    QMutexLocker locker(&getHDF5Mutex());
+
+    const hid_t file = openFile(fileName);
+
+    QStringList arrays;
+    visitLinks(file, arrays);
+
+    H5Fclose(file);
+
+    return arrays;
+}
+
+HDF5Array::HDF5Array(const QString& fileName, const QString& path) :
+    _fileName(fileName),
+    _path(path),
+    _file(-1),
+    _dataset(-1),
+    _numRows(0),
+    _numColumns(1),
+    _chunkRows(0)
+{
+    QMutexLocker locker(&getHDF5Mutex());
+
+    _file       = openFile(fileName);
+    _dataset    = H5Dopen2(_file, path.toUtf8().constData(), H5P_DEFAULT);
+
+    if (_dataset < 0 || !isNumericArray(_dataset)) {
+        if (_dataset >= 0)
+            H5Dclose(_dataset);
+
+        H5Fclose(_file);
+
+        throw DataLoadException(fileName, QString("%1 is not a numeric dataset with one or two dimensions.").arg(path));
+    }
+
+    const hid_t space = H5Dget_space(_dataset);
+
+    hsize_t dimensions[2] = { 0, 1 };
+    H5Sget_simple_extent_dims(space, dimensions, nullptr);
+    H5Sclose(space);
+
+    _numRows    = static_cast<std::int64_t>(dimensions[0]);
+    _numColumns = static_cast<std::int32_t>(dimensions[1]);
+
+    const hid_t properties = H5Dget_create_plist(_dataset);
+
+    if (H5Pget_layout(properties) == H5D_CHUNKED) {
+        hsize_t chunkDimensions[2] = { 0, 0 };
+        H5Pget_chunk(properties, 2, chunkDimensions);
+        _chunkRows = static_cast<std::int64_t>(chunkDimensions[0]);
+    }
+
+    H5Pclose(properties);
+
+    qDebug() << "HDF5Array:" << path << "has" << _numRows << "rows of" << _numColumns << "columns, chunks of" << _chunkRows << "rows";
+}
+
+HDF5Array::~HDF5Array()
+{
+    QMutexLocker locker(&getHDF5Mutex());
+
+    H5Dclose(_dataset);
+    H5Fclose(_file);
+}
+
+void HDF5Array::readRows(std::int64_t first, std::int64_t count, float* destination) const
+{
+    if (count <= 0)
+        return;
+
+    QMutexLocker locker(&getHDF5Mutex());
+
+    const hid_t fileSpace = H5Dget_space(_dataset);
+    const int numDimensions = H5Sget_simple_extent_ndims(fileSpace);
+
+    const hsize_t start[2] = { static_cast<hsize_t>(first), 0 };
+    const hsize_t size[2] = { static_cast<hsize_t>(count), static_cast<hsize_t>(_numColumns) };
+
+    H5Sselect_hyperslab(fileSpace, H5S_SELECT_SET, start, nullptr, size, nullptr);
+
+    const hid_t memorySpace = H5Screate_simple(numDimensions, size, nullptr);
+
+    const herr_t status = H5Dread(_dataset, H5T_NATIVE_FLOAT, memorySpace, fileSpace, H5P_DEFAULT, destination);
+
+    H5Sclose(memorySpace);
+    H5Sclose(fileSpace);
+
+    if (status < 0)
+        throw DataLoadException(_fileName, QString("Rows %1 to %2 of %3 could not be read.").arg(first).arg(first + count).arg(_path));
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <QString>
+#include <QStringList>
+
+#include <hdf5.h>
+
+#include <cstdint>
+
+// =============================================================================
+// HDF5 reader
+// =============================================================================
+
+/**
+ * List the numeric datasets with one or two dimensions in an HDF5 file, which are the candidates for the coordinate and value arrays of a point cloud
+ * @param fileName Path of the HDF5 file
+ * @return Paths of the datasets in the file
+ * @throws DataLoadException when the file can not be opened
+ */
+QStringList listHDF5Arrays(const QString& fileName);
+
+/**
+ * A numeric HDF5 dataset with one or two dimensions, one point per row, that is read in blocks of rows with hyperslab selections.
+ * Only the rows that are asked for are read, such that a point cloud is never held in memory as a whole.
+ * The HDF5 library is not necessarily built thread-safe, so all calls into it are serialized.
+ */
+class HDF5Array
+{
+public:
+
+    /**
+     * Open a dataset
+     * @param fileName Path of the HDF5 file
+     * @param path Path of the dataset in the file
+     * @throws DataLoadException when the dataset can not be opened or is not a numeric array with one or two dimensions
+     */
+    HDF5Array(const QString& fileName, const QString& path);
+
+    ~HDF5Array();
+
+    HDF5Array(const HDF5Array&) = delete;
+    HDF5Array& operator=(const HDF5Array&) = delete;
+
+    /** Get the number of rows (points) */
+    std::int64_t getNumberOfRows() const {
+        return _numRows;
+    }
+
+    /** Get the number of columns (values per point), one for datasets with a single dimension */
+    std::int32_t getNumberOfColumns() const {
+        return _numColumns;
+    }
+
+    /** Get the number of rows per chunk of a chunked dataset, reads of a multiple of it do not decompress chunks twice. Zero for contiguous datasets. */
+    std::int64_t getChunkRows() const {
+        return _chunkRows;
+    }
+
+    /**
+     * Read a block of rows, the elements are converted to float by the HDF5 library
+     * @param first Index of the first row
+     * @param count Number of rows
+     * @param destination Output with room for count * columns values
+     * @throws DataLoadException when the rows can not be read
+     */
+    void readRows(std::int64_t first, std::int64_t count, float* destination) const;
+
+private:
+    QString         _fileName;          /** Path of the HDF5 file */
+    QString         _path;              /** Path of the dataset in the file */
+    hid_t           _file;              /** Handle of the file */
+    hid_t           _dataset;           /** Handle of the dataset */
+    std::int64_t    _numRows;           /** Number of rows */
+    std::int32_t    _numColumns;        /** Number of columns */
+    std::int64_t    _chunkRows;         /** Number of rows per chunk, zero when not chunked */
+};
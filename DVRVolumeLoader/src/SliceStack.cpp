@@ -0,0 +1,117 @@
+#include "SliceStack.h"
+
+#include <LoaderPlugin.h>
+
+#include <QDir>
+#include <QFileInfo>
+#include <QImageReader>
+#include <QRegularExpression>
+#include <QtDebug>
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+using namespace mv::plugin;
+
+namespace {
+
+bool is16BitFormat(QImage::Format format)
+{
+    return format == QImage::Format_Grayscale16 || format == QImage::Format_RGBX64 || format == QImage::Format_RGBA64 || format == QImage::Format_RGBA64_Premultiplied;
+}
+
+}
+
+bool isSliceImageFile(const QString& fileName)
+{
+    const auto suffix = QFileInfo(fileName).suffix().toLower();
+
+    return suffix == "tif" || suffix == "tiff" || suffix == "png";
+}
+
+QStringList findNumberedFiles(const QString& fileName)
+{
+    static const QRegularExpression numberedName("^(.*?)(\\d+)$");
+
+    const QFileInfo fileInfo(fileName);
+    const auto match = numberedName.match(fileInfo.completeBaseName());
+
+    if (!match.hasMatch())
+        return { fileInfo.absoluteFilePath() };
+
+    const auto prefix = match.captured(1);
+    const auto suffix = fileInfo.suffix();
+
+    std::vector<std::pair<qulonglong, QString>> numberedFiles;
+
+    for (const auto& candidate : fileInfo.dir().entryInfoList(QDir::Files)) {
+        if (candidate.suffix() != suffix)
+            continue;
+
+        const auto candidateMatch = numberedName.match(candidate.completeBaseName());
+
+        if (candidateMatch.hasMatch() && candidateMatch.captured(1) == prefix)
+            numberedFiles.emplace_back(candidateMatch.captured(2).toULongLong(), candidate.absoluteFilePath());
+    }
+
+    std::sort(numberedFiles.begin(), numberedFiles.end());
+
+    QStringList fileNames;
+
+    for (const auto& numberedFile : numberedFiles)
+        fileNames.append(numberedFile.second);
+
+    return fileNames;
+}
+
+SliceStack findSliceStack(const QString& fileName)
+{
+    SliceStack sliceStack;
+
+    sliceStack.fileNames = findNumberedFiles(fileName);
+
+    if (sliceStack.fileNames.isEmpty())
+        throw DataLoadException(fileName, "No slice images were found.");
+
+    // Most image plugins know the size and format from the header, otherwise the first slice is decoded
+    QImageReader reader(sliceStack.fileNames.first());
+
+    QSize size = reader.size();
+    QImage::Format format = reader.imageFormat();
+
+    if (!size.isValid() || format == QImage::Format_Invalid) {
+        const QImage image = reader.read();
+
+        if (image.isNull())
+            throw DataLoadException(sliceStack.fileNames.first(), QString("The first slice could not be read: %1").arg(reader.errorString()));
+
+        size = image.size();
+        format = image.format();
+    }
+
+    sliceStack.sizeX    = size.width();
+    sliceStack.sizeY    = size.height();
+    sliceStack.dataType = is16BitFormat(format) ? BinaryDataType::UINT16 : BinaryDataType::UBYTE;
+
+    qDebug() << "Slice stack of" << sliceStack.getNumberOfSlices() << "slices of" << sliceStack.sizeX << "x" << sliceStack.sizeY << (sliceStack.dataType == BinaryDataType::UINT16 ? "16 bit" : "8 bit");
+
+    return sliceStack;
+}
+
+QImage readSlice(const SliceStack& sliceStack, std::int32_t z)
+{
+    const auto& fileName = sliceStack.fileNames[z];
+
+    QImageReader reader(fileName);
+
+    const QImage image = reader.read();
+
+    if (image.isNull())
+        throw DataLoadException(fileName, QString("The slice could not be read: %1").arg(reader.errorString()));
+
+    if (image.width() != sliceStack.sizeX || image.height() != sliceStack.sizeY)
+        throw DataLoadException(fileName, QString("The slice is %1 x %2 pixels instead of %3 x %4 like the first slice.").arg(image.width()).arg(image.height()).arg(sliceStack.sizeX).arg(sliceStack.sizeY));
+
+    return image.convertToFormat(sliceStack.dataType == BinaryDataType::UINT16 ? QImage::Format_Grayscale16 : QImage::Format_Grayscale8);
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "VolumeHeader.h"
+
+#include <QImage>
+#include <QString>
+#include <QStringList>
+
+#include <cstdint>
+
+// =============================================================================
+// Slice stack
+// =============================================================================
+
+/** A volume that is stored as a folder of 2D images, one image per z-slice */
+struct SliceStack
+{
+    QStringList     fileNames;                          /** Images of the slices, ordered by z */
+    std::int32_t    sizeX = 1;                          /** Width of the slices */
+    std::int32_t    sizeY = 1;                          /** Height of the slices */
+    BinaryDataType  dataType = BinaryDataType::UBYTE;   /** 8 or 16 bit gray values */
+
+    /** Get the number of slices */
+    std::int32_t getNumberOfSlices() const {
+        return static_cast<std::int32_t>(fileNames.size());
+    }
+};
+
+/** Get whether the file name has the extension of one of the supported slice image formats (.tif, .tiff, .png) */
+bool isSliceImageFile(const QString& fileName);
+
+/**
+ * Find the numbered files of the sequence a file belongs to: the files in its folder with the same extension and the same name apart from
+ * a trailing number, ordered by that number. Used for the slices of a stack and the timesteps of a series.
+ * @param fileName Path of one of the files
+ * @return Paths of the files of the sequence, just the given file when its name does not end with a number
+ */
+QStringList findNumberedFiles(const QString& fileName);
+
+/**
+ * Find the slices of the stack a slice image belongs to: the numbered images in its folder with the same name prefix, see findNumberedFiles.
+ * Other images in the folder, such as a preview or a mask, are not part of the stack.
+ * The size and bit depth of the slices are taken from the first slice, without decoding it.
+ * @param fileName Path of one of the slice images
+ * @return Slice stack
+ * @throws DataLoadException when the first slice can not be read
+ */
+SliceStack findSliceStack(const QString& fileName);
+
+/**
+ * Decode a slice into 8 or 16 bit gray values, color images are converted to their luminance. Safe to call from several threads at once.
+ * @param sliceStack Slice stack
+ * @param z Index of the slice
+ * @return Grayscale8 or Grayscale16 image, rows may be padded
+ * @throws DataLoadException when the slice can not be decoded or has a different size than the first slice
+ */
+QImage readSlice(const SliceStack& sliceStack, std::int32_t z);
@@ -0,0 +1,152 @@
+#include "TimeSeries.h"
+
+#include <Set.h>
+
+#include <QFutureWatcher>
+#include <QtConcurrent>
+#include <QtDebug>
+
+#include <algorithm>
+#include <exception>
+
+using namespace mv;
+
+TimeSeries::TimeSeries(const QStringList& fileNames, const Decoder& decoder, mv::Dataset<Points> points, mv::Dataset<Volumes> volumes, int numPrefetch, QObject* parent) :
+    QObject(parent),
+    _fileNames(fileNames),
+    _decoder(decoder),
+    _points(points),
+    _volumes(volumes),
+    _numPrefetch(std::max(0, numPrefetch)),
+    _currentTimestep(0),
+    _timestepAction(this, "Timestep", 0, std::max(0, static_cast<int>(fileNames.size()) - 1), 0)
+{
+    // The decodes are parallel by themselves, so a couple of workers is enough to hide the disk latency
+    _threadPool.setMaxThreadCount(std::clamp(_numPrefetch, 1, 2));
+
+    _timestepAction.setToolTip("Timestep of the time series that is shown");
+
+    connect(&_timestepAction, &mv::gui::IntegralAction::valueChanged, this, [this](std::int32_t value) {
+        setTimestep(value);
+    });
+
+    _volumes->addAction(_timestepAction);
+    _volumes->setProperty("NumberOfTimesteps", getNumberOfTimesteps());
+
+    // The series lives as long as its datasets, the decoded timesteps in the ring are released together with them
+    const auto release = [this]() -> void {
+        _ring.clear();
+        _threadPool.clear();
+        deleteLater();
+    };
+
+    connect(&_points, &mv::Dataset<Points>::dataAboutToBeRemoved, this, release);
+    connect(&_volumes, &mv::Dataset<Volumes>::dataAboutToBeRemoved, this, release);
+
+    qDebug() << "TimeSeries: Registered" << getNumberOfTimesteps() << "timesteps, prefetching" << _numPrefetch;
+
+    // The first timestep was loaded already, so only the next ones are decoded ahead
+    prefetch();
+}
+
+TimeSeries::~TimeSeries()
+{
+    _threadPool.clear();
+    _threadPool.waitForDone();
+}
+
+void TimeSeries::setTimestep(int timestep)
+{
+    timestep = std::clamp(timestep, 0, getNumberOfTimesteps() - 1);
+
+    if (timestep == _currentTimestep)
+        return;
+
+    _currentTimestep = timestep;
+
+    auto future = requestTimestep(timestep);
+
+    if (future.isFinished()) {
+        publish(timestep, future.result());
+    }
+    else {
+        auto* watcher = new QFutureWatcher<Publisher>(this);
+
+        connect(watcher, &QFutureWatcher<Publisher>::finished, this, [this, watcher, timestep]() {
+
+            // Skip timesteps that were scrolled past while they were decoded
+            if (timestep == _currentTimestep)
+                publish(timestep, watcher->result());
+
+            watcher->deleteLater();
+        });
+
+        watcher->setFuture(future);
+    }
+
+    prefetch();
+}
+
+QFuture<TimeSeries::Publisher> TimeSeries::requestTimestep(int timestep)
+{
+    const auto it = _ring.find(timestep);
+
+    if (it != _ring.end())
+        return it->second;
+
+    const auto fileName = _fileNames[timestep];
+    const auto decoder = _decoder;
+
+    auto future = QtConcurrent::run(&_threadPool, [fileName, decoder]() -> Publisher {
+        try {
+            return decoder(fileName);
+        }
+        catch (const std::exception& e) {
+            qWarning() << "TimeSeries: Unable to decode" << fileName << ":" << e.what();
+            return Publisher();
+        }
+    });
+
+    _ring[timestep] = future;
+
+    return future;
+}
+
+void TimeSeries::prefetch()
+{
+    const int first = _currentTimestep - 1;
+    const int last = std::min(_currentTimestep + _numPrefetch, getNumberOfTimesteps() - 1);
+
+    // Keep the previous timestep for stepping back, decodes that are still running finish but their result is dropped
+    for (auto it = _ring.begin(); it != _ring.end();) {
+        if (it->first < first || it->first > last)
+            it = _ring.erase(it);
+        else
+            ++it;
+    }
+
+    for (int timestep = _currentTimestep + 1; timestep <= last; timestep++)
+        requestTimestep(timestep);
+}
+
+void TimeSeries::publish(int timestep, const Publisher& publisher)
+{
+    if (!_points.isValid() || !_volumes.isValid())
+        return;
+
+    if (!publisher) {
+        qWarning() << "TimeSeries: Timestep" << timestep << "could not be decoded";
+        return;
+    }
+
+    publisher(_points, _volumes);
+
+    events().notifyDatasetDataChanged(_points);
+    events().notifyDatasetDataChanged(_volumes);
+
+    // Keep the action in sync when the timestep was set from code
+    if (_timestepAction.getValue() != timestep) {
+        QSignalBlocker timestepActionBlocker(&_timestepAction);
+        _timestepAction.setValue(timestep);
+    }
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <actions/IntegralAction.h>
+
+#include <PointData/PointData.h>
+#include <VolumeData/Volumes.h>
+
+#include <QFuture>
+#include <QObject>
+#include <QStringList>
+#include <QThreadPool>
+
+#include <functional>
+#include <map>
+
+// =============================================================================
+// Time series
+// =============================================================================
+
+/**
+ * A sequence of volume files with an identical layout that is shown as a single Volumes dataset, one timestep at a time.
+ * Decoded timesteps are kept in a small ring in RAM and the next timesteps are decoded ahead on worker threads,
+ * such that stepping through time is limited by the upload in the views instead of by the disk and the conversion.
+ * The timestep is picked with an action that is added to the Volumes dataset. The series deletes itself once either dataset is removed.
+ */
+class TimeSeries : public QObject
+{
+    Q_OBJECT
+
+public:
+    /** Sets a decoded timestep as the data of the point and volumes datasets, called on the GUI thread */
+    using Publisher = std::function<void(mv::Dataset<Points>&, mv::Dataset<Volumes>&)>;
+
+    /** Decodes the file of a timestep into a publisher, called on a worker thread */
+    using Decoder = std::function<Publisher(const QString& fileName)>;
+
+    /**
+     * Construct the time series, the first timestep is expected to be loaded already
+     * @param fileNames Files of the timesteps in order
+     * @param decoder Decodes the file of a timestep
+     * @param points Point dataset that holds the voxels of the shown timestep
+     * @param volumes Volumes dataset of the point dataset
+     * @param numPrefetch Number of timesteps after the shown timestep that are decoded ahead
+     * @param parent Parent object
+     */
+    TimeSeries(const QStringList& fileNames, const Decoder& decoder, mv::Dataset<Points> points, mv::Dataset<Volumes> volumes, int numPrefetch, QObject* parent = nullptr);
+
+    ~TimeSeries() override;
+
+    /** Get the number of timesteps */
+    int getNumberOfTimesteps() const {
+        return static_cast<int>(_fileNames.size());
+    }
+
+    /** Get the timestep that is shown, or that is being decoded to be shown */
+    int getCurrentTimestep() const {
+        return _currentTimestep;
+    }
+
+    /**
+     * Show a timestep, straight from the ring when it was prefetched or once it is decoded on a worker thread
+     * @param timestep Index of the timestep
+     */
+    void setTimestep(int timestep);
+
+private:
+    /** Get the (possibly still running) decode of a timestep, which is started when it is not in the ring */
+    QFuture<Publisher> requestTimestep(int timestep);
+
+    /** Drop the timesteps that are out of reach from the ring and start decoding the next ones */
+    void prefetch();
+
+    /** Set the data of a decoded timestep on the datasets and notify the views */
+    void publish(int timestep, const Publisher& publisher);
+
+private:
+    QStringList                         _fileNames;             /** Files of the timesteps */
+    Decoder                             _decoder;               /** Decodes the file of a timestep */
+    mv::Dataset<Points>                 _points;                /** Point dataset that holds the voxels of the shown timestep */
+    mv::Dataset<Volumes>                _volumes;               /** Volumes dataset of the point dataset */
+    int                                 _numPrefetch;           /** Number of timesteps that are decoded ahead */
+    int                                 _currentTimestep;       /** Timestep that is shown or being decoded to be shown */
+    std::map<int, QFuture<Publisher>>   _ring;                  /** Decoded and in-flight timesteps */
+    QThreadPool                         _threadPool;            /** Worker threads for the decodes, each decode is parallel by itself */
+    mv::gui::IntegralAction             _timestepAction;        /** Timestep action, added to the Volumes dataset */
+};
@@ -0,0 +1,233 @@
+#include "VolumeCache.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QtDebug>
+
+#include <algorithm>
+
+namespace {
+
+constexpr quint32 cacheMagic    = 0x43525644;   // "DVRC" in little endian
+constexpr quint32 cacheVersion  = 1;
+
+// The point data elements start at a page boundary, such that they are mapped without an offset into the first page
+constexpr qint64 payloadAlignment = 4096;
+
+// Number of bytes of the magic, version, payload offset and payload size in front of the header
+constexpr qint64 prefixSize = 2 * sizeof(quint32) + 2 * sizeof(quint64);
+
+const QString cacheSuffix = "dvrc";
+
+void setStreamFormat(QDataStream& stream)
+{
+    stream.setVersion(QDataStream::Qt_6_0);
+    stream.setByteOrder(QDataStream::LittleEndian);
+}
+
+void writeHeader(QDataStream& stream, const VolumeCache::Header& header)
+{
+    const auto& statistics = header.statistics;
+
+    stream << header.elementTypeName << header.numDimensions << header.numPoints << header.dimensionNames << header.quantizationScale << header.quantizationOffset;
+    stream << static_cast<qint32>(statistics.getNumberOfComponents());
+
+    for (int c = 0; c < statistics.getNumberOfComponents(); c++)
+    {
+        stream << statistics.ranges.minimum[c] << statistics.ranges.maximum[c] << statistics.sum[c] << static_cast<qint64>(statistics.count[c]);
+
+        for (const auto binCount : statistics.histograms[c])
+            stream << static_cast<quint64>(binCount);
+    }
+}
+
+bool readHeader(QDataStream& stream, VolumeCache::Header& header)
+{
+    qint32 numComponents = 0;
+
+    stream >> header.elementTypeName >> header.numDimensions >> header.numPoints >> header.dimensionNames >> header.quantizationScale >> header.quantizationOffset;
+    stream >> numComponents;
+
+    if (stream.status() != QDataStream::Ok || numComponents < 0 || numComponents > header.numDimensions)
+        return false;
+
+    auto& statistics = header.statistics;
+    statistics = VolumeConversion::ComponentStatistics(numComponents);
+
+    for (int c = 0; c < numComponents; c++)
+    {
+        qint64 count = 0;
+
+        stream >> statistics.ranges.minimum[c] >> statistics.ranges.maximum[c] >> statistics.sum[c] >> count;
+        statistics.count[c] = count;
+
+        for (auto& binCount : statistics.histograms[c])
+        {
+            quint64 value = 0;
+            stream >> value;
+            binCount = value;
+        }
+    }
+
+    return stream.status() == QDataStream::Ok;
+}
+
+// Sets the modification time of an entry to now. Setting file times needs write access on Windows, so the entry is opened for writing
+// next to the read-only handle that maps it; the contents are not touched.
+void touchEntry(const QString& fileName)
+{
+    QFile file(fileName);
+
+    if (!file.open(QIODevice::ReadWrite | QIODevice::ExistingOnly) || !file.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime))
+        qWarning() << "VolumeCache: Unable to mark" << fileName << "as recently used:" << file.errorString();
+}
+
+}
+
+VolumeCache::~VolumeCache()
+{
+    if (_payload != nullptr)
+        _file.unmap(const_cast<uchar*>(_payload));
+}
+
+QString VolumeCache::computeKey(const QStringList& sourceFileNames, const QStringList& parameters)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+
+    hash.addData(QByteArray::number(cacheVersion));
+
+    for (const auto& sourceFileName : sourceFileNames)
+    {
+        const QFileInfo fileInfo(sourceFileName);
+
+        hash.addData(fileInfo.absoluteFilePath().toUtf8());
+        hash.addData(QByteArray::number(fileInfo.size()));
+        hash.addData(QByteArray::number(fileInfo.lastModified().toMSecsSinceEpoch()));
+    }
+
+    for (const auto& parameter : parameters)
+        hash.addData(parameter.toUtf8() + '\n');
+
+    return QString::fromLatin1(hash.result().toHex());
+}
+
+QString VolumeCache::getDirectory()
+{
+    return QDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation)).filePath("DVRVolumeLoader");
+}
+
+QString VolumeCache::getFileName(const QString& key)
+{
+    return QDir(getDirectory()).filePath(key + "." + cacheSuffix);
+}
+
+bool VolumeCache::open(const QString& key)
+{
+    _file.setFileName(getFileName(key));
+
+    if (!_file.exists() || !_file.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream stream(&_file);
+    setStreamFormat(stream);
+
+    quint32 magic = 0, version = 0;
+    quint64 payloadOffset = 0, payloadSize = 0;
+
+    stream >> magic >> version >> payloadOffset >> payloadSize;
+
+    const bool isValid = stream.status() == QDataStream::Ok && magic == cacheMagic && version == cacheVersion
+        && readHeader(stream, _header) && static_cast<quint64>(_file.size()) >= payloadOffset + payloadSize;
+
+    if (isValid)
+    {
+        _payloadSize    = static_cast<qint64>(payloadSize);
+        _payload        = _file.map(static_cast<qint64>(payloadOffset), _payloadSize);
+    }
+
+    if (_payload == nullptr)
+    {
+        qWarning() << "VolumeCache: Removing unreadable entry" << _file.fileName();
+
+        _file.close();
+        _file.remove();
+
+        return false;
+    }
+
+    // The modification time orders the entries for pruning, so a hit marks the entry as recently used
+    touchEntry(_file.fileName());
+
+    return true;
+}
+
+bool VolumeCache::write(const QString& key, const Header& header, const char* payload, qint64 payloadSize)
+{
+    if (!QDir().mkpath(getDirectory())) {
+        qWarning() << "VolumeCache: Unable to create the cache directory" << getDirectory();
+        return false;
+    }
+
+    QByteArray headerData;
+
+    {
+        QDataStream stream(&headerData, QIODevice::WriteOnly);
+        setStreamFormat(stream);
+        writeHeader(stream, header);
+    }
+
+    const qint64 payloadOffset = (prefixSize + headerData.size() + payloadAlignment - 1) / payloadAlignment * payloadAlignment;
+
+    QSaveFile file(getFileName(key));
+
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "VolumeCache: Unable to write" << file.fileName() << ":" << file.errorString();
+        return false;
+    }
+
+    {
+        QDataStream stream(&file);
+        setStreamFormat(stream);
+
+        stream << cacheMagic << cacheVersion << static_cast<quint64>(payloadOffset) << static_cast<quint64>(payloadSize);
+    }
+
+    file.write(headerData);
+    file.write(QByteArray(payloadOffset - prefixSize - headerData.size(), '\0'));
+
+    // Written in chunks, since a single write is limited in size on some platforms
+    constexpr qint64 chunkSize = qint64(1) << 30;
+
+    for (qint64 offset = 0; offset < payloadSize; offset += chunkSize)
+        file.write(payload + offset, std::min(chunkSize, payloadSize - offset));
+
+    if (!file.commit()) {
+        qWarning() << "VolumeCache: Unable to write" << file.fileName() << ":" << file.errorString();
+        return false;
+    }
+
+    return true;
+}
+
+void VolumeCache::prune(qint64 maximumSize)
+{
+    const auto entries = QDir(getDirectory()).entryInfoList({ "*." + cacheSuffix }, QDir::Files, QDir::Time);
+
+    qint64 size = 0;
+
+    // The entries are ordered from most to least recently used
+    for (const auto& entry : entries)
+    {
+        size += entry.size();
+
+        if (size > maximumSize) {
+            qDebug() << "VolumeCache: Removing least recently used entry" << entry.fileName();
+            QFile::remove(entry.absoluteFilePath());
+        }
+    }
+}
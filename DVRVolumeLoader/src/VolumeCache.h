@@ -0,0 +1,103 @@
+#pragma once
+
+#include "VolumeConversion.h"
+
+#include <QFile>
+#include <QString>
+#include <QStringList>
+#include <QVariantList>
+
+#include <cstdint>
+#include <vector>
+
+// =============================================================================
+// Volume cache
+// =============================================================================
+
+/**
+ * On-disk cache of converted volumes, such that loading a file again skips the conversion and reads the point data straight from disk.
+ * Entries are keyed by the path, size and modification time of the source files and the loader parameters, stale entries are therefore
+ * never hit. An entry holds a small header with the statistics and the properties of the point data, followed by the point data elements
+ * at a page aligned offset such that they are memory-mapped and copied without any parsing.
+ * The least recently used entries are removed when the cache grows beyond its budget.
+ */
+class VolumeCache
+{
+public:
+
+    /** Everything the loader sets on the point data apart from the elements, and the statistics of the Volumes dataset */
+    struct Header
+    {
+        QString                                 elementTypeName;        /** Point data element type name */
+        std::int32_t                            numDimensions = 0;      /** Number of values per voxel */
+        quint64                                 numPoints = 0;          /** Number of voxels */
+        QStringList                             dimensionNames;         /** Dimension names, empty for the default names */
+        QVariantList                            quantizationScale;      /** Quantization scale per dimension, empty when not quantized */
+        QVariantList                            quantizationOffset;     /** Quantization offset per dimension, empty when not quantized */
+        VolumeConversion::ComponentStatistics   statistics;             /** Per-component statistics of the values */
+    };
+
+    VolumeCache() = default;
+    ~VolumeCache();
+
+    VolumeCache(const VolumeCache&) = delete;
+    VolumeCache& operator=(const VolumeCache&) = delete;
+
+    /**
+     * Compute the key of a converted volume
+     * @param sourceFileNames Files the volume is read from, their path, size and modification time are part of the key
+     * @param parameters Loader parameters that change the converted point data
+     * @return Hexadecimal SHA-1 hash
+     */
+    static QString computeKey(const QStringList& sourceFileNames, const QStringList& parameters);
+
+    /** Get the directory of the cache, in the cache location of the application */
+    static QString getDirectory();
+
+    /**
+     * Open the entry of a key and map its point data elements
+     * @param key Key of the converted volume
+     * @return Whether the entry exists and is readable, a corrupt entry is removed
+     */
+    bool open(const QString& key);
+
+    /** Get the header of the opened entry */
+    const Header& getHeader() const {
+        return _header;
+    }
+
+    /** Get the memory-mapped point data elements of the opened entry */
+    const char* getPayload() const {
+        return reinterpret_cast<const char*>(_payload);
+    }
+
+    /** Get the number of bytes of point data elements of the opened entry */
+    qint64 getPayloadSize() const {
+        return _payloadSize;
+    }
+
+    /**
+     * Write an entry, the file is only replaced once it is complete. Failures are reported as warnings, since the cache is optional.
+     * @param key Key of the converted volume
+     * @param header Header of the entry
+     * @param payload Point data elements
+     * @param payloadSize Number of bytes of point data elements
+     * @return Whether the entry was written
+     */
+    static bool write(const QString& key, const Header& header, const char* payload, qint64 payloadSize);
+
+    /**
+     * Remove the least recently used entries until the cache fits in its budget
+     * @param maximumSize Budget of the cache in bytes
+     */
+    static void prune(qint64 maximumSize);
+
+private:
+    static QString getFileName(const QString& key);
+
+private:
+    QFile           _file;                      /** File of the opened entry */
+    const uchar*    _payload = nullptr;         /** Memory-mapped point data elements */
+    qint64          _payloadSize = 0;           /** Number of bytes of point data elements */
+    Header          _header;                    /** Header of the opened entry */
+};
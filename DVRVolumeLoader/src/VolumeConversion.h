@@ -0,0 +1,480 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+#include <OpenMPSupport.h>
+
+// =============================================================================
+// Conversion kernels used to turn raw file contents into point data elements
+// =============================================================================
+
+namespace VolumeConversion {
+
+// Number of elements converted per work item, large enough to amortize the scheduling overhead and small enough to spread the work over all cores
+constexpr std::int64_t blockSize = 1 << 16;
+
+// Reverses the byte order of a raw element, used for data that was written with the other endianness
+template <typename T>
+inline T swapBytes(T value)
+{
+    unsigned char bytes[sizeof(T)];
+    std::memcpy(bytes, &value, sizeof(T));
+    std::reverse(bytes, bytes + sizeof(T));
+    std::memcpy(&value, bytes, sizeof(T));
+    return value;
+}
+
+// Converts a contiguous block of count elements of source type T into the destination type S.
+// The source is read with memcpy so that unaligned (memory-mapped) input is fine, the loop is branch free such that the compiler can vectorize it.
+template <typename T, typename S, bool SwapBytes = false>
+inline void convertBlock(const char* source, S* destination, std::int64_t count)
+{
+    for (std::int64_t i = 0; i < count; i++)
+    {
+        T value;
+        std::memcpy(&value, source + i * sizeof(T), sizeof(T));
+
+        if constexpr (SwapBytes && sizeof(T) > 1)
+            value = swapBytes(value);
+
+        destination[i] = static_cast<S>(value);
+    }
+}
+
+// Per-component value range of interleaved elements, used to quantize them into the full range of a smaller integer type
+struct ComponentRanges
+{
+    std::vector<double> minimum;
+    std::vector<double> maximum;
+
+    explicit ComponentRanges(int numComponents = 0) :
+        minimum(numComponents, std::numeric_limits<double>::max()),
+        maximum(numComponents, std::numeric_limits<double>::lowest())
+    {
+    }
+
+    int getNumberOfComponents() const { return static_cast<int>(minimum.size()); }
+
+    void merge(const ComponentRanges& other)
+    {
+        for (int c = 0; c < getNumberOfComponents(); c++)
+        {
+            minimum[c] = std::min(minimum[c], other.minimum[c]);
+            maximum[c] = std::max(maximum[c], other.maximum[c]);
+        }
+    }
+};
+
+// Number of bins of the per-component histograms
+constexpr int histogramBins = 256;
+
+// Per-component statistics of interleaved elements: the value range, the mean and a histogram of histogramBins bins over the value range
+struct ComponentStatistics
+{
+    ComponentRanges                         ranges;
+    std::vector<double>                     sum;
+    std::vector<std::int64_t>               count;          // Number of values that are not NaN
+    std::vector<std::vector<std::uint64_t>> histograms;
+
+    explicit ComponentStatistics(int numComponents = 0) :
+        ranges(numComponents),
+        sum(numComponents, 0.0),
+        count(numComponents, 0),
+        histograms(numComponents, std::vector<std::uint64_t>(histogramBins, 0))
+    {
+    }
+
+    int getNumberOfComponents() const { return ranges.getNumberOfComponents(); }
+
+    double getMean(int component) const { return count[component] > 0 ? sum[component] / static_cast<double>(count[component]) : 0.0; }
+
+    // Adds a value to the range, sum and count of a component, NaNs are skipped
+    void add(int component, double value)
+    {
+        if (value != value)
+            return;
+
+        ranges.minimum[component] = std::min(ranges.minimum[component], value);
+        ranges.maximum[component] = std::max(ranges.maximum[component], value);
+        sum[component] += value;
+        count[component]++;
+    }
+
+    // Gets the histogram bin of a value, values outside of the range end up in the first or last bin
+    int getHistogramBin(int component, double value) const
+    {
+        const double range = ranges.maximum[component] - ranges.minimum[component];
+
+        if (!(range > 0.0))
+            return 0;
+
+        const double bin = (value - ranges.minimum[component]) / range * histogramBins;
+        return static_cast<int>(std::clamp(bin, 0.0, static_cast<double>(histogramBins - 1)));
+    }
+
+    void merge(const ComponentStatistics& other)
+    {
+        ranges.merge(other.ranges);
+
+        for (int c = 0; c < getNumberOfComponents(); c++)
+        {
+            sum[c] += other.sum[c];
+            count[c] += other.count[c];
+
+            for (int bin = 0; bin < histogramBins; bin++)
+                histograms[c][bin] += other.histograms[c][bin];
+        }
+    }
+};
+
+// Adds count interleaved elements of type T to the range, sum and count of the statistics, starting at the given component
+template <typename T>
+inline void accumulateStatistics(const char* source, std::int64_t count, int component, ComponentStatistics& statistics, bool swap)
+{
+    const int numComponents = statistics.getNumberOfComponents();
+
+    for (std::int64_t i = 0; i < count; i++)
+    {
+        T value;
+        std::memcpy(&value, source + i * sizeof(T), sizeof(T));
+
+        if (swap)
+            value = swapBytes(value);
+
+        statistics.add(component, static_cast<double>(value));
+
+        if (++component == numComponents)
+            component = 0;
+    }
+}
+
+// Converts numElements elements of type T from source into the preallocated destination, splitting the work in blocks over all available threads.
+// When swap is set the source elements are byte swapped first, the choice is made once per block such that the inner loop stays branch free.
+// When statistics are given, the range, sum and count of the (unconverted) source values are gathered from each block while it is still in cache.
+// The source must then start at the first component of a voxel. Each thread keeps its own statistics that are merged at the end.
+template <typename T, typename S>
+void convertElements(const char* source, S* destination, std::int64_t numElements, bool swap = false, ComponentStatistics* statistics = nullptr)
+{
+    const std::int64_t numBlocks = (numElements + blockSize - 1) / blockSize;
+    const int numComponents = statistics != nullptr ? statistics->getNumberOfComponents() : 0;
+
+    #pragma omp parallel
+    {
+        ComponentStatistics threadStatistics(numComponents);
+
+        #pragma omp for schedule(static)
+        for (std::int64_t block = 0; block < numBlocks; block++)
+        {
+            const std::int64_t begin = block * blockSize;
+            const std::int64_t count = std::min(blockSize, numElements - begin);
+
+            if (swap)
+                convertBlock<T, S, true>(source + begin * sizeof(T), destination + begin, count);
+            else
+                convertBlock<T, S, false>(source + begin * sizeof(T), destination + begin, count);
+
+            if (statistics != nullptr)
+                accumulateStatistics<T>(source + begin * sizeof(T), count, static_cast<int>(begin % numComponents), threadStatistics, swap);
+        }
+
+        if (statistics != nullptr)
+        {
+            #pragma omp critical
+            statistics->merge(threadStatistics);
+        }
+    }
+}
+
+// Adds numElements interleaved elements of type S that are already in memory to the range, sum and count of the statistics, in parallel
+template <typename S>
+void updateStatistics(const S* data, std::int64_t numElements, ComponentStatistics& statistics)
+{
+    const int numComponents = statistics.getNumberOfComponents();
+    const std::int64_t numBlocks = (numElements + blockSize - 1) / blockSize;
+
+    #pragma omp parallel
+    {
+        ComponentStatistics threadStatistics(numComponents);
+
+        #pragma omp for schedule(static)
+        for (std::int64_t block = 0; block < numBlocks; block++)
+        {
+            const std::int64_t begin = block * blockSize;
+            const std::int64_t count = std::min(blockSize, numElements - begin);
+
+            accumulateStatistics<S>(reinterpret_cast<const char*>(data + begin), count, static_cast<int>(begin % numComponents), threadStatistics, false);
+        }
+
+        #pragma omp critical
+        statistics.merge(threadStatistics);
+    }
+}
+
+// Fills the histograms of the statistics from numElements interleaved stored elements of type S, the ranges of the statistics must be complete.
+// Stored values are mapped back with value = stored * scale + offset per component, such that quantized data is binned in its original units.
+template <typename S>
+void updateHistograms(const S* data, std::int64_t numElements, ComponentStatistics& statistics, const std::vector<double>& scale, const std::vector<double>& offset)
+{
+    const int numComponents = statistics.getNumberOfComponents();
+    const std::int64_t numBlocks = (numElements + blockSize - 1) / blockSize;
+
+    #pragma omp parallel
+    {
+        std::vector<std::vector<std::uint64_t>> threadHistograms(numComponents, std::vector<std::uint64_t>(histogramBins, 0));
+
+        #pragma omp for schedule(static)
+        for (std::int64_t block = 0; block < numBlocks; block++)
+        {
+            const std::int64_t begin = block * blockSize;
+            const std::int64_t count = std::min(blockSize, numElements - begin);
+
+            int c = static_cast<int>(begin % numComponents);
+
+            for (std::int64_t i = begin; i < begin + count; i++)
+            {
+                const double value = static_cast<double>(data[i]) * scale[c] + offset[c];
+
+                if (value == value)
+                    threadHistograms[c][statistics.getHistogramBin(c, value)]++;
+
+                if (++c == numComponents)
+                    c = 0;
+            }
+        }
+
+        #pragma omp critical
+        for (int c = 0; c < numComponents; c++)
+            for (int bin = 0; bin < histogramBins; bin++)
+                statistics.histograms[c][bin] += threadHistograms[c][bin];
+    }
+}
+
+// Widens the ranges with numElements interleaved elements of type T, the source must start at the first component of a voxel.
+// Each thread keeps its own ranges that are merged at the end. NaNs are skipped.
+template <typename T>
+void updateComponentRanges(const char* source, std::int64_t numElements, ComponentRanges& ranges, bool swap = false)
+{
+    const int numComponents = ranges.getNumberOfComponents();
+    const std::int64_t numBlocks = (numElements + blockSize - 1) / blockSize;
+
+    #pragma omp parallel
+    {
+        ComponentRanges threadRanges(numComponents);
+
+        #pragma omp for schedule(static)
+        for (std::int64_t block = 0; block < numBlocks; block++)
+        {
+            const std::int64_t begin = block * blockSize;
+            const std::int64_t count = std::min(blockSize, numElements - begin);
+
+            int c = static_cast<int>(begin % numComponents);
+
+            for (std::int64_t i = begin; i < begin + count; i++)
+            {
+                T value;
+                std::memcpy(&value, source + i * sizeof(T), sizeof(T));
+
+                if (swap)
+                    value = swapBytes(value);
+
+                const double v = static_cast<double>(value);
+
+                if (v == v) {
+                    threadRanges.minimum[c] = std::min(threadRanges.minimum[c], v);
+                    threadRanges.maximum[c] = std::max(threadRanges.maximum[c], v);
+                }
+
+                if (++c == numComponents)
+                    c = 0;
+            }
+        }
+
+        #pragma omp critical
+        ranges.merge(threadRanges);
+    }
+}
+
+// Gets how stored values of the integer type S map back to the original values of a component: value = stored * scale + offset
+template <typename S>
+void getDequantization(const ComponentRanges& ranges, int component, double& scale, double& offset)
+{
+    static_assert(std::is_integral_v<S>, "Only integer types can hold quantized values");
+
+    const double lowest = static_cast<double>(std::numeric_limits<S>::lowest());
+    const double range = ranges.maximum[component] - ranges.minimum[component];
+
+    // Constant (or empty) components are stored as the lowest value
+    scale   = range > 0.0 ? range / (static_cast<double>(std::numeric_limits<S>::max()) - lowest) : 1.0;
+    offset  = (range >= 0.0 ? ranges.minimum[component] : 0.0) - lowest * scale;
+}
+
+// Rounds a value to the nearest stored value of the integer type S, given the offset and inverse scale of the dequantization. NaNs end up at the lowest value.
+template <typename S>
+inline S quantizeValue(double value, double offset, double invScale)
+{
+    constexpr double lowest = static_cast<double>(std::numeric_limits<S>::lowest());
+    constexpr double highest = static_cast<double>(std::numeric_limits<S>::max());
+
+    const double stored = (value - offset) * invScale + 0.5;
+    return static_cast<S>(stored > lowest ? std::min(std::floor(stored), highest) : lowest);
+}
+
+// Quantizes numElements interleaved elements of type T into the full range of the integer type S, mapping the range of each component onto [lowest, max] of S.
+// The source must start at the first component of a voxel, the work is split in blocks over all available threads like convertElements.
+// When statistics are given, the range, sum and count of the original values are gathered in the same pass.
+template <typename T, typename S>
+void quantizeElements(const char* source, S* destination, std::int64_t numElements, const ComponentRanges& ranges, bool swap = false, ComponentStatistics* statistics = nullptr)
+{
+    static_assert(std::is_integral_v<S>, "Only integer types can hold quantized values");
+
+    const int numComponents = ranges.getNumberOfComponents();
+    const std::int64_t numBlocks = (numElements + blockSize - 1) / blockSize;
+
+    // Inverse of the dequantization, precomputed per component
+    std::vector<double> invScale(numComponents), offset(numComponents);
+
+    for (int c = 0; c < numComponents; c++)
+    {
+        double scale;
+        getDequantization<S>(ranges, c, scale, offset[c]);
+        invScale[c] = 1.0 / scale;
+    }
+
+    #pragma omp parallel
+    {
+        ComponentStatistics threadStatistics(statistics != nullptr ? numComponents : 0);
+
+        #pragma omp for schedule(static)
+        for (std::int64_t block = 0; block < numBlocks; block++)
+        {
+            const std::int64_t begin = block * blockSize;
+            const std::int64_t count = std::min(blockSize, numElements - begin);
+
+            int c = static_cast<int>(begin % numComponents);
+
+            for (std::int64_t i = begin; i < begin + count; i++)
+            {
+                T value;
+                std::memcpy(&value, source + i * sizeof(T), sizeof(T));
+
+                if (swap)
+                    value = swapBytes(value);
+
+                destination[i] = quantizeValue<S>(static_cast<double>(value), offset[c], invScale[c]);
+
+                if (statistics != nullptr)
+                    threadStatistics.add(c, static_cast<double>(value));
+
+                if (++c == numComponents)
+                    c = 0;
+            }
+        }
+
+        if (statistics != nullptr)
+        {
+            #pragma omp critical
+            statistics->merge(threadStatistics);
+        }
+    }
+}
+
+// Gets the ranges of the selected components, in the order of the selection
+inline ComponentRanges selectRanges(const ComponentRanges& ranges, const std::vector<int>& selection)
+{
+    ComponentRanges selectedRanges(static_cast<int>(selection.size()));
+
+    for (std::size_t k = 0; k < selection.size(); k++)
+    {
+        selectedRanges.minimum[k] = ranges.minimum[selection[k]];
+        selectedRanges.maximum[k] = ranges.maximum[selection[k]];
+    }
+
+    return selectedRanges;
+}
+
+// Gathers the selected components of numVoxels voxels of numSourceComponents interleaved elements of type T into a compact destination of selection.size() components per voxel.
+// Only the selected elements are read, such that the conversion of a few components of wide voxels touches a fraction of the (memory-mapped) source.
+// Quantizes into the full range of the integer type S when (selected) ranges are given, and gathers the statistics of the selected components when given.
+// The voxels are split in blocks over all available threads like convertElements.
+template <typename T, typename S>
+void gatherComponents(const char* source, S* destination, std::int64_t numVoxels, int numSourceComponents, const std::vector<int>& selection, bool swap = false, const ComponentRanges* ranges = nullptr, ComponentStatistics* statistics = nullptr)
+{
+    const int numSelected = static_cast<int>(selection.size());
+    const std::int64_t voxelsPerBlock = std::max<std::int64_t>(1, blockSize / std::max(1, numSelected));
+    const std::int64_t numBlocks = (numVoxels + voxelsPerBlock - 1) / voxelsPerBlock;
+
+    // Inverse of the dequantization, precomputed per selected component
+    std::vector<double> invScale(numSelected, 1.0), offset(numSelected, 0.0);
+    bool quantize = false;
+
+    if constexpr (std::is_integral_v<S>)
+    {
+        if (ranges != nullptr)
+        {
+            for (int k = 0; k < numSelected; k++)
+            {
+                double scale;
+                getDequantization<S>(*ranges, k, scale, offset[k]);
+                invScale[k] = 1.0 / scale;
+            }
+
+            quantize = true;
+        }
+    }
+
+    #pragma omp parallel
+    {
+        ComponentStatistics threadStatistics(statistics != nullptr ? numSelected : 0);
+
+        #pragma omp for schedule(static)
+        for (std::int64_t block = 0; block < numBlocks; block++)
+        {
+            const std::int64_t begin = block * voxelsPerBlock;
+            const std::int64_t end = std::min(begin + voxelsPerBlock, numVoxels);
+
+            for (std::int64_t voxel = begin; voxel < end; voxel++)
+            {
+                const char* voxelSource = source + voxel * numSourceComponents * static_cast<std::int64_t>(sizeof(T));
+                S* voxelDestination = destination + voxel * numSelected;
+
+                for (int k = 0; k < numSelected; k++)
+                {
+                    T value;
+                    std::memcpy(&value, voxelSource + selection[k] * sizeof(T), sizeof(T));
+
+                    if (swap)
+                        value = swapBytes(value);
+
+                    if constexpr (std::is_integral_v<S>)
+                    {
+                        if (quantize)
+                            voxelDestination[k] = quantizeValue<S>(static_cast<double>(value), offset[k], invScale[k]);
+                        else
+                            voxelDestination[k] = static_cast<S>(value);
+                    }
+                    else
+                    {
+                        voxelDestination[k] = static_cast<S>(value);
+                    }
+
+                    if (statistics != nullptr)
+                        threadStatistics.add(k, static_cast<double>(value));
+                }
+            }
+        }
+
+        if (statistics != nullptr)
+        {
+            #pragma omp critical
+            statistics->merge(threadStatistics);
+        }
+    }
+}
+
+}
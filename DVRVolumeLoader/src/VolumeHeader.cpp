@@ -0,0 +1,317 @@
+#include "VolumeHeader.h"
+
+#include <LoaderPlugin.h>
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QMap>
+#include <QStringList>
+#include <QSysInfo>
+#include <QtDebug>
+
+using namespace mv::plugin;
+
+namespace {
+
+qint64 getElementSize(BinaryDataType dataType)
+{
+    switch (dataType)
+    {
+        case BinaryDataType::FLOAT:     return sizeof(float);
+        case BinaryDataType::UINT16:    return sizeof(std::uint16_t);
+        case BinaryDataType::UBYTE:     return sizeof(unsigned char);
+    }
+
+    return 1;
+}
+
+bool isBigEndianMachine()
+{
+    return QSysInfo::ByteOrder == QSysInfo::BigEndian;
+}
+
+// Parses a whitespace separated list of positive sizes, such as the NRRD sizes field and the MetaImage DimSize field
+QList<std::int32_t> parseSizes(const QString& fileName, const QString& value)
+{
+    QList<std::int32_t> sizes;
+
+    for (const auto& token : value.split(' ', Qt::SkipEmptyParts))
+    {
+        bool ok = false;
+        const auto size = token.toInt(&ok);
+
+        if (!ok || size < 1)
+            throw DataLoadException(fileName, QString("Invalid size '%1' in header.").arg(token));
+
+        sizes.append(size);
+    }
+
+    return sizes;
+}
+
+// Resolves a data file name relative to the directory of the header
+QString resolveDataFileName(const QString& headerFileName, const QString& dataFileName)
+{
+    return QFileInfo(headerFileName).dir().filePath(dataFileName);
+}
+
+// Sets the data offset of the header, a negative byte skip means that the data is located at the end of the data file
+void setDataOffset(const QString& headerFileName, VolumeHeader& header, qint64 baseOffset, qint64 byteSkip)
+{
+    const auto dataFileSize = QFileInfo(header.dataFileName).size();
+
+    header.dataOffset = byteSkip < 0 ? dataFileSize - header.getNumberOfBytes() : baseOffset + byteSkip;
+
+    if (header.dataOffset < 0 || header.dataOffset + header.getNumberOfBytes() > dataFileSize)
+        throw DataLoadException(headerFileName, QString("Data file %1 holds %2 bytes, but the header describes %3 bytes at offset %4.").arg(header.dataFileName).arg(dataFileSize).arg(header.getNumberOfBytes()).arg(header.dataOffset));
+}
+
+VolumeHeader readNrrdHeader(const QString& fileName)
+{
+    QFile file(fileName);
+
+    if (!file.open(QIODevice::ReadOnly))
+        throw DataLoadException(fileName, "Header could not be opened.");
+
+    if (!file.readLine().startsWith("NRRD"))
+        throw DataLoadException(fileName, "File does not start with the NRRD magic.");
+
+    QMap<QString, QString> fields;
+
+    // The header ends with an empty line or at the end of a detached header
+    while (!file.atEnd())
+    {
+        const auto line = QString::fromLatin1(file.readLine()).trimmed();
+
+        if (line.isEmpty())
+            break;
+
+        // Skip comments and key/value pairs
+        if (line.startsWith('#') || line.contains(":="))
+            continue;
+
+        const auto separator = line.indexOf(": ");
+
+        if (separator < 0)
+            throw DataLoadException(fileName, QString("Invalid NRRD header line '%1'.").arg(line));
+
+        fields[line.left(separator).toLower()] = line.mid(separator + 2).trimmed();
+    }
+
+    const auto headerSize = file.pos();
+
+    for (const auto& requiredField : { "type", "dimension", "sizes", "encoding" })
+        if (!fields.contains(requiredField))
+            throw DataLoadException(fileName, QString("NRRD header misses the required '%1' field.").arg(requiredField));
+
+    VolumeHeader header;
+
+    const auto type = fields["type"].toLower();
+
+    if (type == "float")
+        header.dataType = BinaryDataType::FLOAT;
+    else if (type == "uchar" || type == "unsigned char" || type == "uint8" || type == "uint8_t")
+        header.dataType = BinaryDataType::UBYTE;
+    else if (type == "ushort" || type == "unsigned short" || type == "unsigned short int" || type == "uint16" || type == "uint16_t")
+        header.dataType = BinaryDataType::UINT16;
+    else
+        throw DataLoadException(fileName, QString("NRRD type '%1' is not supported, only float, uint8 and uint16 are.").arg(type));
+
+    if (fields["encoding"].toLower() != "raw")
+        throw DataLoadException(fileName, QString("NRRD encoding '%1' is not supported, only raw is.").arg(fields["encoding"]));
+
+    const auto sizes = parseSizes(fileName, fields["sizes"]);
+
+    if (sizes.size() != fields["dimension"].toInt())
+        throw DataLoadException(fileName, "Number of NRRD sizes does not match the dimension.");
+
+    // Voxel values are stored interleaved, so a 4D volume needs the components on the fastest (first) axis
+    if (sizes.size() == 4)
+    {
+        const auto kinds = fields.value("kinds").toLower().split(' ', Qt::SkipEmptyParts);
+
+        if (!kinds.isEmpty() && (kinds.first() == "domain" || kinds.first() == "space"))
+            throw DataLoadException(fileName, "Only 4D NRRD volumes with the components on the first axis are supported.");
+
+        header.numComponents    = sizes[0];
+        header.sizeX            = sizes[1];
+        header.sizeY            = sizes[2];
+        header.sizeZ            = sizes[3];
+    }
+    else if (sizes.size() == 3 || sizes.size() == 2)
+    {
+        header.sizeX            = sizes[0];
+        header.sizeY            = sizes[1];
+        header.sizeZ            = sizes.size() == 3 ? sizes[2] : 1;
+    }
+    else
+    {
+        throw DataLoadException(fileName, QString("NRRD dimension %1 is not supported, only 2, 3 and 4 are.").arg(sizes.size()));
+    }
+
+    if (getElementSize(header.dataType) > 1)
+    {
+        const auto endian = fields.value("endian").toLower();
+
+        if (endian != "big" && endian != "little")
+            throw DataLoadException(fileName, "NRRD header misses the endian field that is required for multi-byte types.");
+
+        header.swapBytes = (endian == "big") != isBigEndianMachine();
+    }
+
+    // Detached headers (.nhdr) point to a separate data file, otherwise the data directly follows the header
+    const auto dataFileField = fields.contains("data file") ? fields["data file"] : fields.value("datafile");
+    qint64 baseOffset = 0;
+
+    if (dataFileField.isEmpty())
+    {
+        header.dataFileName = fileName;
+        baseOffset = headerSize;
+    }
+    else
+    {
+        if (dataFileField.startsWith("LIST") || dataFileField.contains('%'))
+            throw DataLoadException(fileName, "NRRD headers that spread the data over multiple files are not supported.");
+
+        header.dataFileName = resolveDataFileName(fileName, dataFileField);
+    }
+
+    if (!QFileInfo::exists(header.dataFileName))
+        throw DataLoadException(header.dataFileName, "Data file referenced by the NRRD header was not found.");
+
+    // Lines to skip precede the bytes to skip
+    const auto lineSkip = fields.value("line skip", fields.value("lineskip", "0")).toInt();
+
+    if (lineSkip > 0)
+    {
+        QFile dataFile(header.dataFileName);
+
+        if (!dataFile.open(QIODevice::ReadOnly) || !dataFile.seek(baseOffset))
+            throw DataLoadException(header.dataFileName, "Data file could not be opened.");
+
+        for (int line = 0; line < lineSkip && !dataFile.atEnd(); line++)
+            dataFile.readLine();
+
+        baseOffset = dataFile.pos();
+    }
+
+    setDataOffset(fileName, header, baseOffset, fields.value("byte skip", fields.value("byteskip", "0")).toLongLong());
+
+    return header;
+}
+
+VolumeHeader readMetaImageHeader(const QString& fileName)
+{
+    QFile file(fileName);
+
+    if (!file.open(QIODevice::ReadOnly))
+        throw DataLoadException(fileName, "Header could not be opened.");
+
+    QMap<QString, QString> fields;
+
+    // ElementDataFile is always the last field of the header
+    while (!file.atEnd() && !fields.contains("ElementDataFile"))
+    {
+        const auto line = QString::fromLatin1(file.readLine()).trimmed();
+
+        if (line.isEmpty())
+            continue;
+
+        const auto separator = line.indexOf('=');
+
+        if (separator < 0)
+            throw DataLoadException(fileName, QString("Invalid MetaImage header line '%1'.").arg(line));
+
+        fields[line.left(separator).trimmed()] = line.mid(separator + 1).trimmed();
+    }
+
+    const auto headerSize = file.pos();
+
+    for (const auto& requiredField : { "NDims", "DimSize", "ElementType", "ElementDataFile" })
+        if (!fields.contains(requiredField))
+            throw DataLoadException(fileName, QString("MetaImage header misses the required '%1' field.").arg(requiredField));
+
+    VolumeHeader header;
+
+    const auto type = fields["ElementType"];
+
+    if (type == "MET_FLOAT")
+        header.dataType = BinaryDataType::FLOAT;
+    else if (type == "MET_UCHAR")
+        header.dataType = BinaryDataType::UBYTE;
+    else if (type == "MET_USHORT")
+        header.dataType = BinaryDataType::UINT16;
+    else
+        throw DataLoadException(fileName, QString("MetaImage element type '%1' is not supported, only MET_FLOAT, MET_UCHAR and MET_USHORT are.").arg(type));
+
+    if (fields.value("CompressedData").compare("True", Qt::CaseInsensitive) == 0)
+        throw DataLoadException(fileName, "Compressed MetaImage data is not supported.");
+
+    const auto sizes = parseSizes(fileName, fields["DimSize"]);
+
+    if (sizes.size() != fields["NDims"].toInt() || sizes.size() < 2 || sizes.size() > 3)
+        throw DataLoadException(fileName, "MetaImage DimSize must hold two or three sizes that match NDims.");
+
+    header.sizeX            = sizes[0];
+    header.sizeY            = sizes[1];
+    header.sizeZ            = sizes.size() == 3 ? sizes[2] : 1;
+    header.numComponents    = fields.value("ElementNumberOfChannels", "1").toInt();
+
+    if (header.numComponents < 1)
+        throw DataLoadException(fileName, "Invalid MetaImage ElementNumberOfChannels.");
+
+    // Both spellings of the byte order field are in use
+    const auto byteOrderMSB = fields.contains("ElementByteOrderMSB") ? fields["ElementByteOrderMSB"] : fields.value("BinaryDataByteOrderMSB", "False");
+
+    header.swapBytes = (byteOrderMSB.compare("True", Qt::CaseInsensitive) == 0) != isBigEndianMachine();
+
+    // LOCAL means that the data directly follows the header (.mha)
+    const auto dataFileField = fields["ElementDataFile"];
+    qint64 baseOffset = 0;
+
+    if (dataFileField == "LOCAL")
+    {
+        header.dataFileName = fileName;
+        baseOffset = headerSize;
+    }
+    else
+    {
+        if (dataFileField.startsWith("LIST") || dataFileField.contains('%'))
+            throw DataLoadException(fileName, "MetaImage headers that spread the data over multiple files are not supported.");
+
+        header.dataFileName = resolveDataFileName(fileName, dataFileField);
+    }
+
+    if (!QFileInfo::exists(header.dataFileName))
+        throw DataLoadException(header.dataFileName, "Data file referenced by the MetaImage header was not found.");
+
+    setDataOffset(fileName, header, baseOffset, fields.value("HeaderSize", "0").toLongLong());
+
+    return header;
+}
+
+}
+
+qint64 VolumeHeader::getNumberOfBytes() const
+{
+    return static_cast<qint64>(sizeX) * sizeY * sizeZ * numComponents * getElementSize(dataType);
+}
+
+bool isVolumeHeaderFile(const QString& fileName)
+{
+    const auto suffix = QFileInfo(fileName).suffix().toLower();
+
+    return suffix == "nrrd" || suffix == "nhdr" || suffix == "mhd" || suffix == "mha";
+}
+
+VolumeHeader readVolumeHeader(const QString& fileName)
+{
+    const auto suffix = QFileInfo(fileName).suffix().toLower();
+
+    VolumeHeader header = (suffix == "nrrd" || suffix == "nhdr") ? readNrrdHeader(fileName) : readMetaImageHeader(fileName);
+
+    qDebug() << "Volume header" << fileName << ": size" << header.sizeX << header.sizeY << header.sizeZ << ", components" << header.numComponents << ", data" << header.dataFileName << "at offset" << header.dataOffset << (header.swapBytes ? "(byte swapped)" : "");
+
+    return header;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <QString>
+
+#include <cstdint>
+
+enum BinaryDataType
+{
+    FLOAT, UBYTE, UINT16
+};
+
+// =============================================================================
+// Volume header
+// =============================================================================
+
+/** Description of raw volume data, as read from a self-describing NRRD or MetaImage header */
+struct VolumeHeader
+{
+    QString         dataFileName;               /** File that holds the raw voxel data (may be the header file itself) */
+    qint64          dataOffset = 0;             /** Offset of the first voxel in the data file in bytes */
+    std::int32_t    sizeX = 1;                  /** Number of voxels on the x-axis */
+    std::int32_t    sizeY = 1;                  /** Number of voxels on the y-axis */
+    std::int32_t    sizeZ = 1;                  /** Number of voxels on the z-axis */
+    std::int32_t    numComponents = 1;          /** Number of interleaved values per voxel */
+    BinaryDataType  dataType = BinaryDataType::FLOAT;   /** Element type of the raw data */
+    bool            swapBytes = false;          /** Whether the raw data has the opposite endianness of this machine */
+
+    /** Get the number of bytes of raw voxel data described by the header */
+    qint64 getNumberOfBytes() const;
+};
+
+/** Get whether the file name has the extension of one of the supported header formats (.nrrd, .nhdr, .mhd, .mha) */
+bool isVolumeHeaderFile(const QString& fileName);
+
+/**
+ * Read the NRRD or MetaImage header of a volume, only raw (uncompressed) encodings with a single data file are supported
+ * @param fileName Path of the header file
+ * @return Description of the raw voxel data
+ * @throws DataLoadException when the header can not be read or describes data that can not be loaded
+ */
+VolumeHeader readVolumeHeader(const QString& fileName);
@@ -0,0 +1,430 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include <SparseVolume.h>
+
+#include <OpenMPSupport.h>
+
+// =============================================================================
+// Voxelizer
+// =============================================================================
+
+/**
+ * Accumulates scattered points with values into a regular grid of voxels. Points are scattered in parallel into a single value grid
+ * and one weight per voxel, such that the memory use stays at the size of the output. Averaging kernels accumulate with atomics,
+ * the maximum and minimum kernels guard voxels with a fixed set of striped locks.
+ * Positions and values are read through random access iterators with a stride, so point data is accessed without copying it.
+ */
+class Voxelizer
+{
+public:
+
+    /** How the values of the points are combined into the voxels */
+    enum class Kernel
+    {
+        Nearest,        /** Average of the points that round to the voxel */
+        Trilinear,      /** Weighted average, each point is splatted onto the eight surrounding voxels */
+        Max,            /** Maximum of the points that round to the voxel */
+        Min             /** Minimum of the points that round to the voxel */
+    };
+
+    /** Axis aligned bounding box of the point positions */
+    struct Bounds
+    {
+        std::array<float, 3> min = { std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max() };
+        std::array<float, 3> max = { std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest() };
+
+        void extend(const Bounds& other) {
+            for (int axis = 0; axis < 3; axis++) {
+                min[axis] = std::min(min[axis], other.min[axis]);
+                max[axis] = std::max(max[axis], other.max[axis]);
+            }
+        }
+    };
+
+    /**
+     * Construct with the grid size
+     * @param sizeX Number of voxels on the x-axis
+     * @param sizeY Number of voxels on the y-axis
+     * @param sizeZ Number of voxels on the z-axis
+     * @param numComponents Number of values per voxel
+     * @param kernel How values are combined into voxels
+     */
+    Voxelizer(std::int32_t sizeX, std::int32_t sizeY, std::int32_t sizeZ, std::int32_t numComponents, Kernel kernel = Kernel::Nearest) :
+        _size({ sizeX, sizeY, sizeZ }),
+        _numComponents(numComponents),
+        _kernel(kernel),
+        _values(static_cast<std::size_t>(sizeX) * sizeY * sizeZ * numComponents, 0.0f),
+        _weights(static_cast<std::size_t>(sizeX) * sizeY * sizeZ, 0.0f)
+    {
+#ifdef _OPENMP
+        if (_kernel == Kernel::Max || _kernel == Kernel::Min)
+            for (auto& lock : _locks)
+                omp_init_lock(&lock);
+#endif
+    }
+
+    ~Voxelizer()
+    {
+#ifdef _OPENMP
+        if (_kernel == Kernel::Max || _kernel == Kernel::Min)
+            for (auto& lock : _locks)
+                omp_destroy_lock(&lock);
+#endif
+    }
+
+    Voxelizer(const Voxelizer&) = delete;
+    Voxelizer& operator=(const Voxelizer&) = delete;
+
+    /**
+     * Compute the bounding box of the positions in parallel, every thread reduces a part of the points and the partial boxes are merged
+     * @param positions Iterator to the first coordinate of the first point
+     * @param stride Number of values between consecutive points
+     * @param numPoints Number of points
+     * @return Bounding box of the first three coordinates
+     */
+    template <typename PositionIterator>
+    static Bounds computeBounds(PositionIterator positions, std::int64_t stride, std::int64_t numPoints)
+    {
+        Bounds bounds;
+
+        #pragma omp parallel
+        {
+            Bounds threadBounds;
+
+            #pragma omp for schedule(static)
+            for (std::int64_t i = 0; i < numPoints; i++)
+            {
+                for (int axis = 0; axis < 3; axis++)
+                {
+                    const auto coordinate = static_cast<float>(positions[i * stride + axis]);
+
+                    threadBounds.min[axis] = std::min(threadBounds.min[axis], coordinate);
+                    threadBounds.max[axis] = std::max(threadBounds.max[axis], coordinate);
+                }
+            }
+
+            #pragma omp critical
+            bounds.extend(threadBounds);
+        }
+
+        return bounds;
+    }
+
+    /** Set the bounds that are mapped onto the grid, the minimum maps to the center of the first voxel and the maximum to the center of the last */
+    void setBounds(const Bounds& bounds)
+    {
+        for (int axis = 0; axis < 3; axis++)
+        {
+            const auto extent = bounds.max[axis] - bounds.min[axis];
+
+            _offset[axis]   = bounds.min[axis];
+            _scale[axis]    = extent > 0.0f ? (_size[axis] - 1) / extent : 0.0f;
+        }
+    }
+
+    /**
+     * Scatter the points in the range [begin, end) into the grid, the range is divided over all threads
+     * @param positions Iterator to the first coordinate of the first point
+     * @param positionStride Number of position values between consecutive points
+     * @param values Iterator to the first value of the first point
+     * @param valueStride Number of values between consecutive points
+     * @param begin Index of the first point to scatter
+     * @param end Index one past the last point to scatter
+     */
+    template <typename PositionIterator, typename ValueIterator>
+    void scatter(PositionIterator positions, std::int64_t positionStride, ValueIterator values, std::int64_t valueStride, std::int64_t begin, std::int64_t end)
+    {
+        #pragma omp parallel for schedule(static)
+        for (std::int64_t i = begin; i < end; i++)
+        {
+            std::array<float, 3> gridCoordinate;
+
+            for (int axis = 0; axis < 3; axis++)
+                gridCoordinate[axis] = (static_cast<float>(positions[i * positionStride + axis]) - _offset[axis]) * _scale[axis];
+
+            const auto pointValues = values + i * valueStride;
+
+            if (_kernel == Kernel::Trilinear)
+            {
+                std::array<std::int32_t, 3> base;
+                std::array<float, 3> fraction;
+
+                for (int axis = 0; axis < 3; axis++)
+                {
+                    const auto clamped = std::clamp(gridCoordinate[axis], 0.0f, static_cast<float>(_size[axis] - 1));
+
+                    base[axis]      = std::min(static_cast<std::int32_t>(clamped), std::max(_size[axis] - 2, 0));
+                    fraction[axis]  = clamped - base[axis];
+                }
+
+                for (int corner = 0; corner < 8; corner++)
+                {
+                    std::array<std::int32_t, 3> voxel;
+                    float weight = 1.0f;
+
+                    for (int axis = 0; axis < 3; axis++)
+                    {
+                        const bool upper = (corner >> axis) & 1;
+
+                        voxel[axis] = base[axis] + upper;
+                        weight     *= upper ? fraction[axis] : 1.0f - fraction[axis];
+                    }
+
+                    // Corners outside of the grid only occur along axes with a single voxel, where their weight is zero
+                    if (weight <= 0.0f || voxel[0] >= _size[0] || voxel[1] >= _size[1] || voxel[2] >= _size[2])
+                        continue;
+
+                    accumulate(getVoxelIndex(voxel[0], voxel[1], voxel[2]), pointValues, weight);
+                }
+            }
+            else
+            {
+                std::array<std::int32_t, 3> voxel;
+
+                for (int axis = 0; axis < 3; axis++)
+                    voxel[axis] = std::clamp(static_cast<std::int32_t>(std::lround(gridCoordinate[axis])), 0, _size[axis] - 1);
+
+                const auto voxelIndex = getVoxelIndex(voxel[0], voxel[1], voxel[2]);
+
+                if (_kernel == Kernel::Nearest)
+                    accumulate(voxelIndex, pointValues, 1.0f);
+                else
+                    combineExtreme(voxelIndex, pointValues);
+            }
+        }
+    }
+
+    /**
+     * Normalize the accumulated values by their weights and hand over the grid. Without filling the gaps, the occupancy of the bricks
+     * is recorded as well, which is available through getOccupancy() afterwards.
+     * @param fillGaps Fill voxels without points with the values of the nearest voxel with points, otherwise they stay zero
+     * @return Voxel values with the components interleaved
+     */
+    std::vector<float> finalize(bool fillGaps = false)
+    {
+        const auto numVoxels = static_cast<std::int64_t>(_weights.size());
+
+        // The maximum and minimum kernels store the final values directly
+        if (_kernel == Kernel::Nearest || _kernel == Kernel::Trilinear)
+        {
+            #pragma omp parallel for schedule(static)
+            for (std::int64_t voxelIndex = 0; voxelIndex < numVoxels; voxelIndex++)
+            {
+                const auto weight = _weights[voxelIndex];
+
+                if (weight > 0.0f)
+                    for (std::int32_t component = 0; component < _numComponents; component++)
+                        _values[voxelIndex * _numComponents + component] /= weight;
+            }
+        }
+
+        if (fillGaps)
+            fillEmptyVoxels();
+        else
+            _occupancy = SparseVolume::computeOccupancy(_size[0], _size[1], _size[2], SparseVolume::defaultBrickSize, [this](std::int64_t voxelIndex) {
+                return _weights[voxelIndex] > 0.0f;
+            });
+
+        _weights.clear();
+        _weights.shrink_to_fit();
+
+        return std::move(_values);
+    }
+
+    /** Get the occupancy of the bricks that was recorded by finalize(...), it is empty when the gaps were filled */
+    const SparseVolume::BrickOccupancy& getOccupancy() const {
+        return _occupancy;
+    }
+
+private:
+    std::int64_t getVoxelIndex(std::int32_t x, std::int32_t y, std::int32_t z) const {
+        return x + static_cast<std::int64_t>(_size[0]) * (y + static_cast<std::int64_t>(_size[1]) * z);
+    }
+
+    /** Add the weighted values of a point to a voxel */
+    template <typename ValueIterator>
+    void accumulate(std::int64_t voxelIndex, ValueIterator pointValues, float weight)
+    {
+        for (std::int32_t component = 0; component < _numComponents; component++)
+        {
+            const auto value = static_cast<float>(pointValues[component]) * weight;
+
+            #pragma omp atomic
+            _values[voxelIndex * _numComponents + component] += value;
+        }
+
+        #pragma omp atomic
+        _weights[voxelIndex] += weight;
+    }
+
+    /** Combine the values of a point with the values of a voxel using the maximum or minimum kernel, the first point of a voxel sets its values */
+    template <typename ValueIterator>
+    void combineExtreme(std::int64_t voxelIndex, ValueIterator pointValues)
+    {
+#ifdef _OPENMP
+        auto& lock = _locks[voxelIndex % numLocks];
+        omp_set_lock(&lock);
+#endif
+
+        const bool isFirst = _weights[voxelIndex] == 0.0f;
+
+        for (std::int32_t component = 0; component < _numComponents; component++)
+        {
+            const auto value = static_cast<float>(pointValues[component]);
+            auto& voxelValue = _values[voxelIndex * _numComponents + component];
+
+            if (isFirst)
+                voxelValue = value;
+            else
+                voxelValue = _kernel == Kernel::Max ? std::max(voxelValue, value) : std::min(voxelValue, value);
+        }
+
+        _weights[voxelIndex] += 1.0f;
+
+#ifdef _OPENMP
+        omp_unset_lock(&lock);
+#endif
+    }
+
+    /**
+     * Fill the voxels without points with the values of the nearest voxel with points. The nearest voxel is found with an exact, separable
+     * Euclidean distance transform (Felzenszwalb and Huttenlocher) that carries the index of the nearest filled voxel along, every pass
+     * processes the lines along one axis in parallel.
+     */
+    void fillEmptyVoxels()
+    {
+        const auto numVoxels = static_cast<std::int64_t>(_weights.size());
+        const auto infinity  = std::numeric_limits<float>::infinity();
+
+        std::vector<float> distances(numVoxels);
+        std::vector<std::int64_t> nearest(numVoxels);
+
+        bool hasFilledVoxels = false;
+
+        #pragma omp parallel for schedule(static) reduction(||:hasFilledVoxels)
+        for (std::int64_t voxelIndex = 0; voxelIndex < numVoxels; voxelIndex++)
+        {
+            const bool isFilled = _weights[voxelIndex] > 0.0f;
+
+            distances[voxelIndex]   = isFilled ? 0.0f : infinity;
+            nearest[voxelIndex]     = isFilled ? voxelIndex : -1;
+
+            hasFilledVoxels = hasFilledVoxels || isFilled;
+        }
+
+        if (!hasFilledVoxels)
+            return;
+
+        const std::array<std::int64_t, 3> strides = { 1, _size[0], static_cast<std::int64_t>(_size[0]) * _size[1] };
+
+        for (int axis = 0; axis < 3; axis++)
+        {
+            const auto length   = _size[axis];
+            const auto stride   = strides[axis];
+            const auto numLines = numVoxels / length;
+
+            #pragma omp parallel
+            {
+                std::vector<float>          lineDistances(length);
+                std::vector<std::int64_t>   lineNearest(length);
+                std::vector<std::int32_t>   parabolas(length);
+                std::vector<double>         boundaries(length + 1);
+
+                #pragma omp for schedule(static)
+                for (std::int64_t line = 0; line < numLines; line++)
+                {
+                    // Index of the first voxel of the line, the lines of an axis are all voxels with a zero coordinate along that axis
+                    const auto first = (line / stride) * stride * length + line % stride;
+
+                    for (std::int32_t i = 0; i < length; i++)
+                    {
+                        lineDistances[i]    = distances[first + i * stride];
+                        lineNearest[i]      = nearest[first + i * stride];
+                    }
+
+                    // Lower envelope of the parabolas rooted at the voxels with a finite distance
+                    std::int32_t numParabolas = 0;
+
+                    for (std::int32_t q = 0; q < length; q++)
+                    {
+                        if (lineDistances[q] == infinity)
+                            continue;
+
+                        const auto intersect = [&](std::int32_t p) -> double {
+                            return ((lineDistances[q] + static_cast<double>(q) * q) - (lineDistances[p] + static_cast<double>(p) * p)) / (2.0 * q - 2.0 * p);
+                        };
+
+                        if (numParabolas == 0)
+                        {
+                            parabolas[0]    = q;
+                            boundaries[0]   = -std::numeric_limits<double>::infinity();
+                            boundaries[1]   = std::numeric_limits<double>::infinity();
+                            numParabolas    = 1;
+                            continue;
+                        }
+
+                        auto intersection = intersect(parabolas[numParabolas - 1]);
+
+                        while (intersection <= boundaries[numParabolas - 1])
+                        {
+                            numParabolas--;
+                            intersection = intersect(parabolas[numParabolas - 1]);
+                        }
+
+                        parabolas[numParabolas]         = q;
+                        boundaries[numParabolas]        = intersection;
+                        boundaries[numParabolas + 1]    = std::numeric_limits<double>::infinity();
+                        numParabolas++;
+                    }
+
+                    if (numParabolas == 0)
+                        continue;
+
+                    for (std::int32_t p = 0, k = 0; p < length; p++)
+                    {
+                        while (boundaries[k + 1] < p)
+                            k++;
+
+                        const auto q = parabolas[k];
+
+                        distances[first + p * stride]   = static_cast<float>(p - q) * static_cast<float>(p - q) + lineDistances[q];
+                        nearest[first + p * stride]     = lineNearest[q];
+                    }
+                }
+            }
+        }
+
+        #pragma omp parallel for schedule(static)
+        for (std::int64_t voxelIndex = 0; voxelIndex < numVoxels; voxelIndex++)
+        {
+            const auto source = nearest[voxelIndex];
+
+            if (source != voxelIndex)
+                for (std::int32_t component = 0; component < _numComponents; component++)
+                    _values[voxelIndex * _numComponents + component] = _values[source * _numComponents + component];
+        }
+    }
+
+private:
+    std::array<std::int32_t, 3>     _size;              /** Number of voxels per axis */
+    std::int32_t                    _numComponents;     /** Number of values per voxel */
+    Kernel                          _kernel;            /** How values are combined into voxels */
+    std::array<float, 3>            _offset = {};       /** Position that maps onto the first voxel */
+    std::array<float, 3>            _scale = {};        /** Scale from positions to voxel coordinates */
+    std::vector<float>              _values;            /** Accumulated values, components interleaved */
+    std::vector<float>              _weights;           /** Accumulated weight (or number of points) per voxel */
+    SparseVolume::BrickOccupancy    _occupancy;         /** Bricks that hold points, recorded when finalizing without filling gaps */
+
+    static constexpr std::size_t    numLocks = 4096;    /** Number of lock stripes for the maximum and minimum kernels */
+
+#ifdef _OPENMP
+    std::array<omp_lock_t, numLocks> _locks;           /** Striped voxel locks for the maximum and minimum kernels */
+#endif
+};
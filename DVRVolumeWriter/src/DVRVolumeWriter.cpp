@@ -0,0 +1,228 @@
+#include "DVRVolumeWriter.h"
+
+#include <BrickedVolume.h>
+
+#include <PointData/PointData.h>
+
+#include <actions/PluginTriggerAction.h>
+#include <util/Exception.h>
+
+#include <QFileDialog>
+#include <QtCore>
+#include <QtDebug>
+
+#include <type_traits>
+
+Q_PLUGIN_METADATA(IID "nl.tudelft.DVRVolumeWriter")
+
+using namespace mv;
+using namespace mv::gui;
+using namespace mv::util;
+
+namespace {
+
+// Recursively searches for the point data element type name of element type T
+template <typename T, unsigned N = 0>
+QString getElementTypeName()
+{
+    if constexpr (N < PointData::getNumberOfSupportedElementTypes())
+    {
+        if constexpr (std::is_same_v<T, PointData::ElementTypeAt<N>>)
+            return QString::fromLatin1(std::get<N>(PointData::getElementTypeNames()));
+        else
+            return getElementTypeName<T, N + 1>();
+    }
+    else
+    {
+        return QString();
+    }
+}
+
+// Copies the quantization the loader attached to the point data, such that the stored values map back to the source values after a reload
+void setQuantization(BrickedVolume::Header& header, const Dataset<Points>& pointsDataset)
+{
+    if (!pointsDataset->hasProperty("QuantizationScale") || !pointsDataset->hasProperty("QuantizationOffset"))
+        return;
+
+    const auto scale    = pointsDataset->getProperty("QuantizationScale").toList();
+    const auto offset   = pointsDataset->getProperty("QuantizationOffset").toList();
+
+    if (scale.size() != static_cast<qsizetype>(header.numComponents) || offset.size() != static_cast<qsizetype>(header.numComponents)) {
+        qWarning() << "DVRVolumeWriter::writeData: The quantization does not match the number of components and is not exported.";
+        return;
+    }
+
+    for (std::uint32_t c = 0; c < header.numComponents; c++) {
+        header.quantizationScale.push_back(scale[c].toDouble());
+        header.quantizationOffset.push_back(offset[c].toDouble());
+    }
+}
+
+// Copies the per-component statistics the loader attached to the volumes dataset, such that a reload does not have to recompute them
+void setStatistics(BrickedVolume::Header& header, const Dataset<Volumes>& volumesDataset)
+{
+    for (const auto& propertyName : { "ComponentMinimum", "ComponentMaximum", "ComponentMean", "ComponentHistograms" })
+        if (!volumesDataset->hasProperty(propertyName))
+            return;
+
+    const auto minimum      = volumesDataset->getProperty("ComponentMinimum").toList();
+    const auto maximum      = volumesDataset->getProperty("ComponentMaximum").toList();
+    const auto mean         = volumesDataset->getProperty("ComponentMean").toList();
+    const auto histograms   = volumesDataset->getProperty("ComponentHistograms").toList();
+
+    const auto numComponents = static_cast<qsizetype>(header.numComponents);
+
+    if (minimum.size() != numComponents || maximum.size() != numComponents || mean.size() != numComponents || histograms.size() != numComponents) {
+        qWarning() << "DVRVolumeWriter::writeData: The statistics do not match the number of components and are not exported.";
+        return;
+    }
+
+    for (std::uint32_t c = 0; c < header.numComponents; c++) {
+        header.componentMinimum.push_back(minimum[c].toDouble());
+        header.componentMaximum.push_back(maximum[c].toDouble());
+        header.componentMean.push_back(mean[c].toDouble());
+
+        std::vector<quint64> histogram;
+
+        for (const auto& binCount : histograms[c].toList())
+            histogram.push_back(binCount.toULongLong());
+
+        header.componentHistograms.push_back(std::move(histogram));
+    }
+}
+
+}
+
+// =============================================================================
+// Writer
+// =============================================================================
+
+DVRVolumeWriter::~DVRVolumeWriter(void)
+{
+
+}
+
+void DVRVolumeWriter::init()
+{
+
+}
+
+void DVRVolumeWriter::writeData()
+{
+    auto volumesDataset = getInputDataset<Volumes>();
+
+    if (!volumesDataset.isValid()) {
+        qWarning() << "DVRVolumeWriter::writeData: No Volumes dataset to write.";
+        return;
+    }
+
+    // The voxel values are stored in the points dataset the Volumes dataset is derived from
+    auto pointsDataset = volumesDataset->getParent<Points>();
+
+    if (!pointsDataset.isValid()) {
+        qWarning() << "DVRVolumeWriter::writeData: Volumes dataset" << volumesDataset->getGuiName() << "has no points parent.";
+        return;
+    }
+
+    const auto volumeSize = volumesDataset->getVolumeSize();
+
+    BrickedVolume::Header header;
+
+    header.sizeX            = volumeSize.width();
+    header.sizeY            = volumeSize.height();
+    header.sizeZ            = volumeSize.depth();
+    header.numComponents    = pointsDataset->getNumDimensions();
+
+    if (pointsDataset->getNumPoints() != header.getNumberOfVoxels()) {
+        qCritical() << "DVRVolumeWriter::writeData: Number of points" << pointsDataset->getNumPoints() << "does not match the volume size" << header.getNumberOfVoxels();
+        return;
+    }
+
+    setQuantization(header, pointsDataset);
+    setStatistics(header, volumesDataset);
+
+    const auto fileName = QFileDialog::getSaveFileName(nullptr, tr("Export bricked volume"), volumesDataset->getGuiName() + ".dvrb", tr("Bricked volume (*.dvrb)"));
+
+    if (fileName.isEmpty())
+        return;
+
+    QFile file(fileName);
+
+    if (!file.open(QIODevice::WriteOnly)) {
+        qCritical() << "DVRVolumeWriter::writeData: Could not open" << fileName << "for writing.";
+        return;
+    }
+
+    auto& task = volumesDataset->getTask();
+
+    task.setName("Exporting " + volumesDataset->getGuiName());
+    task.setRunning();
+
+    QElapsedTimer timer;
+    timer.start();
+
+    try {
+        pointsDataset->visitFromBeginToEnd([&header, &file, &task](auto begin, auto end) {
+            using ElementType = std::decay_t<decltype(*begin)>;
+
+            header.elementSize      = sizeof(ElementType);
+            header.elementTypeName  = getElementTypeName<ElementType>();
+
+            BrickedVolume::writeVolume(file, header, reinterpret_cast<const char*>(&*begin), BrickedVolume::getDefaultCodec(), [&task](float progress) -> void {
+                task.setProgress(progress);
+            });
+        });
+    }
+    catch (const std::exception& e) {
+        task.setAborted();
+        file.remove();
+        exceptionMessageBox("Unable to export the volume", e);
+        return;
+    }
+
+    qDebug() << "DVRVolumeWriter: Wrote" << header.getNumberOfBricks() << "bricks of" << header.getNumberOfVoxels() * header.getVoxelBytes() << "bytes into" << file.size() << "bytes in" << timer.elapsed() << "ms";
+
+    file.close();
+    task.setFinished();
+}
+
+// =============================================================================
+// Factory
+// =============================================================================
+
+QIcon DVRVolumeWriterFactory::getIcon(const QColor& color /*= Qt::black*/) const
+{
+    return Application::getIconFont("FontAwesome").getIcon("cubes");
+}
+
+WriterPlugin* DVRVolumeWriterFactory::produce()
+{
+    return new DVRVolumeWriter(this);
+}
+
+DataTypes DVRVolumeWriterFactory::supportedDataTypes() const
+{
+    DataTypes supportedTypes;
+    supportedTypes.append(VolumeType);
+    return supportedTypes;
+}
+
+PluginTriggerActions DVRVolumeWriterFactory::getPluginTriggerActions(const mv::Datasets& datasets) const
+{
+    PluginTriggerActions pluginTriggerActions;
+
+    const auto getPluginInstance = [this](const Dataset<DatasetImpl>& dataset) -> DVRVolumeWriter* {
+        return dynamic_cast<DVRVolumeWriter*>(plugins().requestPlugin(getKind(), { dataset }));
+    };
+
+    if (!datasets.isEmpty() && PluginFactory::areAllDatasetsOfTheSameType(datasets, VolumeType)) {
+        auto pluginTriggerAction = new PluginTriggerAction(const_cast<DVRVolumeWriterFactory*>(this), this, "Bricked volume", "Export volumes to bricked volume files (.dvrb)", getIcon(), [getPluginInstance, datasets](PluginTriggerAction& pluginTriggerAction) -> void {
+            for (const auto& dataset : datasets)
+                getPluginInstance(dataset)->writeData();
+        });
+
+        pluginTriggerActions << pluginTriggerAction;
+    }
+
+    return pluginTriggerActions;
+}
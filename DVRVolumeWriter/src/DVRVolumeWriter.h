@@ -0,0 +1,59 @@
+#pragma once
+
+#include <WriterPlugin.h>
+
+#include <VolumeData/Volumes.h>
+
+using namespace mv::plugin;
+
+// =============================================================================
+// Writer
+// =============================================================================
+
+class DVRVolumeWriter : public WriterPlugin
+{
+    Q_OBJECT
+public:
+    DVRVolumeWriter(const PluginFactory* factory) : WriterPlugin(factory) { }
+    ~DVRVolumeWriter(void) override;
+
+    void init() override;
+
+    /** Write the input Volumes dataset to a bricked volume file (.dvrb) that the DVRVolume loader decodes in parallel */
+    void writeData() Q_DECL_OVERRIDE;
+};
+
+
+// =============================================================================
+// Factory
+// =============================================================================
+
+class DVRVolumeWriterFactory : public WriterPluginFactory
+{
+    Q_INTERFACES(mv::plugin::WriterPluginFactory mv::plugin::PluginFactory)
+    Q_OBJECT
+    Q_PLUGIN_METADATA(IID   "nl.tudelft.DVRVolumeWriter"
+                      FILE  "DVRVolumeWriter.json")
+
+public:
+    DVRVolumeWriterFactory(void) {}
+    ~DVRVolumeWriterFactory(void) override {}
+
+    /**
+     * Get plugin icon
+     * @param color Icon color for flat (font) icons
+     * @return Icon
+     */
+    QIcon getIcon(const QColor& color = Qt::black) const override;
+
+    WriterPlugin* produce() override;
+
+    mv::DataTypes supportedDataTypes() const override;
+
+    /**
+     * Get plugin trigger actions given \p datasets
+     * @param datasets Vector of input datasets
+     * @return Vector of plugin trigger actions
+     */
+    PluginTriggerActions getPluginTriggerActions(const mv::Datasets& datasets) const override;
+};